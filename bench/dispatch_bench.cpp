@@ -0,0 +1,106 @@
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+#include "chip8.h"
+
+// Synthetic ALU-heavy loop: register arithmetic, a skip, I updates and a BCD store.
+static const uint16_t LOOP_PROGRAM[] = {
+    0x6001,         // 0x200: LD V0, 1
+    0x6103,         // 0x202: LD V1, 3
+    0xA300,         // 0x204: LD I, 0x300
+    0x8014,         // 0x206: ADD V0, V1
+    0x8125,         // 0x208: SUB V1, V2
+    0x8203,         // 0x20A: XOR V2, V0
+    0x7301,         // 0x20C: ADD V3, 1
+    0x8306,         // 0x20E: SHR V3
+    0x4300,         // 0x210: SNE V3, 0
+    0x6305,         // 0x212: LD V3, 5
+    0xF01E,         // 0x214: ADD I, V0
+    0xA300,         // 0x216: LD I, 0x300
+    0xF233,         // 0x218: LD B, V2
+    0x1206          // 0x21A: JP 0x206
+};
+
+// Sprite loop built from the pairs BlockCache fuses into superinstructions.
+static const uint16_t DRAW_PROGRAM[] = {
+    0x6000,         // 0x200: LD V0, 0
+    0x6108,         // 0x202: LD V1, 8
+    0x7108,         // 0x204: ADD V1, 8
+    0xA000,         // 0x206: LD I, 0x000
+    0xD015,         // 0x208: DRW V0, V1, 5
+    0x7001,         // 0x20A: ADD V0, 1
+    0x303F,         // 0x20C: SE V0, 63
+    0x1202,         // 0x20E: JP 0x202
+    0x1200          // 0x210: JP 0x200
+};
+
+struct Workload {
+    const char* name;
+    const uint16_t* program;
+    size_t length;
+};
+
+/**
+ * @brief Runs a workload in one execution mode and measures throughput.
+ *
+ * The rate is taken from the instructions actually executed, which is fewer
+ * than cycles if the workload halts or goes idle early.
+ *
+ * @param workload Program to run.
+ * @param mode Execution mode to benchmark.
+ * @param cycles Maximum number of instructions to execute.
+ * @param executed Receives the number of instructions executed.
+ * @return double Millions of instructions per second.
+ */
+static double measure(const Workload& workload, ExecutionMode mode, uint64_t cycles, uint64_t& executed) {
+    std::vector<uint8_t> rom;
+    for (size_t i = 0; i < workload.length; ++i) {
+        rom.push_back(workload.program[i] >> 8);
+        rom.push_back(workload.program[i] & 0xFF);
+    }
+
+    Chip8 chip8;
+    chip8.setExecutionMode(mode);
+    chip8.loadProgram(rom.data(), rom.size());
+
+    auto start = std::chrono::steady_clock::now();
+    executed = chip8.execute(cycles);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return executed / seconds / 1e6;
+}
+
+/**
+ * @brief Compares interpreted, predecoded and translated throughput.
+ *
+ * Usage: chip8_bench [instructions]
+ */
+int main(int argc, char* argv[]) {
+    uint64_t cycles = argc > 1 ? std::strtoull(argv[1], nullptr, 0) : 50000000ULL;
+
+    const Workload workloads[] = {
+        {"alu", LOOP_PROGRAM, sizeof(LOOP_PROGRAM) / sizeof(LOOP_PROGRAM[0])},
+        {"draw", DRAW_PROGRAM, sizeof(DRAW_PROGRAM) / sizeof(DRAW_PROGRAM[0])}
+    };
+    const std::pair<const char*, ExecutionMode> modes[] = {
+        {"interpret", ExecutionMode::Interpret},
+        {"predecoded", ExecutionMode::Predecoded},
+        {"translated", ExecutionMode::Translated}
+    };
+
+    std::cout << std::fixed << std::setprecision(1) << "workload,mode,instructions,mips,speedup\n";
+    for (const auto& workload : workloads) {
+        double baseline = 0.0;
+        for (const auto& [name, mode] : modes) {
+            uint64_t executed = 0;
+            double mips = measure(workload, mode, cycles, executed);
+            if (baseline == 0.0) {
+                baseline = mips;
+            }
+            std::cout << workload.name << ',' << name << ',' << executed << ',' << mips << ','
+                      << std::setprecision(2) << mips / baseline << std::setprecision(1) << '\n';
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,373 @@
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+#include "chip8.h"
+#include "event.h"
+#include "framebuffer.h"
+#include "opcode.h"
+#include "pixel_convert.h"
+
+using Handlers = OpcodeHandler<TraceLevel::None>;
+
+/**
+ * @brief One registered benchmark: run(n) performs n operations.
+ */
+struct Benchmark {
+    std::string name;
+    std::function<void(uint64_t)> run;
+};
+
+/**
+ * @brief Timing of one benchmark over all repetitions.
+ */
+struct BenchResult {
+    std::string name;
+    uint64_t iterations;   // Operations per repetition
+    double minNs;          // Fastest repetition, ns per operation
+    double medianNs;       // Median repetition, ns per operation
+};
+
+static volatile uint64_t sink = 0;
+
+// Loads V0..VF with distinct non-zero values and I with the given address.
+static std::vector<uint8_t> setupProgram(uint16_t index) {
+    std::vector<uint8_t> rom;
+    for (uint8_t x = 0; x < 16; ++x) {
+        rom.push_back(0x60 | x);
+        rom.push_back(static_cast<uint8_t>(x * 17 + 3));
+    }
+    rom.push_back(0xA0 | (index >> 8));
+    rom.push_back(index & 0xFF);
+    return rom;
+}
+
+static std::vector<uint8_t> toRom(const std::vector<uint16_t>& words) {
+    std::vector<uint8_t> rom;
+    for (uint16_t word : words) {
+        rom.push_back(word >> 8);
+        rom.push_back(word & 0xFF);
+    }
+    return rom;
+}
+
+/**
+ * @brief Registers a benchmark calling the handlers of a fixed opcode sequence directly.
+ *
+ * The machine first runs setupProgram(index), then every operation runs the
+ * decoded sequence once, so the figure is one handler call (or the whole
+ * sequence) without fetch or decode.
+ *
+ * @param out Registry to add to.
+ * @param name Benchmark name, e.g. "opcode/8XY4".
+ * @param opcodes Sequence executed per operation.
+ * @param index Value of I during the run.
+ */
+static void addOpcode(std::vector<Benchmark>& out, const std::string& name, std::vector<uint16_t> opcodes,
+                      uint16_t index = 0x300) {
+    out.push_back({"opcode/" + name, [opcodes, index](uint64_t n) {
+        std::vector<Instruction> code;
+        for (uint16_t opcode : opcodes) {
+            code.push_back(Handlers::decode(opcode));
+        }
+        std::vector<uint8_t> setup = setupProgram(index);
+        Chip8 chip8;
+        chip8.loadProgram(setup.data(), setup.size());
+        chip8.execute(setup.size() / 2);
+        chip8.key[5] = 1;   // FX0A returns at once; EX9E/EXA1 see a held key for V5
+        for (uint64_t i = 0; i < n; ++i) {
+            for (const Instruction& inst : code) {
+                inst.handler(chip8, inst);
+            }
+        }
+        sink = sink + chip8.getProgramCounter();
+    }});
+}
+
+/**
+ * @brief Registers emulateCycle() loops over a program in every execution mode.
+ */
+static void addProgram(std::vector<Benchmark>& out, const std::string& name, const std::vector<uint8_t>& rom) {
+    const std::pair<const char*, ExecutionMode> modes[] = {
+        {"interpret", ExecutionMode::Interpret},
+        {"predecoded", ExecutionMode::Predecoded},
+        {"translated", ExecutionMode::Translated}
+    };
+    for (const auto& [modeName, mode] : modes) {
+        out.push_back({"emulate_cycle/" + name + "/" + modeName, [rom, mode = mode](uint64_t n) {
+            Chip8 chip8;
+            chip8.setExecutionMode(mode);
+            chip8.loadProgram(rom.data(), rom.size());
+            for (uint64_t i = 0; i < n; ++i) {
+                chip8.emulateCycle();
+            }
+            sink = sink + chip8.getCycleCount();
+        }});
+    }
+}
+
+/**
+ * @brief Registers serializeEvent() for one event.
+ */
+static void addEvent(std::vector<Benchmark>& out, const std::string& name, const EventVariant& event) {
+    out.push_back({"serialize_event/" + name, [event](uint64_t n) {
+        for (uint64_t i = 0; i < n; ++i) {
+            sink = sink + serializeEvent(event).size();
+        }
+    }});
+}
+
+static std::vector<Benchmark> registerBenchmarks(const std::vector<std::string>& romPaths) {
+    std::vector<Benchmark> benchmarks;
+
+    // One handler per family, X = 1 and Y = 2 unless noted
+    addOpcode(benchmarks, "00E0", {0x00E0});
+    addOpcode(benchmarks, "1NNN", {0x1400});
+    addOpcode(benchmarks, "2NNN+00EE", {0x2400, 0x00EE});
+    addOpcode(benchmarks, "3XNN", {0x3114});
+    addOpcode(benchmarks, "4XNN", {0x4114});
+    addOpcode(benchmarks, "5XY0", {0x5120});
+    addOpcode(benchmarks, "6XNN", {0x6142});
+    addOpcode(benchmarks, "7XNN", {0x7101});
+    addOpcode(benchmarks, "8XY0", {0x8120});
+    addOpcode(benchmarks, "8XY1", {0x8121});
+    addOpcode(benchmarks, "8XY2", {0x8122});
+    addOpcode(benchmarks, "8XY3", {0x8123});
+    addOpcode(benchmarks, "8XY4", {0x8124});
+    addOpcode(benchmarks, "8XY5", {0x8125});
+    addOpcode(benchmarks, "8XY6", {0x8126});
+    addOpcode(benchmarks, "8XY7", {0x8127});
+    addOpcode(benchmarks, "8XYE", {0x812E});
+    addOpcode(benchmarks, "9XY0", {0x9120});
+    addOpcode(benchmarks, "ANNN", {0xA300});
+    addOpcode(benchmarks, "BNNN", {0xB300});
+    addOpcode(benchmarks, "CXNN", {0xC1FF});
+    // Sprites from the font at address 0; the XY registers hold 20 and 37
+    for (int height : {1, 5, 8, 15}) {
+        addOpcode(benchmarks, "DXYN/height:" + std::to_string(height), {static_cast<uint16_t>(0xD120 | height)}, 0x000);
+    }
+    addOpcode(benchmarks, "EX9E", {0xE59E});
+    addOpcode(benchmarks, "EXA1", {0xE5A1});
+    addOpcode(benchmarks, "FX07", {0xF107});
+    addOpcode(benchmarks, "FX0A", {0xF10A});
+    addOpcode(benchmarks, "FX15", {0xF115});
+    addOpcode(benchmarks, "FX18", {0xF118});
+    addOpcode(benchmarks, "FX1E+ANNN", {0xF11E, 0xA300});
+    addOpcode(benchmarks, "FX29", {0xF129});
+    addOpcode(benchmarks, "FX33", {0xF133});
+    addOpcode(benchmarks, "FX55/X:F", {0xFF55});
+    addOpcode(benchmarks, "FX65/X:F", {0xFF65});
+
+    // End to end through fetch and dispatch
+    addProgram(benchmarks, "alu", toRom({
+        0x6001, 0x6103, 0xA300, 0x8014, 0x8125, 0x8203, 0x7301,
+        0x8306, 0x4300, 0x6305, 0xF01E, 0xA300, 0xF233, 0x1206
+    }));
+    addProgram(benchmarks, "draw", toRom({
+        0x6000, 0x6108, 0x7108, 0xA000, 0xD015, 0x7001, 0x303F, 0x1202, 0x1200
+    }));
+    addProgram(benchmarks, "call", toRom({
+        0x2206, 0x7001, 0x1200, 0x8014, 0x00EE
+    }));
+    for (const std::string& path : romPaths) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file.is_open()) {
+            std::cerr << "Failed to open ROM: " << path << std::endl;
+            continue;
+        }
+        std::vector<uint8_t> rom((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        std::string name = path.substr(path.find_last_of("/\\") + 1);
+        addProgram(benchmarks, "rom:" + name, rom);
+    }
+
+    std::array<uint16_t, 16> stack{};
+    stack[0] = 0x202;
+    uint8_t bytes[16] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+    RegisterEvent registers(1000);
+    registers.set(0, 1).set(5, 200).set(15, 1);
+    addEvent(benchmarks, "opcode", OpcodeEvent(1000, 0x200, 0x8124));
+    addEvent(benchmarks, "stack", StackEvent(1000, 0x200, 0x206, 1, stack));
+    addEvent(benchmarks, "register", registers);
+    addEvent(benchmarks, "memory", MemoryEvent(1000, 0x300, bytes, 16));
+    addEvent(benchmarks, "input", InputEvent(1000, 5, true));
+    addEvent(benchmarks, "timer", TimerEvent(1000, false, 60));
+    addEvent(benchmarks, "draw", DrawEvent(1000, 20, 10, 0x000, bytes, 15, true));
+    addEvent(benchmarks, "framebuffer_cleared", FramebufferClearedEvent(1000));
+
+    // Display conversion as done by Chip8Renderer (full frame of 32 rows)
+    Framebuffer screen;
+    for (unsigned y = 0; y < Framebuffer::HEIGHT; ++y) {
+        screen.drawSpriteRow(y * 3, y, static_cast<uint8_t>(0xA5 ^ y));
+    }
+    benchmarks.push_back({std::string("pixel_convert/expand_rows/") + pixelConvertKernel(), [screen](uint64_t n) {
+        std::vector<uint32_t> pixels(Framebuffer::PIXEL_COUNT);
+        for (uint64_t i = 0; i < n; ++i) {
+            expandRows(screen.data(), Framebuffer::HEIGHT, pixels.data(), Framebuffer::WIDTH * 4,
+                       0xFFFFFFFFu, 0xFF000000u);
+            sink = sink + pixels[i & (Framebuffer::PIXEL_COUNT - 1)];
+        }
+    }});
+    benchmarks.push_back({"pixel_convert/to_bytes", [screen](uint64_t n) {
+        std::vector<uint8_t> bytes(Framebuffer::PIXEL_COUNT);
+        for (uint64_t i = 0; i < n; ++i) {
+            screen.toBytes(bytes.data());
+            sink = sink + bytes[i & (Framebuffer::PIXEL_COUNT - 1)];
+        }
+    }});
+    return benchmarks;
+}
+
+static double elapsedNs(const Benchmark& benchmark, uint64_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    benchmark.run(iterations);
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ * @brief Times a benchmark like Google Benchmark does.
+ *
+ * The iteration count grows until one run takes at least minTime seconds,
+ * then that count is repeated. Setup inside run() is included, so the count
+ * is kept large enough to amortise it.
+ */
+static BenchResult runBenchmark(const Benchmark& benchmark, double minTime, int repetitions) {
+    uint64_t iterations = 1;
+    double ns = elapsedNs(benchmark, iterations);
+    while (ns < minTime * 1e9 && iterations < (1ULL << 40)) {
+        double scale = ns > 0 ? minTime * 1e9 * 1.2 / ns : 100.0;
+        iterations = static_cast<uint64_t>(iterations * std::min(std::max(scale, 2.0), 100.0));
+        ns = elapsedNs(benchmark, iterations);
+    }
+    std::vector<double> perOp = {ns / iterations};
+    for (int r = 1; r < repetitions; ++r) {
+        perOp.push_back(elapsedNs(benchmark, iterations) / iterations);
+    }
+    std::sort(perOp.begin(), perOp.end());
+    return {benchmark.name, iterations, perOp.front(), perOp[perOp.size() / 2]};
+}
+
+static std::string jsonEscape(const std::string& text) {
+    std::string out;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+        }
+        out += c;
+    }
+    return out;
+}
+
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options] [ROM files...]\n"
+              << "  --format csv|json     Output format (default csv)\n"
+              << "  --filter TEXT         Only run benchmarks whose name contains TEXT\n"
+              << "  --min-time SECONDS    Minimum time per repetition (default 0.1)\n"
+              << "  --repetitions N       Timed repetitions per benchmark (default 3)\n"
+              << "  --list                Print benchmark names and exit\n"
+              << "ROM files are run end to end through emulateCycle() in every execution mode.\n";
+}
+
+/**
+ * @brief Per-opcode, end-to-end, event serialization and pixel conversion microbenchmarks.
+ *
+ * Prints one record per benchmark as CSV or as JSON in the layout of Google
+ * Benchmark's --benchmark_format=json, so results can be tracked per commit.
+ */
+int main(int argc, char* argv[]) {
+    std::string format = "csv";
+    std::string filter;
+    double minTime = 0.1;
+    int repetitions = 3;
+    bool list = false;
+    std::vector<std::string> romPaths;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << arg << std::endl;
+                std::exit(1);
+            }
+            return argv[++i];
+        };
+        if (arg == "--format") {
+            format = value();
+        } else if (arg == "--filter") {
+            filter = value();
+        } else if (arg == "--min-time") {
+            minTime = std::atof(value());
+        } else if (arg == "--repetitions") {
+            repetitions = std::max(1, std::atoi(value()));
+        } else if (arg == "--list") {
+            list = true;
+        } else if (arg == "--help" || arg == "-h") {
+            printUsage(argv[0]);
+            return 0;
+        } else if (!arg.empty() && arg[0] == '-') {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            romPaths.push_back(arg);
+        }
+    }
+    if (format != "csv" && format != "json") {
+        std::cerr << "Unknown format: " << format << std::endl;
+        return 1;
+    }
+
+    std::vector<BenchResult> results;
+    for (const Benchmark& benchmark : registerBenchmarks(romPaths)) {
+        if (benchmark.name.find(filter) == std::string::npos) {
+            continue;
+        }
+        if (list) {
+            std::cout << benchmark.name << '\n';
+            continue;
+        }
+        results.push_back(runBenchmark(benchmark, minTime, repetitions));
+        if (format == "csv") {
+            const BenchResult& r = results.back();
+            if (results.size() == 1) {
+                std::cout << "name,iterations,ns_per_op,median_ns_per_op,ops_per_second\n";
+            }
+            std::cout << r.name << ',' << r.iterations << ',' << r.minNs << ',' << r.medianNs << ','
+                      << 1e9 / r.minNs << std::endl;
+        }
+    }
+
+    if (format == "json" && !list) {
+        char date[32];
+        std::time_t now = std::time(nullptr);
+        std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", std::localtime(&now));
+#ifdef NDEBUG
+        const char* buildType = "release";
+#else
+        const char* buildType = "debug";
+#endif
+        std::cout << "{\n  \"context\": {\n"
+                  << "    \"date\": \"" << date << "\",\n"
+                  << "    \"library_build_type\": \"" << buildType << "\",\n"
+                  << "    \"pixel_convert_kernel\": \"" << pixelConvertKernel() << "\",\n"
+                  << "    \"repetitions\": " << repetitions << "\n  },\n"
+                  << "  \"benchmarks\": [";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchResult& r = results[i];
+            std::cout << (i ? ",\n" : "\n") << "    {\"name\": \"" << jsonEscape(r.name)
+                      << "\", \"iterations\": " << r.iterations << ", \"real_time\": " << r.minNs
+                      << ", \"median_time\": " << r.medianNs << ", \"time_unit\": \"ns\""
+                      << ", \"items_per_second\": " << 1e9 / r.minNs << "}";
+        }
+        std::cout << "\n  ]\n}\n";
+    }
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <vector>
+#include "chip8.h"
+#include "chip8_state.h"
+#include "rewind_buffer.h"
+#include "visited_set.h"
+
+// Counter loop that also stores into memory, so successive snapshots differ in data bytes.
+static const uint16_t COUNTER_PROGRAM[] = {
+    0xA300,         // 0x200: LD I, 0x300
+    0x7001,         // 0x202: ADD V0, 1
+    0xF033,         // 0x204: LD B, V0
+    0x6A05,         // 0x206: LD VA, 5
+    0xC1FF,         // 0x208: RND V1, 0xFF
+    0x1202          // 0x20A: JP 0x202
+};
+
+/**
+ * @brief Times an operation and prints one CSV line.
+ *
+ * @param name Operation name.
+ * @param iterations Number of times to run op.
+ * @param op The operation.
+ */
+template <typename F>
+static void measure(const char* name, uint64_t iterations, F&& op) {
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iterations; ++i) {
+        op(i);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ',' << iterations << ',' << seconds * 1e9 / iterations << ','
+              << iterations / seconds / 1e6 << '\n';
+}
+
+/**
+ * @brief Measures snapshot, restore, fork, hashing, serialization and rewind throughput.
+ *
+ * Usage: chip8_state_bench [iterations]
+ */
+int main(int argc, char* argv[]) {
+    uint64_t iterations = argc > 1 ? std::strtoull(argv[1], nullptr, 0) : 2000000ULL;
+
+    std::vector<uint8_t> rom;
+    for (uint16_t word : COUNTER_PROGRAM) {
+        rom.push_back(word >> 8);
+        rom.push_back(word & 0xFF);
+    }
+    Chip8 chip8;
+    chip8.loadProgram(rom.data(), rom.size());
+    chip8.execute(1000);
+
+    Chip8State states[2];
+    chip8.saveState(states[0]);
+    chip8.execute(400);
+    chip8.saveState(states[1]);
+    std::vector<uint8_t> buffer(sizeof(Chip8State));
+    volatile uint64_t sink = 0;
+
+    std::cout << std::fixed << std::setprecision(1) << "operation,iterations,ns_per_op,mops\n";
+    measure("save", iterations, [&](uint64_t) {
+        chip8.saveState(states[1]);
+        sink = sink + states[1].pc;
+    });
+    measure("restore_same", iterations, [&](uint64_t) {
+        chip8.loadState(states[0]);
+    });
+    // The two snapshots differ in the BCD bytes, so every restore copies a chunk
+    measure("restore_alternating", iterations, [&](uint64_t i) {
+        chip8.loadState(states[i & 1]);
+    });
+    measure("rollback_run_100", iterations / 10, [&](uint64_t) {
+        chip8.loadState(states[0]);
+        sink = sink + chip8.execute(100);
+    });
+    // Branching a search: 16 children per node, one per key, each running a 60Hz frame
+    measure("fork", iterations, [&](uint64_t) {
+        std::unique_ptr<Chip8> child = chip8.fork();
+        sink = sink + child->getProgramCounter();
+    });
+    measure("fork_run_frame", iterations / 10, [&](uint64_t i) {
+        std::unique_ptr<Chip8> child = chip8.fork();
+        child->key[i & 15] = 1;
+        sink = sink + child->execute(12);
+        child->tickTimers();
+    });
+    Chip8 scratch;
+    scratch.setExecutionMode(ExecutionMode::Interpret);
+    measure("copy_run_frame", iterations / 10, [&](uint64_t i) {
+        chip8.saveState(states[1]);
+        scratch.loadState(states[1]);
+        scratch.key[i & 15] = 1;
+        sink = sink + scratch.execute(12);
+        scratch.tickTimers();
+    });
+    measure("state_hash", iterations, [&](uint64_t) {
+        sink = sink + chip8.stateHash();
+    });
+    VisitedSet visited(iterations * 2);
+    measure("visited_insert", iterations, [&](uint64_t i) {
+        sink = sink + visited.insert(i * 0x9e3779b97f4a7c15ULL);
+    });
+    measure("serialize", iterations, [&](uint64_t) {
+        sink = sink + states[0].serialize(buffer.data(), buffer.size());
+    });
+    measure("deserialize", iterations, [&](uint64_t) {
+        sink = sink + states[1].deserialize(buffer.data(), buffer.size());
+    });
+
+    // One snapshot per 60Hz frame at 700 instructions per second
+    std::vector<Chip8State> frames(10000);
+    for (Chip8State& frame : frames) {
+        chip8.execute(12);
+        chip8.tickTimers();
+        chip8.saveState(frame);
+    }
+    RewindBuffer rewind(size_t(1) << 30);
+    measure("rewind_push", frames.size(), [&](uint64_t i) {
+        rewind.push(frames[i]);
+    });
+    RewindStats history = rewind.getStats();
+    std::cerr << "rewind compression " << history.compressionRatio << "x, avg delta "
+              << history.avgDeltaBytes << " bytes" << std::endl;
+    measure("rewind_seek", iterations / 10, [&](uint64_t i) {
+        sink = sink + rewind.seek((i * 7919) % frames.size(), states[0]);
+    });
+    measure("rewind_step_back", frames.size() - 1, [&](uint64_t) {
+        sink = sink + rewind.stepBack(states[0]);
+    });
+
+    const char* path = "chip8_state_bench.c8s";
+    uint64_t fileIterations = iterations / 100 > 0 ? iterations / 100 : 1;
+    measure("save_file", fileIterations, [&](uint64_t) {
+        states[0].saveToFile(path);
+    });
+    measure("load_file", fileIterations, [&](uint64_t) {
+        sink = sink + states[1].loadFromFile(path);
+    });
+    std::remove(path);
+    return 0;
+}
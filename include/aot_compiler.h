@@ -0,0 +1,79 @@
+#pragma once
+#include "rom_analysis.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @class AotCompiler
+ * @brief Translates a ROM image into a C++ translation unit that runs it natively.
+ *
+ * compile() analyzes the image (see RomAnalysis) and turns every basic block
+ * into a straight-line C++ function over an AotContext: arithmetic, loads,
+ * timers, keys, sprites and control flow are inlined with the exact
+ * semantics of the TraceLevel::None opcode handlers, and the rest (FX0A,
+ * FX33, FX55 and unknown opcodes) calls the handler itself. A block ends at
+ * its first control transfer. Every instruction of a block is also an entry
+ * point, and the block counts instructions against the cycle budget, so
+ * execution can stop and resume anywhere, exactly as the interpreter does.
+ * FX0A leaves a block early when no key is held, and a store leaves it early
+ * when it overwrote compiled code. A run() function switches on pc to enter
+ * blocks, so indirect targets (00EE, BNNN) reach any compiled instruction,
+ * and returns to the core wherever pc is not one.
+ *
+ * writeSource() emits the unit, exporting an AotModuleInfo that AotModule
+ * loads once it is built into a shared object.
+ */
+class AotCompiler {
+public:
+    static constexpr uint16_t MEMORY_SIZE = RomAnalysis::MEMORY_SIZE;
+
+    /**
+     * @brief Compiles a ROM image; replaces any previous result.
+     * @param rom Program bytes, as passed to Chip8::loadProgram().
+     * @param size Number of bytes.
+     * @return false if the image is empty or does not fit in memory.
+     */
+    bool compile(const uint8_t* rom, size_t size);
+
+    /**
+     * @brief Writes the translation unit.
+     * @param out Destination.
+     * @param romName Name of the ROM, for the header comment.
+     */
+    void writeSource(std::ostream& out, const std::string& romName) const;
+
+    const RomAnalysis& getAnalysis() const { return analysis; }
+    size_t getBlockCount() const { return blocks.size(); }
+    size_t getInstructionCount() const;
+
+    /**
+     * @brief Returns how many compiled instructions call their handler instead of being inlined.
+     */
+    size_t getDispatchCount() const;
+
+private:
+    struct Block {
+        uint16_t start;
+        std::vector<uint16_t> opcodes;   // From start, two bytes apart
+    };
+
+    bool compiled(uint16_t address) const {
+        address &= MEMORY_SIZE - 1;
+        return (codeMap[address / 8] & (1u << (address % 8))) != 0;
+    }
+    uint16_t word(uint16_t address) const {
+        return static_cast<uint16_t>(image[address - RomAnalysis::LOAD_ADDRESS] << 8 |
+                                     image[address - RomAnalysis::LOAD_ADDRESS + 1]);
+    }
+    void writeBlock(std::ostream& out, const Block& block) const;
+    void writeInstruction(std::ostream& out, uint16_t address, uint16_t opcode) const;
+
+    RomAnalysis analysis;
+    std::vector<uint8_t> image;
+    std::vector<Block> blocks;
+    std::array<uint8_t, MEMORY_SIZE / 8> codeMap{};   // One bit per compiled instruction byte
+};
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class Chip8;
+struct AotModuleInfo;
+
+/**
+ * @class AotModule
+ * @brief A ROM compiled ahead of time by chip8-aot, loaded from a shared object.
+ *
+ * Attach one with Chip8::setAotModule() after loading the image it was
+ * compiled from (see matches()). Chip8::execute() then runs the module's
+ * native blocks wherever pc is at a compiled block leader and falls back to
+ * its execution mode for everything else: addresses the analysis never
+ * reached, block tails that do not fit the cycle budget, tracing and
+ * profiling. A store that writes compiled code detaches the module from
+ * that instance for good, so self-modifying programs finish on the
+ * interpreter.
+ *
+ * The module is read-only once loaded and may be shared by any number of
+ * instances on any number of threads. It must have been compiled against
+ * the same chip8.h as the program loading it; load() checks the interface
+ * version and sizeof(Chip8). Modules resolve AotContext::dispatch() against
+ * the loading executable, which must therefore export its symbols.
+ */
+class AotModule {
+public:
+    AotModule();
+    ~AotModule();
+
+    AotModule(const AotModule&) = delete;
+    AotModule& operator=(const AotModule&) = delete;
+
+    /**
+     * @brief Loads a module built from chip8-aot output.
+     * @param path Path to the shared object.
+     * @return false (with a message on stderr) if it cannot be opened or was
+     *         built for another interface.
+     */
+    bool load(const std::string& path);
+
+    /**
+     * @brief Returns whether the module was compiled from exactly this image.
+     */
+    bool matches(const uint8_t* rom, size_t size) const;
+
+    /**
+     * @brief Returns whether any of length bytes from address, wrapping at 4 KiB, is compiled code.
+     */
+    bool covers(uint16_t address, uint16_t length) const;
+
+    /**
+     * @brief Runs compiled code from the machine's pc; see AotModuleInfo::run.
+     */
+    uint64_t run(Chip8& chip8, uint64_t maxCycles) const;
+
+    const std::string& getPath() const { return path_; }
+    uint32_t getBlockCount() const;
+
+private:
+    void* handle_;
+    const AotModuleInfo* info_;
+    std::string path_;
+};
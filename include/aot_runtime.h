@@ -0,0 +1,115 @@
+#pragma once
+#include "chip8.h"
+#include <cstdint>
+
+/**
+ * @brief Version of the interface between the core and chip8-aot modules.
+ *
+ * Bumped whenever AotModuleInfo, AotContext or the Chip8 members they
+ * expose change; AotModule refuses modules built against another version.
+ */
+constexpr uint32_t AOT_ABI_VERSION = 1;
+
+/**
+ * @struct AotContext
+ * @brief The view of a Chip8 that code generated by chip8-aot runs against.
+ *
+ * Binds references to the machine's registers once per AotModuleInfo::run()
+ * call, so generated blocks read and write the same state, with the same
+ * semantics, as the TraceLevel::None opcode handlers. Instructions the
+ * generator does not inline go through dispatch(), which runs the handler
+ * itself.
+ */
+struct AotContext {
+    explicit AotContext(Chip8& chip8)
+        : chip8(chip8), memory(chip8.memory), V(chip8.V.data()), stack(chip8.stack.data()),
+          key(chip8.key.data()), I(chip8.I), pc(chip8.pc), sp(chip8.sp), delayTimer(chip8.delay_timer),
+          soundTimer(chip8.sound_timer), opcode(chip8.opcode), idle(chip8.idleState) {}
+
+    /**
+     * @brief Runs one instruction through its TraceLevel::None handler.
+     * @param address Address of the instruction; pc is set to it first.
+     * @param op The instruction.
+     */
+    void dispatch(uint16_t address, uint16_t op) {
+        pc = address;
+        dispatchOpcode(chip8, op);
+    }
+
+    /**
+     * @brief Draws the next CXNN random value from the machine's generator.
+     */
+    uint32_t random() { return chip8.nextRandom(); }
+
+    /**
+     * @brief Returns whether the module is still attached, i.e. no store has written compiled code.
+     */
+    bool attached() const { return chip8.aotModule != nullptr; }
+
+    /**
+     * @brief Leaves a block before its end, e.g. when the cycle budget runs out.
+     * @param next Address to resume at.
+     * @param op The last instruction run.
+     * @param ran Instructions the block ran.
+     * @return ran
+     */
+    uint32_t leave(uint16_t next, uint16_t op, uint32_t ran) {
+        pc = next;
+        opcode = op;
+        return ran;
+    }
+
+    /**
+     * @brief Leaves a block after its last instruction, flagging a jump to
+     *        itself as Halted the way Chip8::execute() does for a translated block.
+     * @param last Address of the last instruction.
+     * @param op The last instruction.
+     * @param ran Instructions the block ran.
+     * @return ran
+     */
+    uint32_t finish(uint16_t last, uint16_t op, uint32_t ran) {
+        opcode = op;
+        if (idle == IdleState::Running && (pc & 0x0FFF) == last) {
+            idle = IdleState::Halted;
+        }
+        return ran;
+    }
+
+    Chip8& chip8;
+    const PagedMemory& memory;
+    uint8_t* V;
+    uint16_t* stack;
+    const uint8_t* key;
+    uint16_t& I;
+    uint16_t& pc;
+    uint16_t& sp;
+    uint8_t& delayTimer;
+    uint8_t& soundTimer;
+    uint16_t& opcode;
+    IdleState& idle;
+
+private:
+    static void dispatchOpcode(Chip8& chip8, uint16_t op);
+};
+
+/**
+ * @struct AotModuleInfo
+ * @brief What a module generated by chip8-aot exports, as the C symbol chip8_aot_module.
+ */
+struct AotModuleInfo {
+    uint32_t abiVersion;          // AOT_ABI_VERSION the module was generated for
+    uint32_t chip8Size;           // sizeof(Chip8) the module was compiled against
+    const uint8_t* image;         // The ROM image the module was compiled from
+    uint32_t imageSize;
+    const uint8_t* codeMap;       // One bit per address, set for every compiled instruction byte
+    uint32_t blockCount;
+    /**
+     * Runs compiled code from pc for up to maxCycles instructions. Returns
+     * the instructions retired, without adding them to the cycle counter,
+     * once the budget is spent, the machine goes idle, pc leaves compiled
+     * code or a store detaches the module.
+     */
+    uint64_t (*run)(Chip8& chip8, uint64_t maxCycles);
+};
+
+extern "C" const AotModuleInfo chip8_aot_module;
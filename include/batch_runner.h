@@ -0,0 +1,126 @@
+#pragma once
+#include "aot_module.h"
+#include "chip8.h"
+#include "profiler.h"
+#include "rom_analysis.h"
+#include "rom_library.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @struct BatchJob
+ * @brief One headless ROM instance to run: a ROM image and a random seed.
+ */
+struct BatchJob {
+    std::string romPath;
+    uint32_t seed;
+    TraceLevel trace = TraceLevel::None;  // Logs to the EventLogger; at most one job per batch
+};
+
+/**
+ * @struct BatchResult
+ * @brief Outcome of a single headless instance.
+ */
+struct BatchResult {
+    std::string romPath;
+    uint32_t seed = 0;
+    bool loaded = false;           // False if the ROM could not be read or is too large
+    bool halted = false;           // True if the program stopped making progress
+    uint64_t cycles = 0;           // Virtual CPU cycles elapsed, including fast-forwarded idle time
+    uint64_t instructions = 0;     // Instructions actually executed
+    uint64_t framebufferHash = 0;  // FNV-1a hash of the final framebuffer
+    uint64_t stateHash = 0;        // Chip8::stateHash() of the final machine; 0 for banked jobs
+    bool native = false;           // True if the instance started with an AOT module attached
+    bool banked = false;           // True if the instance ran as a lane of a VmBank
+    double wallMs = 0.0;           // Wall-clock time spent running the instance
+};
+
+/**
+ * @struct BatchConfig
+ * @brief Parameters shared by every instance in a batch.
+ */
+struct BatchConfig {
+    uint64_t maxCycles = 1000000;  // Upper bound on instructions per instance
+    int cyclesPerSecond = 700;     // Virtual CPU speed; sets how often the 60Hz timers tick
+    size_t threads = 0;            // Worker threads; 0 uses the hardware concurrency
+    ExecutionMode mode = ExecutionMode::Translated;
+    size_t bankWidth = 0;          // 8, 16 or 32 runs same-ROM jobs in lockstep VmBanks; 0 runs them one by one
+    Profiler* profiler = nullptr;  // Receives every instance's counters; profiled batches are not banked
+    std::string profilePath;       // Dump prefix used when SIGUSR1 asks for a dump mid-batch
+    bool precompile = false;       // Analyze each ROM once and precompile every instance from it
+    std::vector<const AotModule*> aotModules;   // Native code for the ROMs whose images they match
+    const RomLibrary* library = nullptr;        // Looked up by ROM path first; other ROMs are mapped per batch
+};
+
+/**
+ * @class BatchRunner
+ * @brief Runs many headless CHIP-8 instances in parallel.
+ *
+ * Each distinct ROM path is looked up in the configured RomLibrary, or else
+ * mapped from disk once; instances are then sharded over a work-stealing
+ * ThreadPool and load from the shared image without touching the disk.
+ * Instances have no renderer and no input, and run on virtual time: the
+ * timers tick every cyclesPerSecond / 60 instructions rather than against
+ * the wall clock. A single job may be traced to the EventLogger (see
+ * BatchJob::trace); the others run the untraced handlers. The logger
+ * accepts events from one thread only, hence one job.
+ *
+ * With a bankWidth set, untraced jobs that share a ROM are packed into
+ * VmBanks of that many lanes, one bank per pool task. The results are the
+ * same as running the jobs one by one; the bank's wall time is split evenly
+ * over its lanes.
+ *
+ * With precompile set, each distinct image is also analyzed once (see
+ * RomLibrary::Rom::analysis()) and the read-only result is shared by all of
+ * its instances, whatever paths they named it by.
+ *
+ * Each distinct image is also matched once against aotModules; instances of
+ * a ROM with a match run with that module attached (see AotModule) and are
+ * not banked.
+ *
+ * With a profiler set, each instance profiles into a Profiler of its own,
+ * one frame per timer tick, and merges it into the shared one when it
+ * finishes. Banks have no per-instruction hooks, so profiling disables them.
+ */
+class BatchRunner {
+public:
+    explicit BatchRunner(const BatchConfig& config);
+
+    /**
+     * @brief Runs every job and returns the results in job order.
+     * @param jobs The instances to run.
+     * @return One result per job.
+     */
+    std::vector<BatchResult> run(const std::vector<BatchJob>& jobs) const;
+
+    /**
+     * @brief Runs a single instance from an in-memory ROM image.
+     *
+     * Execution stops after maxCycles virtual cycles, or earlier when the
+     * program halts: a jump to itself, or FX0A waiting for a key that will
+     * never come. Delay timer poll loops are fast-forwarded to the next timer
+     * tick, so they count towards the cycle limit without being executed.
+     * With an analysis of the ROM, the instance is precompiled from it
+     * (see Chip8::precompile()) before the first cycle; with an AOT module
+     * compiled from it, the module is attached.
+     */
+    static BatchResult runInstance(const RomLibrary::Rom& rom, const BatchJob& job,
+                                   const BatchConfig& config, const RomAnalysis* analysis = nullptr,
+                                   const AotModule* aot = nullptr);
+
+    /**
+     * @brief Runs up to N jobs on one ROM in lockstep, with the same virtual
+     *        time rules as runInstance().
+     * @param rom ROM image.
+     * @param jobs The jobs, at most N.
+     * @param results Receives one result per job.
+     */
+    template <size_t N>
+    static void runBank(const RomLibrary::Rom& rom, const std::vector<const BatchJob*>& jobs,
+                        const std::vector<BatchResult*>& results, const BatchConfig& config);
+
+private:
+    BatchConfig config_;
+};
@@ -0,0 +1,89 @@
+#pragma once
+#include "opcode.h"
+#include "paged_memory.h"
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * @class BlockCache
+ * @brief Translates straight-line CHIP-8 code into threaded-code blocks.
+ *
+ * A block starts at some pc and runs until the first instruction that can
+ * change control flow (jumps, calls, returns, skips, FX0A) or write memory
+ * (FX33, FX55), which is included as the block's terminator. The block's
+ * instructions are stored pre-decoded in one contiguous array so executing it
+ * is a tight loop of indirect calls with no per-instruction fetch or lookup.
+ *
+ * Common pairs are fused into superinstructions that occupy the first slot of
+ * the pair and read their second half from the following slot:
+ *   - 6XNN;7XNN  (load then add)
+ *   - ANNN;DXYN  (point I at a sprite then draw it)
+ *   - 3XNN;1NNN  (skip-or-jump loop tail; terminates the block)
+ *
+ * Blocks are keyed by start address and dropped when any byte they cover is
+ * written. Dropped blocks are kept alive until releaseRetired(), so a store
+ * that overwrites the block currently executing is safe.
+ */
+class BlockCache {
+public:
+    static constexpr uint16_t MEMORY_SIZE = 4096;
+    static constexpr uint16_t MAX_BLOCK_LENGTH = 32;   // Guest instructions per block
+
+    struct Block {
+        uint16_t start;                  // Address of the first instruction
+        uint16_t end;                    // One past the last byte covered
+        uint16_t last;                   // Address of the terminating instruction
+        uint16_t length;                 // Guest instructions in the block
+        bool skippableTail;              // Ends in a fused 3XNN;1NNN whose jump may be skipped
+        std::vector<Instruction> code;   // Threaded code, one slot per guest instruction
+        std::vector<uint8_t> strides;    // Slots to advance after each op (2 after a fused pair)
+    };
+
+    BlockCache();
+
+    /**
+     * @brief Returns the block starting at pc, translating it on a miss.
+     * @param memory The CHIP-8 memory to translate from.
+     * @param pc Start address.
+     */
+    const Block& lookup(const PagedMemory& memory, uint16_t pc) {
+        std::unique_ptr<Block>& block = blocks[pc & (MEMORY_SIZE - 1)];
+        if (!block) {
+            block = translate(memory, pc & (MEMORY_SIZE - 1));
+            for (uint16_t address = block->start; address < block->end; ++address) {
+                translatedBytes.set(address & (MEMORY_SIZE - 1));
+            }
+        }
+        return *block;
+    }
+
+    /**
+     * @brief Drops every block overlapping a written range.
+     * @param address First written address.
+     * @param length Number of bytes written.
+     */
+    void invalidate(uint16_t address, uint16_t length);
+
+    /**
+     * @brief Drops every block, e.g. after a new program is loaded.
+     */
+    void invalidateAll();
+
+    /**
+     * @brief Frees blocks dropped since the last call. Must not be called while
+     * a block is executing.
+     */
+    void releaseRetired() { retired.clear(); }
+
+private:
+    static std::unique_ptr<Block> translate(const PagedMemory& memory, uint16_t pc);
+    static bool endsBlock(OpHandler handler);
+    static void fuse(Block& block);
+
+    std::array<std::unique_ptr<Block>, MEMORY_SIZE> blocks;
+    std::vector<std::unique_ptr<Block>> retired;
+    std::bitset<MEMORY_SIZE> translatedBytes;   // Bytes covered by some block (may be stale)
+};
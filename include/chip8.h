@@ -8,23 +8,97 @@
  * loading ROMs, running emulation cycles, and managing system state.
  */
 #pragma once
+#include "framebuffer.h"
+#include "paged_memory.h"
 #include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+class EventLogger;
+class Profiler;
+class AotModule;
+class RomAnalysis;
+class DecodeCache;
+class BlockCache;
+struct Chip8State;
+
+/**
+ * @brief How Chip8::emulateCycle() turns memory into handler calls.
+ */
+enum class ExecutionMode {
+    Interpret,   // Fetch and decode every instruction from memory each cycle
+    Predecoded,  // Reuse per-address decoded instructions from a DecodeCache
+    Translated   // Run whole basic blocks of threaded code from a BlockCache
+};
+
+/**
+ * @brief How much of the execution is reported to the attached EventLogger.
+ *
+ * Each level runs its own instantiation of the opcode handlers, so at None
+ * the hot path contains no event construction and no logger checks.
+ */
+enum class TraceLevel {
+    None,      // Nothing is logged
+    Opcodes,   // One OpcodeEvent per instruction
+    Full       // Opcodes plus stack, register, memory, timer and draw events
+};
+
+template <TraceLevel L> class OpcodeHandler;
+
+/**
+ * @brief Why the core stopped making progress, if it did.
+ *
+ * Chip8::execute() returns early as soon as the state leaves Running, since
+ * spinning further cannot change anything until the named condition is met.
+ */
+enum class IdleState {
+    Running,
+    WaitingForKey,     // FX0A with no key held
+    WaitingForTimer,   // FX07; 3X00; 1NNN poll loop while the delay timer is non-zero
+    Halted             // An instruction left pc unchanged, e.g. a jump to itself
+};
 
 class Chip8 {
 
-    friend class OpcodeHandler;
+    template <TraceLevel L> friend class OpcodeHandler;
+    friend struct AotContext;
 
     public:
         Chip8();
+        ~Chip8();
         void loadRom(const char* filename);
+        bool loadProgram(const uint8_t* data, size_t size);
+        void precompile(const RomAnalysis& analysis);
         void emulateCycle();
+        uint64_t execute(uint64_t maxCycles);
+        void tickTimers();
+        void setExecutionMode(ExecutionMode mode);
+        ExecutionMode getExecutionMode() const { return executionMode; }
+        void seedRandom(uint32_t seed);
+        void saveState(Chip8State& state) const;
+        bool loadState(const Chip8State& state);
+        std::unique_ptr<Chip8> fork() const;
+        uint64_t stateHash() const;
+        void setEventLogger(EventLogger* logger, TraceLevel level = TraceLevel::Full);
+        void setTraceLevel(TraceLevel level);
+        TraceLevel getTraceLevel() const { return traceLevel; }
+        void setProfiler(Profiler* profiler) { this->profiler = profiler; }
+        Profiler* getProfiler() const { return profiler; }
+        void setAotModule(const AotModule* module) { aotModule = module; }
+        const AotModule* getAotModule() const { return aotModule; }
+        uint64_t getCycleCount() const { return cycleCount; }
+        uint16_t getProgramCounter() const { return pc; }
+        IdleState getIdleState() const { return idleState; }
+        bool timersActive() const { return delay_timer > 0 || sound_timer > 0; }
+        uint8_t getSoundTimer() const { return sound_timer; }
         bool drawFlag;
-        std::array<uint8_t, 2048> gfx;
+        Framebuffer gfx;
         std::array<uint8_t, 16> key;
     
     
     private:
-        std::array<uint8_t, 4096> memory;
+        PagedMemory memory;                     // Copy-on-write pages, shared with forks
         std::array<uint8_t, 16> V;
         std::array<uint16_t, 16> stack;
 
@@ -34,6 +108,23 @@ class Chip8 {
         uint8_t delay_timer;
         uint8_t sound_timer;
         uint16_t opcode;
+        uint64_t cycleCount;
+        uint32_t rngState;          // Per-instance minstd generator for CXNN; see nextRandom()
+        EventLogger* eventLogger;   // Optional; nullptr disables event logging
+        TraceLevel traceLevel;      // Always None while eventLogger is nullptr
+        Profiler* profiler;         // Optional; nullptr disables profiling
+        const AotModule* aotModule; // Optional native code for the loaded ROM; dropped when a store hits it
+        ExecutionMode executionMode;
+        std::unique_ptr<DecodeCache> decodeCache;   // Allocated in Predecoded and Translated modes
+        std::unique_ptr<BlockCache> blockCache;     // Allocated in Translated mode only
+        IdleState idleState;                        // Set by handlers; reset by execute()
+
+        Chip8(const Chip8& parent);   // Used by fork()
 
         void initialize();
-};
\ No newline at end of file
+        uint32_t nextRandom();
+        void invalidateCode(uint16_t address, uint16_t length);
+        template <TraceLevel L> void runInstruction();
+        template <TraceLevel L, bool Profiled = false> void step();
+        template <TraceLevel L, bool Profiled = false> uint64_t stepUntilIdle(uint64_t maxCycles);
+};
@@ -0,0 +1,93 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+/**
+ * @struct Chip8State
+ * @brief Versioned, fixed-layout snapshot of a Chip8 machine.
+ *
+ * Holds everything that determines future execution: memory, registers,
+ * stack, timers, display, keypad, cycle counter and random generator state.
+ * Execution mode, trace level and caches are configuration, not state, and
+ * are left out.
+ *
+ * The struct is its own serialized form: every field has a fixed offset, so
+ * writing a snapshot to a buffer or a file is a single memcpy/fwrite and
+ * reading it back is the same plus a header check. Multi-byte fields are
+ * stored in host byte order; a snapshot taken on a big-endian host fails the
+ * magic check on a little-endian one rather than loading garbage.
+ *
+ * Take snapshots with Chip8::saveState() and restore them with
+ * Chip8::loadState().
+ */
+struct Chip8State {
+    static constexpr uint32_t MAGIC = 0x53533843;   // "C8SS" in little-endian byte order
+    static constexpr uint16_t VERSION = 1;
+
+    // Header
+    uint32_t magic = MAGIC;
+    uint16_t version = VERSION;
+    uint16_t reserved = 0;
+    uint32_t size = sizeof(Chip8State);
+    uint32_t flags = 0;
+
+    // Machine state
+    std::array<uint8_t, 4096> memory;
+    std::array<uint64_t, 32> display;   // Framebuffer rows, bit 63 = x 0
+    std::array<uint16_t, 16> stack;
+    std::array<uint8_t, 16> V;
+    std::array<uint8_t, 16> key;
+    uint64_t cycleCount;
+    uint32_t rngState;
+    uint16_t I;
+    uint16_t pc;
+    uint16_t sp;
+    uint16_t opcode;
+    uint8_t delayTimer;
+    uint8_t soundTimer;
+    uint8_t drawFlag;
+    uint8_t padding = 0;
+
+    /**
+     * @brief Checks the magic number, version and size recorded in the header.
+     */
+    bool valid() const { return magic == MAGIC && version == VERSION && size == sizeof(Chip8State); }
+
+    /**
+     * @brief Copies the snapshot into a caller-provided buffer.
+     * @param out Destination buffer.
+     * @param capacity Size of out in bytes.
+     * @return Bytes written, or 0 if the buffer is smaller than sizeof(Chip8State).
+     */
+    size_t serialize(uint8_t* out, size_t capacity) const;
+
+    /**
+     * @brief Replaces the snapshot with one read from a buffer.
+     * @param in Serialized snapshot.
+     * @param length Number of bytes available at in.
+     * @return false if the buffer is too short or the header does not match.
+     */
+    bool deserialize(const uint8_t* in, size_t length);
+
+    /**
+     * @brief Writes the snapshot to a file.
+     * @param path Output file.
+     * @return false if the file could not be written.
+     */
+    bool saveToFile(const std::string& path) const;
+
+    /**
+     * @brief Replaces the snapshot with one read from a file.
+     * @param path Snapshot file written by saveToFile().
+     * @return false if the file is missing, short, or not a supported snapshot.
+     */
+    bool loadFromFile(const std::string& path);
+};
+
+static_assert(std::is_trivially_copyable<Chip8State>::value, "Chip8State must be memcpy-able");
+static_assert(std::is_standard_layout<Chip8State>::value, "Chip8State must have a fixed layout");
+static_assert(offsetof(Chip8State, memory) == 16, "Chip8State header layout changed");
+static_assert(sizeof(Chip8State) == 4456, "Chip8State layout changed; bump VERSION");
@@ -1,4 +1,5 @@
 #pragma once
+#include "framebuffer.h"
 #include <SDL3/SDL.h>
 #include <cstdint>
 #include <iostream>
@@ -10,6 +11,8 @@
  *
  * Manages the SDL window, renderer, and texture for displaying the CHIP-8
  * graphics buffer. Provides methods for initialization and frame rendering.
+ * Only the rows that changed since the previous frame are converted and
+ * written into the locked streaming texture.
  */
 class Chip8Renderer {
 public:
@@ -17,7 +20,8 @@ public:
     ~Chip8Renderer();
 
     int initialize();
-    void render(const uint8_t* videoBuffer);
+    bool setVSync(bool enabled);
+    void render(const Framebuffer& framebuffer, uint32_t dirtyRows);
 
 private:
     SDL_Window* window;
@@ -0,0 +1,55 @@
+#pragma once
+#include "opcode.h"
+#include "paged_memory.h"
+#include <array>
+#include <cstdint>
+
+/**
+ * @class DecodeCache
+ * @brief Per-address cache of decoded instructions over the 4 KiB memory.
+ *
+ * Entries are decoded lazily the first time an address is executed and
+ * reused afterwards, so the steady-state cost of an instruction is one
+ * indexed load and one indirect call. Any write to memory must invalidate
+ * the entries covering the written bytes (see invalidate()).
+ */
+class DecodeCache {
+public:
+    static constexpr uint16_t MEMORY_SIZE = 4096;
+
+    DecodeCache();
+
+    /**
+     * @brief Returns the decoded instruction at pc, decoding it on a miss.
+     *
+     * Entries hold handlers of the level they were decoded with, so the
+     * owner must invalidateAll() before fetching with a different level.
+     *
+     * @tparam L Trace level of the handlers to decode to.
+     * @param memory The CHIP-8 memory the cache covers.
+     * @param pc Address of the instruction.
+     */
+    template <TraceLevel L>
+    const Instruction& fetch(const PagedMemory& memory, uint16_t pc) {
+        Instruction& entry = entries[pc & (MEMORY_SIZE - 1)];
+        if (entry.handler == nullptr) {
+            entry = OpcodeHandler<L>::decode(memory.word(pc));
+        }
+        return entry;
+    }
+
+    /**
+     * @brief Drops the entries whose opcode bytes overlap a written range.
+     * @param address First written address.
+     * @param length Number of bytes written.
+     */
+    void invalidate(uint16_t address, uint16_t length);
+
+    /**
+     * @brief Drops every entry, e.g. after a new program is loaded.
+     */
+    void invalidateAll();
+
+private:
+    std::array<Instruction, MEMORY_SIZE> entries;
+};
@@ -1,16 +1,41 @@
 #pragma once
-#include "Chip8.h"
+#include "chip8.h"
 #include "chip8renderer.h"
+#include "frame_pacer.h"
+#include "input_movie.h"
+#include "profiler.h"
+#include "rewind_buffer.h"
+#include "scheduler.h"
+#include "triple_buffer.h"
 #include <SDL3/SDL.h>
 #include "event_logger.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * @struct FrameSnapshot
+ * @brief A completed frame handed from the emulation thread to the renderer.
+ */
+struct FrameSnapshot {
+    Framebuffer framebuffer;
+    bool behind = false;    // Emulation had missed its frame deadline
+};
 
 
 /**
  * @class Emulator
  * @brief Main application class for the CHIP-8 emulator.
  *
- * Coordinates the CHIP-8 core, renderer, and event logging. Handles setup,
- * main emulation loop, and SDL event processing.
+ * Coordinates the CHIP-8 core, scheduler, frame pacer, renderer, and event logging.
+ * The core runs on its own emulation thread; the main thread handles SDL
+ * events and rendering. Completed frames travel through a lock-free triple
+ * buffer and key state travels back as an atomic bitmask, so neither thread
+ * ever waits for the other and the Chip8 instance is only touched by the
+ * emulation thread.
  */
 class Emulator {
 
@@ -19,8 +44,38 @@ public:
     void run();
     void setup(int argc, char* argv[]);
 private:
+    void handleEvent(const SDL_Event& event);
+    void emulationLoop();
+    void applyInput(uint16_t keys);
+    void stop();
+    void printStats() const;
+
+    // Emulation thread
     Chip8 chip8;
+    Scheduler scheduler;
+    RewindBuffer rewind;
+    Chip8State snapshot;
+    bool rewindEnabled = true;
+    InputMovie movie;
+    std::string moviePath;            // Empty unless recording
+    uint64_t timelineFrame = 0;       // Index of the next frame, rewinds included
+    std::string profilePath;          // Empty unless profiling
+
+    // Shared between the threads: the core reports from the emulation
+    // thread, render times come from the main thread
+    std::unique_ptr<Profiler> profiler;
+
+    // Main thread
     Chip8Renderer renderer;
-    bool running = true;
+    FramePacer pacer;
     SDL_Event event;
+    uint32_t frameReadyEvent = 0;     // SDL user event that wakes the main thread
+
+    // Shared between the threads
+    std::atomic<bool> running{true};
+    std::atomic<uint16_t> keyState{0};  // Bit i set while CHIP-8 key i is held
+    std::atomic<bool> rewindHeld{false}; // Rewind key is held
+    TripleBuffer<FrameSnapshot> frames;
+    std::mutex inputMutex;              // Guards waits on inputChanged
+    std::condition_variable inputChanged;
 };
\ No newline at end of file
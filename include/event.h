@@ -1,26 +1,44 @@
 #pragma once
-#include <iostream>
+#include <array>
+#include <cstdint>
 #include <string>
-#include <vector>
-#include <map>
+#include <type_traits>
 #include <variant>
-#include <sstream>
-#include <chrono>
 
+/**
+ * @brief Discriminator carried by every event record.
+ */
+enum class EventType : uint8_t {
+    Stack,
+    Opcode,
+    Register,
+    Memory,
+    Input,
+    Timer,
+    Draw,
+    FramebufferCleared
+};
+
+/**
+ * @brief Returns the name used for an event type in logs.
+ */
+const char* eventTypeName(EventType type);
 
 /**
  * @struct Event
  * @brief Base event type for CHIP-8 event logging.
  *
- * Contains event type and timestamp. All specific event types inherit from this.
+ * Contains the event type and the CPU cycle at which it happened. Cycles
+ * order events exactly and cost nothing to read, unlike a wall-clock
+ * timestamp. Every event is a fixed-size, trivially copyable record, so
+ * logging one is a plain copy into the logger's ring buffer with no heap
+ * allocation.
  */
 struct Event {
-    std::string type;
-    std::chrono::time_point<std::chrono::steady_clock> timestamp;
+    EventType type;
+    uint64_t cycle;
 
-    Event(const std::string& t)
-        : type(t), timestamp(std::chrono::steady_clock::now()) {}
-    virtual ~Event() = default;
+    Event(EventType t, uint64_t cycle_) : type(t), cycle(cycle_) {}
 };
 
 
@@ -28,15 +46,17 @@ struct Event {
  * @struct StackEvent
  * @brief Event representing changes to the CHIP-8 stack (CALL/RET).
  *
- * Contains program counter, target address, and full stack snapshot.
+ * Contains program counter, target address, and a snapshot of the stack.
  */
 struct StackEvent : Event {
     uint16_t pc;
     uint16_t target;
-    std::vector<uint16_t> stack;
+    uint8_t depth;                      // Stack pointer after the call or return
+    std::array<uint16_t, 16> stack;
 
-    StackEvent(uint16_t pc_, uint16_t target_, std::vector<uint16_t> stack_)
-        : Event("StackEvent"), pc(pc_), target(target_), stack(std::move(stack_)) {}
+    StackEvent(uint64_t cycle_, uint16_t pc_, uint16_t target_, uint8_t depth_,
+               const std::array<uint16_t, 16>& stack_)
+        : Event(EventType::Stack, cycle_), pc(pc_), target(target_), depth(depth_), stack(stack_) {}
 };
 
 /**
@@ -49,34 +69,52 @@ struct OpcodeEvent : Event {
     uint16_t pc;
     uint16_t opcode;
 
-    OpcodeEvent(uint16_t pc_, uint16_t opcode_)
-        : Event("OpcodeEvent"), pc(pc_), opcode(opcode_) {}
+    OpcodeEvent(uint64_t cycle_, uint16_t pc_, uint16_t opcode_)
+        : Event(EventType::Opcode, cycle_), pc(pc_), opcode(opcode_) {}
 };
 
 /**
  * @struct RegisterEvent
  * @brief Event representing changes to CHIP-8 general purpose registers (V0-VF).
  *
- * Contains a map of register indices to their new values.
+ * Bit i of mask is set when Vi changed; its new value is values[i].
  */
 struct RegisterEvent : Event {
-    std::map<int, int> changes;
-
-    RegisterEvent(std::map<int, int> changes_)
-        : Event("RegisterEvent"), changes(std::move(changes_)) {}
+    uint16_t mask = 0;
+    std::array<uint8_t, 16> values{};
+
+    explicit RegisterEvent(uint64_t cycle_) : Event(EventType::Register, cycle_) {}
+
+    /**
+     * @brief Records the new value of register reg.
+     */
+    RegisterEvent& set(int reg, uint8_t value) {
+        mask |= static_cast<uint16_t>(1u << reg);
+        values[reg] = value;
+        return *this;
+    }
 };
 
 /**
  * @struct MemoryEvent
- * @brief Event representing changes to CHIP-8 memory regions.
+ * @brief Event representing a write to a contiguous range of CHIP-8 memory.
  *
- * Contains a map of memory addresses to their new values.
+ * Holds up to 16 bytes, enough for the largest single write (FX55 with VF).
  */
 struct MemoryEvent : Event {
-    std::map<uint16_t, int> memoryDiff;
-
-    MemoryEvent(std::map<uint16_t, int> diff_)
-        : Event("MemoryEvent"), memoryDiff(std::move(diff_)) {}
+    static constexpr uint8_t MAX_LENGTH = 16;
+
+    uint16_t address;
+    uint8_t length;
+    std::array<uint8_t, MAX_LENGTH> values{};
+
+    MemoryEvent(uint64_t cycle_, uint16_t address_, const uint8_t* data, uint8_t length_)
+        : Event(EventType::Memory, cycle_), address(address_),
+          length(length_ < MAX_LENGTH ? length_ : MAX_LENGTH) {
+        for (uint8_t i = 0; i < length; ++i) {
+            values[i] = data[i];
+        }
+    }
 };
 
 /**
@@ -86,14 +124,63 @@ struct MemoryEvent : Event {
  * Contains key index and pressed state.
  */
 struct InputEvent : Event {
-    int key;
+    uint8_t key;
     bool pressed;
 
-    InputEvent(int key_, bool pressed_)
-        : Event("InputEvent"), key(key_), pressed(pressed_) {}
+    InputEvent(uint64_t cycle_, uint8_t key_, bool pressed_)
+        : Event(EventType::Input, cycle_), key(key_), pressed(pressed_) {}
 };
 
+/**
+ * @struct TimerEvent
+ * @brief Event representing a write to the delay (FX15) or sound (FX18) timer.
+ */
+struct TimerEvent : Event {
+    bool sound;         // False for the delay timer
+    uint8_t value;
+
+    TimerEvent(uint64_t cycle_, bool sound_, uint8_t value_)
+        : Event(EventType::Timer, cycle_), sound(sound_), value(value_) {}
+};
+
+/**
+ * @struct DrawEvent
+ * @brief Event representing a sprite drawn by DXYN.
+ *
+ * Records the sprite rows rather than the touched pixels, so the framebuffer
+ * can be replayed from a stream of DrawEvent and FramebufferClearedEvent.
+ */
+struct DrawEvent : Event {
+    uint8_t x;
+    uint8_t y;
+    uint8_t height;
+    bool collision;
+    uint16_t address;                   // I at the time of the draw
+    std::array<uint8_t, 15> sprite{};
+
+    DrawEvent(uint64_t cycle_, uint8_t x_, uint8_t y_, uint16_t address_, const uint8_t* rows,
+              uint8_t height_, bool collision_)
+        : Event(EventType::Draw, cycle_), x(x_), y(y_), height(height_ < 15 ? height_ : 15),
+          collision(collision_), address(address_) {
+        for (uint8_t i = 0; i < height; ++i) {
+            sprite[i] = rows[i];
+        }
+    }
+};
+
+/**
+ * @struct FramebufferClearedEvent
+ * @brief Event representing 00E0; replaces a per-pixel diff of the whole screen.
+ */
+struct FramebufferClearedEvent : Event {
+    explicit FramebufferClearedEvent(uint64_t cycle_) : Event(EventType::FramebufferCleared, cycle_) {}
+};
+
+
+using EventVariant = std::variant<StackEvent, OpcodeEvent, RegisterEvent, MemoryEvent, InputEvent,
+                                  TimerEvent, DrawEvent, FramebufferClearedEvent>;
 
-using EventVariant = std::variant<StackEvent, OpcodeEvent, RegisterEvent, MemoryEvent, InputEvent>;
+static_assert(std::is_trivially_copyable<EventVariant>::value,
+              "Event records must stay trivially copyable so logging never allocates");
 
-std::string serializeEvent(const EventVariant& ev);
\ No newline at end of file
+std::string serializeEvent(const EventVariant& ev);
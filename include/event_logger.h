@@ -1,91 +1,168 @@
 #pragma once
-#include <fstream>
 #include <string>
 #include <thread>
 #include <atomic>
 #include <chrono>
+#include <ctime>
 #include <filesystem>
-#include "message_queue.h"
+#include "spsc_queue.h"
+#include "trace_writer.h"
 #include "event.h"
 
 const bool ENABLE_EVENT_LOGGING = true;
 
+/**
+ * @brief Queue and writer counters reported by EventLogger::getStats().
+ */
+struct LoggerStats {
+    uint64_t written = 0;         // Events encoded into the trace
+    uint64_t dropped = 0;         // Events discarded because the queue was full (Drop policy)
+    uint64_t producerStalls = 0;  // Times log() waited for room (Block policy)
+    size_t depth = 0;             // Events currently queued
+    size_t highWaterMark = 0;     // Largest depth seen by the writer thread
+    size_t capacity = 0;          // Queue capacity
+};
+
 /**
  * @class EventLogger
  * @brief Singleton event logging system for CHIP-8 emulator.
  *
- * Collects, batches, and serializes events from the emulator using a thread-safe
- * message queue. Periodically writes events to a log file in JSON format.
+ * Collects and serializes events from the emulator using a lock-free
+ * single-producer ring buffer, so log() never takes a lock; only the emulation
+ * thread may call it. The writer thread drains everything queued each time it
+ * wakes and sleeps on the queue while it is empty, so its throughput follows
+ * the event rate. The queue is bounded: with OverflowPolicy::Block (the
+ * default) a full queue stalls log() until the writer catches up, so the trace
+ * is complete; with OverflowPolicy::Drop new events are discarded and counted
+ * instead. Events are written to a compact binary trace (.c8t, see
+ * trace_format.h); chip8-trace converts it to JSON lines. On destruction
+ * everything still queued is written before the trace is closed.
+ * The core never reaches for the singleton itself: a Chip8 instance only logs
+ * when a logger has been attached with Chip8::setEventLogger().
  */
 class EventLogger {
 public:
+    static constexpr size_t DEFAULT_CAPACITY = 1 << 16;
+
     EventLogger(const EventLogger&) = delete;
     EventLogger& operator=(const EventLogger&) = delete;
 
     /**
-     * @brief Creates the singleton EventLogger instance and its internal MessageQueue.
+     * @brief Creates the singleton EventLogger instance and its ring buffer.
+     *
+     * Only the first call creates the logger; later calls return it unchanged.
      *
      * @param logDir Directory for log files.
-     * @param intervalMs Logging interval in milliseconds.
-     * @param batchSize Number of events to log per interval.
+     * @param policy What log() does when the ring buffer is full.
+     * @param capacity Ring buffer capacity in events.
+     * @param flushIntervalMs How long the writer may sit idle before pushing a partial block to disk.
      * @return Reference to the singleton EventLogger.
      */
     static EventLogger& createInstance(const std::string& logDir = "./logs",
-                                      int intervalMs = 100,
-                                      size_t batchSize = 10)
+                                      OverflowPolicy policy = OverflowPolicy::Block,
+                                      size_t capacity = DEFAULT_CAPACITY,
+                                      int flushIntervalMs = 1000)
     {
-        static EventLogger instance(logDir, intervalMs, batchSize);
+        static EventLogger instance(logDir, policy, capacity, flushIntervalMs);
         return instance;
     }
 
     /**
-     * @brief Pushes an event to the logger's internal message queue.
+     * @brief Pushes an event to the logger's internal ring buffer.
      * @param event The event to log.
      */
-    static void pushLog(const EventVariant& event) {
-        EventLogger& logger = createInstance();
-        logger.queue_.push(event);
+    void log(const EventVariant& event) {
+        queue_.push(event);
+    }
+
+    /**
+     * @brief Number of events discarded because the ring buffer was full.
+     */
+    uint64_t droppedEvents() const { return queue_.dropped(); }
+
+    /**
+     * @brief Number of events currently waiting to be written.
+     */
+    size_t queueDepth() const { return queue_.size(); }
+
+    /**
+     * @brief Largest queue depth observed by the writer thread.
+     */
+    size_t highWaterMark() const { return highWaterMark_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Snapshot of the queue and writer counters.
+     */
+    LoggerStats getStats() const {
+        LoggerStats stats;
+        stats.written = written_.load(std::memory_order_relaxed);
+        stats.dropped = queue_.dropped();
+        stats.producerStalls = queue_.producerStalls();
+        stats.depth = queue_.size();
+        stats.highWaterMark = highWaterMark();
+        stats.capacity = queue_.capacity();
+        return stats;
     }
 
     ~EventLogger() {
         running_ = false;
         if (worker_.joinable()) worker_.join();
-        logFile_.close();
+        trace_.close();
     }
 
 private:
-    EventLogger(const std::string& logDir, int intervalMs, size_t batchSize)
-        : intervalMs_(intervalMs), batchSize_(batchSize), running_(true)
+    EventLogger(const std::string& logDir, OverflowPolicy policy, size_t capacity, int flushIntervalMs)
+        : queue_(capacity, policy), running_(true), flushIntervalMs_(flushIntervalMs)
     {
         std::filesystem::create_directories(logDir);
-        std::string newLogFile = logDir + "/event_log_" + std::to_string(std::time(nullptr)) + ".txt";
-        logFile_.open(newLogFile, std::ios::out | std::ios::trunc);
+        std::string newLogFile = logDir + "/event_log_" + std::to_string(std::time(nullptr)) + ".c8t";
+        trace_.open(newLogFile);
         worker_ = std::thread(&EventLogger::run, this);
     }
 
+    /**
+     * @brief Writes every queued event; returns how many were written.
+     */
+    size_t drain() {
+        size_t depth = queue_.size();
+        if (depth > highWaterMark_.load(std::memory_order_relaxed)) {
+            highWaterMark_.store(depth, std::memory_order_relaxed);
+        }
+        size_t count = queue_.consume([this](EventVariant&& ev) {
+            if (ENABLE_EVENT_LOGGING) trace_.write(ev);
+        }, depth);
+        written_.fetch_add(count, std::memory_order_relaxed);
+        return count;
+    }
+
     void run() {
-        while (running_ && ENABLE_EVENT_LOGGING) {
-            std::vector<EventVariant> events;
-            for (size_t i = 0; i < batchSize_; ++i) {
-                EventVariant event = StackEvent(0, 0, {});
-                if (queue_.try_pop(event)) {
-                    events.push_back(event);
-                } else {
-                    break;
-                }
+        using Clock = std::chrono::steady_clock;
+        Clock::time_point lastWrite = Clock::now();
+        bool unflushed = false;
+        while (running_) {
+            if (drain() > 0) {
+                lastWrite = Clock::now();
+                unflushed = true;
+            } else if (!queue_.waitForData(WAIT_SLICE) && unflushed &&
+                       Clock::now() - lastWrite >= std::chrono::milliseconds(flushIntervalMs_)) {
+                // Idle for a whole interval: make what we have visible on disk.
+                trace_.flush();
+                unflushed = false;
             }
-            for (const auto& ev : events) {
-                logFile_ << serializeEvent(ev) << std::endl;
-            }
-            logFile_.flush();
-            std::this_thread::sleep_for(std::chrono::milliseconds(intervalMs_));
+        }
+        // The producer has stopped; write whatever it left behind.
+        while (drain() > 0) {
         }
     }
 
-    MessageQueue<EventVariant> queue_;
-    std::ofstream logFile_;
+    // Longest idle sleep; bounds how long shutdown waits for the writer thread.
+    static constexpr std::chrono::milliseconds WAIT_SLICE{50};
+
+    SpscQueue<EventVariant> queue_;
+    TraceWriter trace_;
     std::thread worker_;
     std::atomic<bool> running_;
-    int intervalMs_;
-    size_t batchSize_;
-};
\ No newline at end of file
+    int flushIntervalMs_;
+    std::atomic<uint64_t> written_{0};
+    std::atomic<size_t> highWaterMark_{0};
+};
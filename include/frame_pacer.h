@@ -0,0 +1,83 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @struct PresentStats
+ * @brief Frame pacing statistics collected by FramePacer.
+ */
+struct PresentStats {
+    uint64_t presented = 0;         // Frames handed to the display
+    uint64_t deferred = 0;          // Frames with a pending change held back by the present cap
+    uint64_t skipped = 0;           // Frames with a pending change dropped while emulation was behind
+    uint64_t missedDeadlines = 0;   // Presents started over half a 60Hz frame after they were due
+    double minIntervalMs = 0.0;     // Shortest time between two presents
+    double maxIntervalMs = 0.0;     // Longest time between two presents
+    double avgIntervalMs = 0.0;     // Mean time between two presents
+    double avgPresentMs = 0.0;      // Mean time spent inside render + present
+};
+
+/**
+ * @class FramePacer
+ * @brief Decides when a frame is presented, independently of emulation.
+ *
+ * Emulation produces at most one frame per 60Hz timer period, but a frame is
+ * only worth presenting when the display changed, no more often than the
+ * configured cap, and not while emulation is running late. Changes that are
+ * held back are not lost: the framebuffer keeps accumulating dirty rows
+ * until the next present. With vsync enabled in the renderer the cap can be
+ * left at 0, as the present call itself then waits for the display refresh.
+ */
+class FramePacer {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr double DEFAULT_MAX_PRESENT_HZ = 60.0;
+    static constexpr int DEFAULT_MAX_FRAME_SKIP = 0;
+
+    explicit FramePacer(double maxPresentHz = DEFAULT_MAX_PRESENT_HZ);
+
+    /**
+     * @brief Caps the present rate.
+     * @param hz Maximum presents per second, or 0 for no cap.
+     */
+    void setMaxPresentHz(double hz);
+
+    /**
+     * @brief Allows up to frames consecutive changed frames to be dropped
+     *        while emulation is behind schedule. 0 disables frame skipping.
+     */
+    void setMaxFrameSkip(int frames) { maxFrameSkip = frames > 0 ? frames : 0; }
+
+    /**
+     * @brief Called once per emulated frame; returns true if the caller
+     *        should render and present now.
+     * @param changed True if the display changed during the frame.
+     * @param behind True if emulation missed its frame deadline.
+     */
+    bool shouldPresent(bool changed, bool behind);
+
+    /**
+     * @brief Records that the present approved by shouldPresent() finished.
+     */
+    void presented();
+
+    /**
+     * @brief Returns true if a display change is still waiting to be presented.
+     */
+    bool hasPending() const { return pending; }
+
+    const PresentStats& getStats() const { return stats; }
+
+private:
+    Clock::duration interval;       // Minimum time between presents; zero if uncapped
+    int maxFrameSkip;
+    int consecutiveSkips;
+    bool pending;                   // A change is waiting to be presented
+    Clock::time_point pendingSince; // When the oldest unpresented change arrived
+    Clock::time_point presentStart;
+    Clock::time_point lastPresent;  // Start of the previous present
+    double intervalSumMs;
+    double presentSumMs;
+    PresentStats stats;
+};
@@ -0,0 +1,145 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class Framebuffer
+ * @brief The 64x32 monochrome CHIP-8 display, packed one bit per pixel.
+ *
+ * Each row is a single uint64_t with bit 63 holding x = 0, so a sprite row
+ * is drawn with one shift and one XOR, collision detection is a single AND,
+ * and clearing the screen touches 256 bytes. Renderers that want one byte
+ * per pixel use toBytes().
+ *
+ * Rows changed since the last takeDirtyRows() are tracked in a 32-bit mask,
+ * so a renderer only needs to convert and upload those.
+ */
+class Framebuffer {
+public:
+    static constexpr int WIDTH = 64;
+    static constexpr int HEIGHT = 32;
+    static constexpr size_t PIXEL_COUNT = WIDTH * HEIGHT;
+
+    Framebuffer() : dirtyRows(ALL_ROWS) { rows.fill(0); }
+
+    /**
+     * @brief Turns every pixel off.
+     */
+    void clear() {
+        for (int y = 0; y < HEIGHT; ++y) {
+            dirtyRows |= static_cast<uint32_t>(rows[y] != 0) << y;
+        }
+        rows.fill(0);
+    }
+
+    /**
+     * @brief XORs one 8-pixel sprite row onto the display.
+     *
+     * Pixels are addressed linearly as x + y * 64 modulo 2048, matching the
+     * original byte-per-pixel implementation: a sprite row that crosses the
+     * right edge continues at the start of the next row, and the last row
+     * wraps to the first.
+     *
+     * @param x Column of the leftmost sprite pixel (any value; wrapped).
+     * @param y Row of the sprite row (any value; wrapped).
+     * @param bits Sprite row, most significant bit leftmost.
+     * @return true if any pixel that was on is turned off.
+     */
+    bool drawSpriteRow(unsigned x, unsigned y, uint8_t bits) {
+        unsigned linear = x + y * WIDTH;
+        unsigned row = (linear / WIDTH) % HEIGHT;
+        unsigned col = linear % WIDTH;
+        uint64_t mask = (static_cast<uint64_t>(bits) << 56) >> col;
+        bool collision = (rows[row] & mask) != 0;
+        rows[row] ^= mask;
+        dirtyRows |= static_cast<uint32_t>(mask != 0) << row;
+        if (col > WIDTH - 8) {
+            unsigned next = (row + 1) % HEIGHT;
+            uint64_t spill = static_cast<uint64_t>(bits) << (WIDTH + 56 - col);
+            collision |= (rows[next] & spill) != 0;
+            rows[next] ^= spill;
+            dirtyRows |= static_cast<uint32_t>(spill != 0) << next;
+        }
+        return collision;
+    }
+
+    /**
+     * @brief Returns whether the pixel at (x, y) is on.
+     */
+    bool getPixel(unsigned x, unsigned y) const {
+        return (rows[y % HEIGHT] >> (WIDTH - 1 - x % WIDTH)) & 1;
+    }
+
+    /**
+     * @brief Returns the packed row y, bit 63 being x = 0.
+     */
+    uint64_t getRow(unsigned y) const { return rows[y % HEIGHT]; }
+
+    /**
+     * @brief Returns all HEIGHT packed rows, top row first.
+     */
+    const uint64_t* data() const { return rows.data(); }
+
+    /**
+     * @brief Returns the rows changed since the last call (bit y = row y) and
+     *        clears the mask. Every row starts out dirty.
+     */
+    uint32_t takeDirtyRows() {
+        uint32_t dirty = dirtyRows;
+        dirtyRows = 0;
+        return dirty;
+    }
+
+    /**
+     * @brief Returns a mask of the rows that differ from other (bit y = row y).
+     */
+    uint32_t diffRows(const Framebuffer& other) const {
+        uint32_t diff = 0;
+        for (int y = 0; y < HEIGHT; ++y) {
+            diff |= static_cast<uint32_t>(rows[y] != other.rows[y]) << y;
+        }
+        return diff;
+    }
+
+    /**
+     * @brief Marks every row dirty, e.g. after the render target was lost.
+     */
+    void markAllDirty() { dirtyRows = ALL_ROWS; }
+
+    /**
+     * @brief Replaces the display with HEIGHT packed rows, marking changed rows dirty.
+     * @param src Rows in the layout of data().
+     */
+    void setRows(const uint64_t* src) {
+        for (int y = 0; y < HEIGHT; ++y) {
+            dirtyRows |= static_cast<uint32_t>(rows[y] != src[y]) << y;
+            rows[y] = src[y];
+        }
+    }
+
+    /**
+     * @brief Expands the display to one byte (0 or 1) per pixel, row-major.
+     * @param out Destination of PIXEL_COUNT bytes.
+     */
+    void toBytes(uint8_t* out) const;
+
+    /**
+     * @brief Returns a byte-per-pixel copy of the display.
+     */
+    std::array<uint8_t, PIXEL_COUNT> toBytes() const;
+
+    /**
+     * @brief FNV-1a hash of the packed rows.
+     */
+    uint64_t hash() const;
+
+    bool operator==(const Framebuffer& other) const { return rows == other.rows; }
+    bool operator!=(const Framebuffer& other) const { return rows != other.rows; }
+
+private:
+    static constexpr uint32_t ALL_ROWS = 0xFFFFFFFFu;
+
+    std::array<uint64_t, HEIGHT> rows;
+    uint32_t dirtyRows;
+};
@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Computes the 64-bit FNV-1a hash of a byte range.
+ *
+ * Used to fingerprint framebuffers and ROM images. Not cryptographic.
+ *
+ * @param data Pointer to the bytes to hash.
+ * @param size Number of bytes.
+ * @param seed Initial hash value; pass a previous result to chain ranges.
+ * @return uint64_t The hash value.
+ */
+inline uint64_t fnv1a64(const void* data, size_t size, uint64_t seed = 0xcbf29ce484222325ULL) {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    uint64_t hash = seed;
+    for (size_t i = 0; i < size; ++i) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief Mixes a 64-bit value into a well-distributed 64-bit hash.
+ *
+ * The splitmix64 finalizer: a bijection, so distinct inputs never collide,
+ * and cheap enough to key Zobrist-style hashes on the fly instead of
+ * storing tables of random keys.
+ *
+ * @param value Value to mix.
+ * @return uint64_t The mixed value.
+ */
+inline uint64_t mix64(uint64_t value) {
+    value = (value ^ (value >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    value = (value ^ (value >> 27)) * 0x94d049bb133111ebULL;
+    return value ^ (value >> 31);
+}
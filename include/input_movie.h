@@ -0,0 +1,120 @@
+#pragma once
+#include "chip8.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @struct MovieRecord
+ * @brief One entry of an input movie, tied to a frame and the cycle counter.
+ */
+struct MovieRecord {
+    enum Type : uint8_t {
+        Input = 0,        // Key bitmask applied at the start of the frame
+        Checkpoint = 1,   // Framebuffer hash at the end of the frame
+        End = 2           // Last frame of the recording, with its hash
+    };
+
+    Type type;
+    uint64_t frame;      // Frame index from the start of the recording
+    uint64_t cycle;      // Chip8 cycle count when the record was taken
+    uint16_t keys;       // Input: bit i set while key i is held
+    uint64_t hash;       // Checkpoint, End: Framebuffer::hash()
+};
+
+/**
+ * @class InputMovie
+ * @brief Recording of the key state changes of one run, for bit-exact replay.
+ *
+ * A run is reproducible from the ROM, the CXNN seed, the CPU speed and the
+ * key bitmask applied at the start of every frame: the Scheduler derives
+ * each frame's instruction budget from the CPU speed alone, and the core is
+ * otherwise deterministic. The movie therefore stores only key changes, each
+ * tagged with its frame and the cycle count it was applied at, plus periodic
+ * framebuffer hashes so a replay can detect the first frame it diverges.
+ *
+ * File layout (little-endian):
+ *   header   "C8MV", u16 version, u16 header size, u32 seed,
+ *            u32 cycles per second, u32 ROM size, u32 reserved, u64 ROM hash
+ *   records  u8 type, varint frame delta, varint cycle delta, then
+ *            u16 keys (Input) or u64 hash (Checkpoint, End)
+ */
+class InputMovie {
+public:
+    static constexpr uint16_t VERSION = 1;
+    static constexpr uint64_t CHECKPOINT_INTERVAL = 60;   // Frames between hash checkpoints
+
+    /**
+     * @brief Starts a new recording, discarding any records.
+     * @param rom ROM image being run.
+     * @param romSize Size of the ROM image.
+     * @param seed Seed passed to Chip8::seedRandom().
+     * @param cyclesPerSecond Fixed CPU speed of the Scheduler; must not be UNLIMITED.
+     */
+    void begin(const uint8_t* rom, size_t romSize, uint32_t seed, int cyclesPerSecond);
+
+    /**
+     * @brief Records the key bitmask applied at the start of a frame.
+     */
+    void recordInput(uint64_t frame, uint64_t cycle, uint16_t keys);
+
+    /**
+     * @brief Records the end of a frame, adding a checkpoint every CHECKPOINT_INTERVAL frames.
+     */
+    void recordFrameEnd(uint64_t frame, uint64_t cycle, uint64_t framebufferHash);
+
+    /**
+     * @brief Drops every record from frame on, e.g. after rewinding to it.
+     */
+    void truncate(uint64_t frame);
+
+    /**
+     * @brief Marks the last recorded frame; replays run up to and including it.
+     */
+    void finish(uint64_t frame, uint64_t cycle, uint64_t framebufferHash);
+
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+    /**
+     * @brief Checks that a ROM image is the one the movie was recorded with.
+     */
+    bool matchesRom(const uint8_t* rom, size_t romSize) const;
+
+    uint32_t getSeed() const { return seed; }
+    int getCyclesPerSecond() const { return cyclesPerSecond; }
+    const std::vector<MovieRecord>& getRecords() const { return records; }
+
+private:
+    uint32_t seed = 0;
+    int cyclesPerSecond = 0;
+    uint32_t romSize = 0;
+    uint64_t romHash = 0;
+    std::vector<MovieRecord> records;
+};
+
+/**
+ * @struct ReplayResult
+ * @brief Outcome of replaying an input movie.
+ */
+struct ReplayResult {
+    bool matched = false;          // Every checkpoint and input cycle matched
+    uint64_t frames = 0;           // Frames replayed
+    uint64_t instructions = 0;     // Instructions executed
+    uint64_t checkpoints = 0;      // Checkpoints that matched
+    uint64_t mismatchFrame = 0;    // First diverging frame, if !matched
+    std::string mismatch;          // What diverged, if !matched
+    uint64_t framebufferHash = 0;  // Hash of the final framebuffer
+    double wallMs = 0.0;
+};
+
+/**
+ * @brief Replays a movie headless, as fast as possible, checking every checkpoint.
+ *
+ * @param movie The recording.
+ * @param rom ROM image; must match the one recorded.
+ * @param mode Execution mode to replay in; results must not depend on it.
+ * @return ReplayResult Replay outcome; stops at the first mismatch.
+ */
+ReplayResult replayMovie(const InputMovie& movie, const std::vector<uint8_t>& rom, ExecutionMode mode);
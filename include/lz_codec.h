@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Compresses a buffer with a small LZ4-style byte-oriented codec.
+ *
+ * The output is a sequence of (literal run, back-reference) pairs, each led
+ * by a token byte whose high nibble is the literal length and whose low
+ * nibble is the match length minus 4; lengths of 15 or more continue in
+ * extra bytes. Back-references carry a 16-bit little-endian offset. There is
+ * no framing: callers store the uncompressed size alongside the output.
+ *
+ * @param input Data to compress.
+ * @param size Number of bytes in input.
+ * @param output Receives the compressed bytes (appended).
+ */
+void lzCompress(const uint8_t* input, size_t size, std::vector<uint8_t>& output);
+
+/**
+ * @brief Decompresses data produced by lzCompress().
+ *
+ * @param input Compressed data.
+ * @param size Number of compressed bytes.
+ * @param output Destination; must have room for expectedSize bytes.
+ * @param expectedSize Exact uncompressed size.
+ * @return false if the input is malformed or does not expand to expectedSize bytes.
+ */
+bool lzDecompress(const uint8_t* input, size_t size, uint8_t* output, size_t expectedSize);
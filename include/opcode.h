@@ -2,32 +2,93 @@
 #include "chip8.h"
 #include <cstdint>
 
+struct Instruction;
+
+/**
+ * @brief Signature of a decoded instruction handler.
+ */
+using OpHandler = void (*)(Chip8& chip8, const Instruction& inst);
+
+/**
+ * @struct Instruction
+ * @brief A decoded CHIP-8 instruction.
+ *
+ * Holds a direct pointer to the handler for the exact instruction (not just
+ * its family) together with every operand field pre-extracted, so executing
+ * it needs no further masking or switching.
+ */
+struct Instruction {
+    OpHandler handler;
+    uint16_t opcode;
+    uint16_t nnn;   // Lowest 12 bits
+    uint8_t x;      // Bits 8-11
+    uint8_t y;      // Bits 4-7
+    uint8_t n;      // Lowest 4 bits
+    uint8_t nn;     // Lowest 8 bits
+};
+
 /**
  * @class OpcodeHandler
  * @brief Static class for handling CHIP-8 opcodes.
  *
  * Provides static methods to decode and execute CHIP-8 opcodes.
- * Each method corresponds to a specific opcode or group of opcodes.
+ * Each op_ method implements exactly one instruction; decode() selects it.
+ *
+ * The class is instantiated once per TraceLevel (see OpcodeHandler.cpp).
+ * Event construction is guarded by if constexpr on the level, so the
+ * TraceLevel::None handlers contain no logging code at all, and decode()
+ * only ever returns handlers of its own level.
+ *
+ * @tparam L What the handlers report to the attached EventLogger.
  */
+template <TraceLevel L>
 class OpcodeHandler {
 public:
-    static void handle_0x0(Chip8& chip8, uint16_t opcode);
-    static void handle_0x1(Chip8& chip8, uint16_t opcode);
-    static void handle_0x2(Chip8& chip8, uint16_t opcode);
-    static void handle_0x3(Chip8& chip8, uint16_t opcode);
-    static void handle_0x4(Chip8& chip8, uint16_t opcode);
-    static void handle_0x5(Chip8& chip8, uint16_t opcode);
-    static void handle_0x6(Chip8& chip8, uint16_t opcode);
-    static void handle_0x7(Chip8& chip8, uint16_t opcode);
-    static void handle_0x8(Chip8& chip8, uint16_t opcode);
-    static void handle_0x9(Chip8& chip8, uint16_t opcode);
-    static void handle_0xA(Chip8& chip8, uint16_t opcode);
-    static void handle_0xB(Chip8& chip8, uint16_t opcode);
-    static void handle_0xC(Chip8& chip8, uint16_t opcode);
-    static void handle_0xD(Chip8& chip8, uint16_t opcode);
-    static void handle_0xE(Chip8& chip8, uint16_t opcode);
-    static void handle_0xF(Chip8& chip8, uint16_t opcode);
+    static Instruction decode(uint16_t opcode);
     static void dispatchOpcode(Chip8& chip8, uint16_t opcode);
-};
 
+    static void op_00E0(Chip8& chip8, const Instruction& inst);
+    static void op_00EE(Chip8& chip8, const Instruction& inst);
+    static void op_1NNN(Chip8& chip8, const Instruction& inst);
+    static void op_2NNN(Chip8& chip8, const Instruction& inst);
+    static void op_3XNN(Chip8& chip8, const Instruction& inst);
+    static void op_4XNN(Chip8& chip8, const Instruction& inst);
+    static void op_5XY0(Chip8& chip8, const Instruction& inst);
+    static void op_6XNN(Chip8& chip8, const Instruction& inst);
+    static void op_7XNN(Chip8& chip8, const Instruction& inst);
+    static void op_8XY0(Chip8& chip8, const Instruction& inst);
+    static void op_8XY1(Chip8& chip8, const Instruction& inst);
+    static void op_8XY2(Chip8& chip8, const Instruction& inst);
+    static void op_8XY3(Chip8& chip8, const Instruction& inst);
+    static void op_8XY4(Chip8& chip8, const Instruction& inst);
+    static void op_8XY5(Chip8& chip8, const Instruction& inst);
+    static void op_8XY6(Chip8& chip8, const Instruction& inst);
+    static void op_8XY7(Chip8& chip8, const Instruction& inst);
+    static void op_8XYE(Chip8& chip8, const Instruction& inst);
+    static void op_9XY0(Chip8& chip8, const Instruction& inst);
+    static void op_ANNN(Chip8& chip8, const Instruction& inst);
+    static void op_BNNN(Chip8& chip8, const Instruction& inst);
+    static void op_CXNN(Chip8& chip8, const Instruction& inst);
+    static void op_DXYN(Chip8& chip8, const Instruction& inst);
+    static void op_EX9E(Chip8& chip8, const Instruction& inst);
+    static void op_EXA1(Chip8& chip8, const Instruction& inst);
+    static void op_FX07(Chip8& chip8, const Instruction& inst);
+    static void op_FX0A(Chip8& chip8, const Instruction& inst);
+    static void op_FX15(Chip8& chip8, const Instruction& inst);
+    static void op_FX18(Chip8& chip8, const Instruction& inst);
+    static void op_FX1E(Chip8& chip8, const Instruction& inst);
+    static void op_FX29(Chip8& chip8, const Instruction& inst);
+    static void op_FX33(Chip8& chip8, const Instruction& inst);
+    static void op_FX55(Chip8& chip8, const Instruction& inst);
+    static void op_FX65(Chip8& chip8, const Instruction& inst);
+    static void op_unknown(Chip8& chip8, const Instruction& inst);
+
+    // Superinstructions: only valid inside BlockCache code, where the second
+    // half of the pair is stored in the slot directly after inst.
+    static void op_6XNN_7XNN(Chip8& chip8, const Instruction& inst);
+    static void op_ANNN_DXYN(Chip8& chip8, const Instruction& inst);
+    static void op_3XNN_1NNN(Chip8& chip8, const Instruction& inst);
 
+private:
+    static void detectIdleLoop(Chip8& chip8, uint16_t jumpAddress, uint16_t target);
+};
@@ -0,0 +1,131 @@
+#pragma once
+#include "hash.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @class PagedMemory
+ * @brief The 4 KiB CHIP-8 address space as copy-on-write, reference-counted pages.
+ *
+ * Memory is split into 16 pages of 256 bytes. Copying a PagedMemory shares
+ * every page and only bumps reference counts; the first store to a shared
+ * page gives the writer its own copy. A program typically writes a few
+ * bytes per frame, so a copy that runs for a frame ends up owning one or
+ * two pages and sharing the rest. Pages that are all zero share one static
+ * page, so a fresh machine only allocates the pages holding the font and
+ * the program.
+ *
+ * Pages come from a process-wide pool of fixed-size blocks, so
+ * copy-on-write costs a pooled allocation and a 256 byte copy rather than a
+ * trip to the heap. Reference counts are atomic: copies may be handed to
+ * other threads, as long as each PagedMemory is used by one thread at a
+ * time.
+ *
+ * A Zobrist hash of the contents is kept up to date by every store, so
+ * hash() is O(1): each non-zero byte contributes byteKey(address, value),
+ * XORed together, and a store swaps the old byte's key for the new one.
+ *
+ * Addresses wrap at 4 KiB.
+ */
+class PagedMemory {
+public:
+    static constexpr uint16_t SIZE = 4096;
+    static constexpr uint16_t PAGE_SIZE = 256;
+    static constexpr uint16_t PAGE_COUNT = SIZE / PAGE_SIZE;
+
+    struct alignas(64) Page {
+        uint8_t bytes[PAGE_SIZE];
+        std::atomic<uint32_t> refs;   // PagedMemory instances sharing the page; 0 for the zero page
+    };
+
+    PagedMemory();
+    PagedMemory(const PagedMemory& other);
+    PagedMemory& operator=(const PagedMemory& other);
+    ~PagedMemory();
+
+    static constexpr size_t size() { return SIZE; }
+
+    /**
+     * @brief Reads the byte at address.
+     */
+    uint8_t operator[](uint16_t address) const {
+        address &= SIZE - 1;
+        return pages[address / PAGE_SIZE]->bytes[address % PAGE_SIZE];
+    }
+
+    /**
+     * @brief Reads the big-endian 16-bit word at address, i.e. an opcode.
+     */
+    uint16_t word(uint16_t address) const {
+        address &= SIZE - 1;
+        const uint8_t* bytes = pages[address / PAGE_SIZE]->bytes;
+        unsigned offset = address % PAGE_SIZE;
+        if (offset + 1 < PAGE_SIZE) {
+            return static_cast<uint16_t>(bytes[offset] << 8 | bytes[offset + 1]);
+        }
+        return static_cast<uint16_t>(bytes[offset] << 8 | (*this)[address + 1]);
+    }
+
+    /**
+     * @brief Writes one byte, copying its page first if it is shared.
+     */
+    void write(uint16_t address, uint8_t value) {
+        address &= SIZE - 1;
+        uint8_t& byte = writablePage(address / PAGE_SIZE)[address % PAGE_SIZE];
+        contentHash ^= byteKey(address, byte) ^ byteKey(address, value);
+        byte = value;
+    }
+
+    /**
+     * @brief Writes size bytes from data starting at address, wrapping at 4 KiB.
+     */
+    void store(uint16_t address, const uint8_t* data, size_t size);
+
+    /**
+     * @brief Copies all SIZE bytes into out.
+     */
+    void copyTo(uint8_t* out) const;
+
+    /**
+     * @brief Returns the 256 bytes of a page, read-only.
+     */
+    const uint8_t* pageData(size_t index) const { return pages[index]->bytes; }
+
+    /**
+     * @brief Returns whether this instance is the only owner of a page.
+     */
+    bool ownsPage(size_t index) const { return pages[index]->refs.load(std::memory_order_acquire) == 1; }
+
+    /**
+     * @brief Sets every byte to zero, releasing all pages.
+     */
+    void clear();
+
+    /**
+     * @brief Returns the Zobrist hash of the contents; 0 when all bytes are zero.
+     */
+    uint64_t hash() const { return contentHash; }
+
+    /**
+     * @brief Zobrist key of one byte value at one address; 0 for a zero byte.
+     */
+    static uint64_t byteKey(uint16_t address, uint8_t value) {
+        return mix64(static_cast<uint64_t>(address) << 8 | value) & (0 - static_cast<uint64_t>(value != 0));
+    }
+
+private:
+    uint8_t* writablePage(size_t index) {
+        if (!ownsPage(index)) {
+            detach(index);
+        }
+        return pages[index]->bytes;
+    }
+
+    void detach(size_t index);
+    static void retain(Page* page);
+    static void release(Page* page);
+
+    Page* pages[PAGE_COUNT];
+    uint64_t contentHash;
+};
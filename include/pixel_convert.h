@@ -0,0 +1,25 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Expands packed 1-bit display rows into 32-bit pixels.
+ *
+ * Each source row is a uint64_t with bit 63 as the leftmost pixel (see
+ * Framebuffer). Set bits become onColor and clear bits offColor. The kernel
+ * is chosen once at runtime: AVX2 or SSE2 on x86, a scalar loop elsewhere.
+ *
+ * @param rows First packed row to convert.
+ * @param count Number of rows to convert.
+ * @param dst Destination of the first row; needs 64 * 4 bytes per row.
+ * @param pitch Distance in bytes between destination rows.
+ * @param onColor Pixel value for lit pixels.
+ * @param offColor Pixel value for unlit pixels.
+ */
+void expandRows(const uint64_t* rows, size_t count, void* dst, size_t pitch,
+                uint32_t onColor, uint32_t offColor);
+
+/**
+ * @brief Name of the kernel expandRows() dispatches to: "avx2", "sse2" or "scalar".
+ */
+const char* pixelConvertKernel();
@@ -0,0 +1,235 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct Instruction;
+
+/**
+ * @class Profiler
+ * @brief Execution counters for one or more Chip8 instances, dumpable as text
+ *        and as a folded-stack file for flamegraph tools.
+ *
+ * Attach one with Chip8::setProfiler(). While attached, the core reports
+ * every instruction it retires: the profiler counts it per opcode family and
+ * per address (a hotspot histogram over the 4 KiB address space), and
+ * charges it to the current node of a shadow call tree that follows 2NNN
+ * and 00EE. Every sampleInterval instructions one instruction (or, in
+ * Translated mode, one block) is timed with the steady clock, giving a
+ * sampled cost per family with the clock's own overhead subtracted.
+ *
+ * Frontends add wall-clock rates: frames, render time and the EventLogger
+ * queue depth. Everything except recordRender() must be called from the
+ * thread running the attached core; recordRender() may be called from any
+ * thread.
+ *
+ * A Chip8 without a profiler runs handlers with no profiler code in them and
+ * pays one pointer test per execute() call and per translated block, so the
+ * profiler can stay compiled in.
+ */
+class Profiler {
+public:
+    static constexpr uint16_t MEMORY_SIZE = 4096;
+    static constexpr size_t FAMILY_COUNT = 35;                 // The 34 instructions plus unknown opcodes
+    static constexpr uint32_t DEFAULT_SAMPLE_INTERVAL = 1024;  // Instructions between timed samples
+    static constexpr size_t MAX_CALL_DEPTH = 64;               // Deeper calls are charged to the deepest node
+    static constexpr size_t MAX_CALL_NODES = 1 << 16;          // Likewise for new call paths once this many exist
+
+    explicit Profiler(uint32_t sampleInterval = DEFAULT_SAMPLE_INTERVAL);
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    /**
+     * @brief Returns the family index of an opcode, e.g. the index of "8XY4".
+     */
+    static size_t familyOf(uint16_t opcode);
+
+    /**
+     * @brief Returns the name of a family, e.g. "8XY4" or "unknown".
+     */
+    static const char* familyName(size_t family);
+
+    /**
+     * @brief Reads the steady clock in nanoseconds.
+     */
+    static uint64_t now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    /**
+     * @brief Counts instructions towards the next sample; true when they are due to be timed.
+     * @param instructions Instructions about to run.
+     */
+    bool sampleDue(uint32_t instructions = 1) {
+        if (untilSample > instructions) {
+            untilSample -= instructions;
+            return false;
+        }
+        untilSample = sampleInterval;
+        return true;
+    }
+
+    /**
+     * @brief Records one retired instruction.
+     * @param address Address it was fetched from.
+     * @param opcode The instruction.
+     */
+    void recordInstruction(uint16_t address, uint16_t opcode) {
+        address &= MEMORY_SIZE - 1;
+        size_t family = familyOf(opcode);
+        ++familyCounts[family];
+        ++pcCounts[address];
+        pcOpcodes[address] = opcode;
+        ++nodes[current].self;
+        ++instructions;
+        followCall(family, opcode);
+    }
+
+    /**
+     * @brief Records the instructions a translated block retired.
+     * @param start Address of the block's first instruction.
+     * @param code The block's threaded code, one slot per instruction.
+     * @param ran How many of its instructions ran, from the first.
+     * @param elapsedNs Time taken if the block was sampled, otherwise 0.
+     */
+    void recordBlock(uint16_t start, const Instruction* code, uint16_t ran, uint64_t elapsedNs);
+
+    /**
+     * @brief Charges a timed sample to one instruction.
+     * @param opcode The instruction.
+     * @param elapsedNs Time taken, including the clock reads.
+     */
+    void recordSample(uint16_t opcode, uint64_t elapsedNs);
+
+    /**
+     * @brief Returns the shadow call stack to the root, e.g. after a state restore.
+     */
+    void resetCallStack();
+
+    /**
+     * @brief Starts (or restarts) the wall clock behind the per-second rates.
+     */
+    void start();
+
+    /**
+     * @brief Stops the wall clock; rates then cover start() to stop().
+     */
+    void stop();
+
+    /**
+     * @brief Counts one emulated frame.
+     */
+    void recordFrame() { ++frames; }
+
+    /**
+     * @brief Adds the duration of one render. Safe to call from any thread.
+     */
+    void recordRender(uint64_t elapsedNs);
+
+    /**
+     * @brief Samples the EventLogger queue depth.
+     */
+    void recordQueueDepth(size_t depth);
+
+    /**
+     * @brief Adds another profiler's counters and call tree to this one.
+     *
+     * Locks this profiler, so instances on different threads can merge into
+     * a shared one. The wall clock is not merged: this profiler's own
+     * start() and stop() still define the rates.
+     */
+    void merge(const Profiler& other);
+
+    /**
+     * @brief Writes the report to prefix.txt and the folded stacks to prefix.folded.
+     * @return true if both files were written.
+     */
+    bool dump(const std::string& prefix) const;
+
+    /**
+     * @brief Writes the summary, per-family table and hotspot histogram as CSV sections.
+     */
+    void writeReport(std::ostream& out) const;
+
+    /**
+     * @brief Writes one "frame;frame;... count" line per call path, for flamegraph.pl
+     *        or speedscope. The root frame is "main", subroutines are "sub_0xNNN".
+     */
+    void writeFolded(std::ostream& out) const;
+
+    /**
+     * @brief Makes SIGUSR1 request a dump, where the platform has it.
+     */
+    static void installSignalHandler();
+
+    /**
+     * @brief Returns whether a dump was requested by signal since the last call.
+     */
+    static bool takeDumpRequest();
+
+    uint64_t getInstructions() const { return instructions; }
+    uint64_t getFamilyCount(size_t family) const { return familyCounts[family]; }
+    uint64_t getPcCount(uint16_t address) const { return pcCounts[address & (MEMORY_SIZE - 1)]; }
+    uint64_t getFrames() const { return frames; }
+
+private:
+    static constexpr size_t FAMILY_00EE = 1;
+    static constexpr size_t FAMILY_2NNN = 3;
+    static constexpr uint32_t NO_NODE = UINT32_MAX;
+
+    struct CallNode {
+        uint16_t address;   // Subroutine entry; 0 for the root
+        uint32_t parent;
+        uint32_t depth;
+        uint64_t self;      // Instructions retired in this call path
+    };
+
+    void followCall(size_t family, uint16_t opcode) {
+        if (family == FAMILY_2NNN) {
+            enterCall(opcode & 0x0FFF);
+        } else if (family == FAMILY_00EE) {
+            leaveCall();
+        }
+    }
+
+    void enterCall(uint16_t address);
+    void leaveCall();
+    uint32_t childOf(uint32_t parent, uint16_t address);
+    double elapsedSeconds() const;
+
+    uint32_t sampleInterval;
+    uint32_t untilSample;
+    uint64_t clockOverheadNs;   // Cost of a back-to-back pair of now() calls
+    uint64_t instructions;
+    std::array<uint64_t, FAMILY_COUNT> familyCounts;
+    std::array<uint64_t, FAMILY_COUNT> familySamples;
+    std::array<uint64_t, FAMILY_COUNT> familySampleNs;
+    std::array<uint64_t, MEMORY_SIZE> pcCounts;
+    std::array<uint16_t, MEMORY_SIZE> pcOpcodes;   // Last opcode seen at each address
+
+    std::vector<CallNode> nodes;                        // nodes[0] is the root; parents precede children
+    std::unordered_map<uint64_t, uint32_t> children;    // (parent << 12 | address) -> node
+    uint32_t current;
+    uint32_t overflowDepth;                             // Calls past MAX_CALL_DEPTH not yet returned
+
+    uint64_t frames;
+    std::atomic<uint64_t> renders;
+    std::atomic<uint64_t> renderNs;
+    std::atomic<uint64_t> renderMaxNs;
+    uint64_t queueSamples;
+    uint64_t queueDepthSum;
+    size_t queueDepthMax;
+
+    uint64_t startNs;
+    uint64_t stopNs;   // 0 while running
+    mutable std::mutex mergeMutex;
+};
@@ -0,0 +1,118 @@
+#pragma once
+#include "chip8_state.h"
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+/**
+ * @brief Size and compression counters reported by RewindBuffer::getStats().
+ */
+struct RewindStats {
+    uint64_t frames = 0;          // Frames currently held
+    uint64_t keyframes = 0;       // Of which stored in full
+    uint64_t evictedFrames = 0;   // Frames dropped to stay within the budget
+    size_t storedBytes = 0;       // Encoded bytes held
+    size_t memoryUsed = 0;        // Bytes allocated, including per-frame offsets
+    size_t memoryBudget = 0;
+    double compressionRatio = 0;  // Raw snapshot bytes / encoded bytes
+    double avgDeltaBytes = 0;     // Mean encoded size of a non-key frame
+};
+
+/**
+ * @class RewindBuffer
+ * @brief Bounded history of per-frame Chip8 snapshots for rewinding.
+ *
+ * Frames are grouped behind periodic keyframes. A keyframe is stored whole;
+ * every other frame is stored as the XOR of its snapshot with the previous
+ * frame's, run-length encoded as (equal bytes to skip, differing bytes)
+ * pairs. Most frames change a few registers, the cycle counter and a few
+ * display rows, so a delta is typically tens of bytes.
+ *
+ * Because XOR is its own inverse, a delta turns either neighbour into the
+ * other, so seeking walks from the nearer of the group's keyframe and the
+ * last decoded frame, in either direction. Stepping back one frame at a
+ * time therefore costs one delta per step.
+ *
+ * When the memory budget is exceeded the oldest group (a keyframe and its
+ * deltas) is evicted as a whole. Frames are numbered from 0 in push order;
+ * numbers stay valid until the frame is evicted or rewound over.
+ */
+class RewindBuffer {
+public:
+    static constexpr size_t DEFAULT_MEMORY_BUDGET = 16u << 20;
+    static constexpr uint32_t DEFAULT_KEYFRAME_INTERVAL = 60;
+
+    /**
+     * @brief Creates an empty buffer.
+     * @param memoryBudget Upper bound on allocated bytes; the newest group is always kept.
+     * @param keyframeInterval Frames per group, i.e. one keyframe every this many frames.
+     */
+    explicit RewindBuffer(size_t memoryBudget = DEFAULT_MEMORY_BUDGET,
+                          uint32_t keyframeInterval = DEFAULT_KEYFRAME_INTERVAL);
+
+    void setMemoryBudget(size_t bytes);
+    void setKeyframeInterval(uint32_t frames) { keyframeInterval = frames > 0 ? frames : 1; }
+
+    /**
+     * @brief Appends the snapshot of a new frame.
+     * @param state The machine state at the end of the frame.
+     */
+    void push(const Chip8State& state);
+
+    /**
+     * @brief Reconstructs a held frame without changing the history.
+     * @param frame Frame number, from oldestFrame() to newestFrame().
+     * @param out Receives the snapshot.
+     * @return false if the frame is not held.
+     */
+    bool seek(uint64_t frame, Chip8State& out);
+
+    /**
+     * @brief Reconstructs a held frame and discards every frame after it.
+     * @return false if the frame is not held.
+     */
+    bool rewindTo(uint64_t frame, Chip8State& out);
+
+    /**
+     * @brief Discards the newest frame and returns the one before it.
+     * @return false if fewer than two frames are held.
+     */
+    bool stepBack(Chip8State& out);
+
+    /**
+     * @brief Discards every frame.
+     */
+    void clear();
+
+    bool empty() const { return groups.empty(); }
+    uint64_t oldestFrame() const { return groups.empty() ? nextFrame : groups.front().firstFrame; }
+    uint64_t newestFrame() const { return nextFrame - 1; }
+    RewindStats getStats() const;
+
+private:
+    struct Group {
+        uint64_t firstFrame;            // Frame number of the keyframe
+        std::vector<uint8_t> data;      // Keyframe then deltas, back to back
+        std::vector<uint32_t> offsets;  // Start of each frame's encoding in data
+    };
+
+    static void encode(const uint8_t* current, const uint8_t* previous, std::vector<uint8_t>& out);
+    static void apply(const uint8_t* in, const uint8_t* end, uint8_t* state);
+
+    Group* findGroup(uint64_t frame);
+    void applyFrame(const Group& group, size_t index, uint8_t* state) const;
+    static size_t allocatedBytes(const Group& group);
+    void evict();
+
+    std::deque<Group> groups;
+    size_t memoryBudget;
+    uint32_t keyframeInterval;
+    size_t memoryUsed;
+    uint64_t nextFrame;
+    uint64_t evictedFrames;
+    Chip8State newest;              // Raw copy of the newest frame, the base for the next delta
+    Chip8State cursor;              // Last frame reconstructed by seek()
+    uint64_t cursorFrame;
+    bool cursorValid;
+};
@@ -0,0 +1,147 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @class RomAnalysis
+ * @brief Static control-flow analysis of a ROM image as loaded at 0x200.
+ *
+ * analyze() disassembles the image by recursive descent from 0x200,
+ * following jumps, calls (assuming they return), both sides of every skip
+ * and the fall-through of everything else. Alongside it runs a dataflow
+ * pass tracking whether I holds a known constant (set by ANNN, lost at
+ * FX1E, FX29, joins of different values and after calls). Where I is known:
+ *   - DXYN marks the N bytes at I as sprite data,
+ *   - FX65 marks the bytes it reads as data,
+ *   - FX33 and FX55 record the bytes they write, and whether they overlap
+ *     code, i.e. the program modifies itself.
+ * A store whose target is unknown may write anywhere, including code.
+ *
+ * The result is a byte classification, the basic blocks of the CFG with
+ * their successor edges, the subroutines (2NNN targets) with their call
+ * sites, the BNNN indirect jumps, whose targets depend on V0 and are not
+ * followed, and the store sites. Bytes nothing reaches are neither code
+ * nor known data. Chip8::precompile() uses the blocks to fill its decode
+ * and block caches before the first cycle.
+ */
+class RomAnalysis {
+public:
+    static constexpr uint16_t MEMORY_SIZE = 4096;
+    static constexpr uint16_t LOAD_ADDRESS = 0x200;
+
+    /**
+     * @brief What analyze() found a byte of the image to be; flags combine.
+     */
+    enum ByteFlag : uint8_t {
+        Code = 1,      // First byte of a reachable instruction
+        Operand = 2,   // Second byte of a reachable instruction
+        Sprite = 4,    // Drawn by DXYN with a known I
+        Data = 8,      // Read by FX65 or written by FX33/FX55 with a known I
+        Leader = 16    // Starts a basic block
+    };
+
+    /**
+     * @brief How control leaves a basic block.
+     */
+    enum class Exit : uint8_t {
+        FallThrough,   // Runs into the next block's leader
+        Jump,          // 1NNN
+        Call,          // 2NNN; successors are the subroutine and the return site
+        Return,        // 00EE
+        Skip,          // 3XNN, 4XNN, 5XY0, 9XY0, EX9E, EXA1
+        Indirect,      // BNNN; target not known statically
+        Invalid,       // Unknown opcode, or the next instruction is outside the image
+    };
+
+    struct BasicBlock {
+        uint16_t start;                    // Address of the first instruction
+        uint16_t end;                      // One past the last byte
+        Exit exit;
+        std::vector<uint16_t> successors;  // Leaders control can reach next
+    };
+
+    struct Subroutine {
+        uint16_t entry;
+        std::vector<uint16_t> callers;     // Addresses of the 2NNN instructions
+    };
+
+    struct StoreSite {
+        uint16_t address;     // Address of the FX33 or FX55
+        uint16_t opcode;
+        bool targetKnown;     // I was a known constant here
+        uint16_t target;      // First byte written, if targetKnown
+        uint16_t length;      // Bytes written
+        bool overlapsCode;    // Writes reachable code, or may (target unknown)
+    };
+
+    /**
+     * @brief Analyzes a ROM image; replaces any previous result.
+     * @param rom Program bytes, as passed to Chip8::loadProgram().
+     * @param size Number of bytes.
+     * @return false if the image does not fit in memory.
+     */
+    bool analyze(const uint8_t* rom, size_t size);
+
+    /**
+     * @brief Returns the Cowgod-style mnemonic of an opcode, e.g. "LD VA, 0x02".
+     */
+    static std::string disassemble(uint16_t opcode);
+
+    /**
+     * @brief Writes the image as an annotated listing: labelled code, sprites drawn as
+     *        pixels, and data or unreached bytes as db lines.
+     */
+    void writeListing(std::ostream& out) const;
+
+    /**
+     * @brief Writes the CFG as a Graphviz digraph, one node per basic block.
+     */
+    void writeDot(std::ostream& out) const;
+
+    /**
+     * @brief Writes the blocks, subroutines, indirect jumps, store sites and byte
+     *        counts as one JSON object.
+     */
+    void writeJson(std::ostream& out) const;
+
+    uint8_t flags(uint16_t address) const { return byteFlags[address & (MEMORY_SIZE - 1)]; }
+    bool isCode(uint16_t address) const { return (flags(address) & Code) != 0; }
+    size_t getRomSize() const { return image.size(); }
+    const std::vector<BasicBlock>& getBlocks() const { return blocks; }
+    const std::vector<Subroutine>& getSubroutines() const { return subroutines; }
+    const std::vector<uint16_t>& getIndirectJumps() const { return indirectJumps; }
+    const std::vector<StoreSite>& getStores() const { return stores; }
+
+    /**
+     * @brief Counts the image bytes carrying a flag.
+     */
+    size_t countBytes(ByteFlag flag) const;
+
+    /**
+     * @brief Returns whether a store may write code, so blocks can be invalidated at run time.
+     */
+    bool selfModifying() const;
+
+private:
+    bool inImage(uint16_t address) const {
+        return address >= LOAD_ADDRESS && address + 2u <= LOAD_ADDRESS + image.size();
+    }
+    uint16_t word(uint16_t address) const {
+        return static_cast<uint16_t>(image[address - LOAD_ADDRESS] << 8 | image[address - LOAD_ADDRESS + 1]);
+    }
+    void traceCode();
+    void buildBlocks();
+    void markData(uint16_t address, size_t length, ByteFlag flag);
+
+    std::vector<uint8_t> image;
+    std::array<uint8_t, MEMORY_SIZE> byteFlags{};
+    std::array<int32_t, MEMORY_SIZE> entryI{};   // I on entry: UNVISITED, UNKNOWN_I or the value
+    std::vector<BasicBlock> blocks;              // Sorted by start
+    std::vector<Subroutine> subroutines;         // Sorted by entry
+    std::vector<uint16_t> indirectJumps;
+    std::vector<StoreSite> stores;
+};
@@ -0,0 +1,143 @@
+#pragma once
+#include "rom_analysis.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @file rom_library.h
+ * @brief Memory-mapped, content-addressed ROM images.
+ *
+ * A pack file (.c8rp) stores many ROMs in one mapping:
+ *
+ *   Header      "C8RP" magic, u16 version, u16 header size, u32 ROM count, u32 name count
+ *   ROM table   ROM count x (u64 FNV-1a content hash, u32 offset, u32 size)
+ *   Name table  name count x (u32 ROM index, u16 length, length bytes of name)
+ *   Images      at their offsets from the start of the file
+ *
+ * All integers are little-endian. Several names may share one image.
+ */
+namespace pack {
+
+constexpr uint8_t MAGIC[4] = {'C', '8', 'R', 'P'};
+constexpr uint16_t VERSION = 1;
+constexpr size_t HEADER_SIZE = 16;
+constexpr size_t ROM_ENTRY_SIZE = 16;
+
+} // namespace pack
+
+/**
+ * @class RomLibrary
+ * @brief ROM images mapped once and shared read-only by every instance and thread.
+ *
+ * ROMs are added from single files, directories or pack files. Each file is
+ * mapped with mmap rather than read, and each image is validated once: it
+ * must fit in memory above 0x200, and pack images must match their stored
+ * hash. Images are indexed by name (the path they were added under, or the
+ * name stored in the pack) and by FNV-1a content hash. Identical images
+ * added under several names share one Rom, so they also share its
+ * RomAnalysis, which is built on first use.
+ *
+ * Loading an instance is then Chip8::loadProgram() from the mapping: a
+ * bounds-checked copy into the instance's pages with no filesystem access.
+ *
+ * Adding is not thread-safe. Once the library is set up, lookups and
+ * every Rom may be used from any number of threads. Roms stay valid until
+ * the library is destroyed.
+ */
+class RomLibrary {
+public:
+    static constexpr size_t MAX_ROM_SIZE = RomAnalysis::MEMORY_SIZE - RomAnalysis::LOAD_ADDRESS;
+
+    /**
+     * @class Rom
+     * @brief One validated image.
+     */
+    class Rom {
+    public:
+        const uint8_t* data() const { return data_; }
+        size_t size() const { return size_; }
+        uint64_t hash() const { return hash_; }
+
+        /**
+         * @brief Returns the image's analysis, analyzing it on the first call from any thread.
+         */
+        const RomAnalysis& analysis() const;
+
+    private:
+        friend class RomLibrary;
+        const uint8_t* data_ = nullptr;
+        size_t size_ = 0;
+        uint64_t hash_ = 0;
+        mutable std::once_flag analyzed_;
+        mutable RomAnalysis analysis_;
+    };
+
+    RomLibrary();
+    ~RomLibrary();
+
+    RomLibrary(const RomLibrary&) = delete;
+    RomLibrary& operator=(const RomLibrary&) = delete;
+
+    /**
+     * @brief Maps a ROM file and adds it under its path.
+     * @return The image, or nullptr (with a message on stderr) if the file
+     *         cannot be read or does not fit in memory.
+     */
+    const Rom* addFile(const std::string& path);
+
+    /**
+     * @brief Adds every regular file under a directory, recursively, under its path.
+     * @return Number of files added; unusable files are reported and skipped.
+     */
+    size_t addDirectory(const std::string& path);
+
+    /**
+     * @brief Maps a pack file and adds its images under their stored names.
+     * @return false (with a message on stderr) if the pack is unreadable or invalid.
+     */
+    bool addPack(const std::string& path);
+
+    /**
+     * @brief Adds a directory, or a pack file when path is not one.
+     */
+    bool add(const std::string& path);
+
+    /**
+     * @brief Writes every image once, with all of its names, as a pack file.
+     * @return true if the file was written.
+     */
+    bool writePack(const std::string& path) const;
+
+    /**
+     * @brief Looks an image up by name, e.g. a ROM path given on the command line.
+     */
+    const Rom* find(const std::string& name) const;
+
+    /**
+     * @brief Looks an image up by FNV-1a content hash.
+     */
+    const Rom* findHash(uint64_t hash) const;
+
+    size_t getRomCount() const { return roms_.size(); }
+    size_t getNameCount() const { return names_.size(); }
+
+private:
+    struct Mapping {
+        void* address;
+        size_t length;
+    };
+
+    static std::string normalize(const std::string& name);
+    const uint8_t* map(const std::string& path, size_t& size);
+    const Rom* insert(const std::string& name, const uint8_t* data, size_t size, uint64_t hash);
+
+    std::vector<Mapping> mappings_;
+    std::vector<std::unique_ptr<Rom>> roms_;                // In insertion order
+    std::unordered_map<uint64_t, const Rom*> byHash_;
+    std::unordered_map<std::string, const Rom*> names_;     // Normalized name -> image
+};
@@ -0,0 +1,87 @@
+#pragma once
+#include "chip8.h"
+#include <chrono>
+#include <cstdint>
+
+/**
+ * @class Scheduler
+ * @brief Paces CHIP-8 execution against wall-clock time.
+ *
+ * Runs a configurable number of instructions per second, split into 60Hz
+ * frames. Each frame executes its share of the instruction budget and ticks
+ * the delay/sound timers once, so timer speed is independent of CPU speed.
+ * Frames are paced against absolute deadlines rather than a fixed sleep, so
+ * time spent emulating and rendering does not accumulate as drift.
+ */
+class Scheduler {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr int TIMER_HZ = 60;
+    static constexpr int UNLIMITED = 0;
+    static constexpr int DEFAULT_CYCLES_PER_SECOND = 700;
+
+    explicit Scheduler(int cyclesPerSecond = DEFAULT_CYCLES_PER_SECOND);
+
+    /**
+     * @brief Sets the instruction rate.
+     * @param cyclesPerSecond Instructions per second, or UNLIMITED to run as
+     *        many instructions as fit before each frame deadline.
+     */
+    void setCyclesPerSecond(int cyclesPerSecond);
+    int getCyclesPerSecond() const { return cyclesPerSecond; }
+
+    /**
+     * @brief Resets the frame clock so that frame 0 starts now.
+     */
+    void start();
+
+    /**
+     * @brief Restarts the frame clock from now, keeping the frame and
+     *        missed-deadline counters. Call after blocking outside the loop.
+     */
+    void resync();
+
+    /**
+     * @brief Aligns the fractional cycle carry with a frame index, as if
+     *        frames 0..frame-1 had just run. Call after rewinding to a frame
+     *        so later frames get the same budgets as a straight run.
+     * @param frame Index of the next frame to run.
+     */
+    void setCyclePhase(uint64_t frame);
+
+    /**
+     * @brief Executes one frame worth of instructions and ticks the timers.
+     *
+     * The frame's remaining budget is dropped as soon as the core goes idle
+     * (see Chip8::getIdleState()).
+     * @param chip8 The CHIP-8 instance to drive.
+     * @return Number of instructions executed during the frame.
+     */
+    uint64_t runFrame(Chip8& chip8);
+
+    /**
+     * @brief Sleeps until the deadline of the next frame.
+     *
+     * If the emulator has fallen more than a few frames behind, the frame
+     * clock is resynchronised instead of trying to catch up in a burst.
+     */
+    void waitForNextFrame();
+
+    /**
+     * @brief Returns true if the frame just run ended after its deadline.
+     */
+    bool isBehind() const { return Clock::now() > frameDeadline(frameCount); }
+
+    uint64_t getFrameCount() const { return frameCount; }
+    uint64_t getMissedDeadlines() const { return missedDeadlines; }
+
+private:
+    Clock::time_point frameDeadline(uint64_t frame) const;
+
+    int cyclesPerSecond;
+    int cycleRemainder;        // Fractional cycles carried between frames, in 1/TIMER_HZ units
+    uint64_t frameCount;
+    uint64_t missedDeadlines;
+    Clock::time_point epoch;   // Start time of frame 0
+};
@@ -0,0 +1,260 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+/**
+ * @brief What SpscQueue::push() does when the queue is full.
+ */
+enum class OverflowPolicy {
+    Drop,            // Discard the new value and count it
+    Block,           // Yield until the consumer makes room
+    OverwriteOldest  // Replace the oldest unread value; T must be trivially copyable
+};
+
+/**
+ * @class SpscQueue
+ * @brief Bounded lock-free single-producer, single-consumer ring buffer.
+ *
+ * A drop-in for MessageQueue where exactly one thread pushes and one thread
+ * pops. push() never takes a lock: it writes the slot and publishes the new
+ * tail, and only touches the mutex when the consumer is asleep in pop() or
+ * waitPop(). The read and write indices live on separate cache lines, and
+ * the producer keeps a private copy of the read index so it only reads the
+ * consumer's line when the queue looks full. The consumer drains in batches
+ * with drain() or consume().
+ *
+ * With OverwriteOldest the producer advances the read index itself, so the
+ * consumer copies each value out and then claims it with a compare-exchange,
+ * discarding the copy if it was overwritten in the meantime. That is only
+ * sound for trivially copyable T; the constructor rejects anything else.
+ *
+ * @tparam T Type of message stored in the queue.
+ */
+template <typename T>
+class SpscQueue {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 4096;
+
+    /**
+     * @brief Creates a queue holding at least capacity values.
+     * @param capacity Requested capacity; rounded up to a power of two.
+     * @param policy Behaviour of push() when the queue is full.
+     */
+    explicit SpscQueue(size_t capacity = DEFAULT_CAPACITY, OverflowPolicy policy = OverflowPolicy::Drop)
+        : policy_(policy) {
+        if (policy == OverflowPolicy::OverwriteOldest && !std::is_trivially_copyable<T>::value) {
+            throw std::invalid_argument("SpscQueue: OverwriteOldest requires a trivially copyable type");
+        }
+        capacity_ = 1;
+        while (capacity_ < capacity) {
+            capacity_ <<= 1;
+        }
+        mask_ = capacity_ - 1;
+        slots_.reset(new Slot[capacity_]);
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    ~SpscQueue() {
+        for (uint64_t i = head_.load(); i != tail_.load(); ++i) {
+            slot(i)->~T();
+        }
+    }
+
+    /**
+     * @brief Producer side: enqueues a value, applying the overflow policy.
+     * @return false if the value was dropped.
+     */
+    bool try_push(const T& value) { return emplace(value); }
+    bool try_push(T&& value) { return emplace(std::move(value)); }
+
+    // MessageQueue-compatible spelling of try_push().
+    void push(const T& value) { emplace(value); }
+    void push(T&& value) { emplace(std::move(value)); }
+
+    /**
+     * @brief Consumer side: passes up to maxItems values to fn, oldest first.
+     * @param fn Callable taking T&&.
+     * @param maxItems Upper bound on values consumed.
+     * @return Number of values consumed.
+     */
+    template <typename F>
+    size_t consume(F&& fn, size_t maxItems) {
+        if (policy_ == OverflowPolicy::OverwriteOldest) {
+            return consumeValidated(fn, maxItems);
+        }
+        uint64_t head = head_.load(std::memory_order_relaxed);
+        uint64_t tail = tail_.load(std::memory_order_acquire);
+        size_t count = static_cast<size_t>(std::min<uint64_t>(tail - head, maxItems));
+        for (size_t i = 0; i < count; ++i) {
+            T* item = slot(head + i);
+            fn(std::move(*item));
+            item->~T();
+        }
+        head_.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * @brief Consumer side: moves up to maxItems values to out, oldest first.
+     * @return Number of values written.
+     */
+    template <typename OutputIt>
+    size_t drain(OutputIt out, size_t maxItems) {
+        return consume([&out](T&& value) { *out++ = std::move(value); }, maxItems);
+    }
+
+    /**
+     * @brief Consumer side: pops one value without blocking.
+     * @return false if the queue was empty.
+     */
+    bool try_pop(T& out) {
+        return consume([&out](T&& value) { out = std::move(value); }, 1) == 1;
+    }
+
+    /**
+     * @brief Consumer side: pops one value, waiting up to timeout for it.
+     * @return false if the queue was still empty after timeout.
+     */
+    bool waitPop(T& out, std::chrono::milliseconds timeout) {
+        return try_pop(out) || (waitForData(timeout) && try_pop(out));
+    }
+
+    /**
+     * @brief Consumer side: pops one value, blocking until one is available.
+     */
+    T pop() {
+        std::optional<T> value;
+        while (consume([&value](T&& item) { value.emplace(std::move(item)); }, 1) == 0) {
+            waitForData(WAIT_SLICE);
+        }
+        return std::move(*value);
+    }
+
+    /**
+     * @brief Consumer side: waits until the queue is non-empty or timeout expires.
+     * @return true if data is available.
+     */
+    bool waitForData(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(waitMutex_);
+        consumerWaiting_.store(true);
+        bool ready = dataAvailable_.wait_for(lock, timeout, [this] { return !empty(); });
+        consumerWaiting_.store(false, std::memory_order_relaxed);
+        return ready;
+    }
+
+    bool empty() const { return head_.load() == tail_.load(); }
+    size_t size() const { return static_cast<size_t>(tail_.load() - head_.load()); }
+    size_t capacity() const { return capacity_; }
+    OverflowPolicy policy() const { return policy_; }
+
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+    uint64_t overwritten() const { return overwritten_.load(std::memory_order_relaxed); }
+    uint64_t producerStalls() const { return producerStalls_.load(std::memory_order_relaxed); }
+
+private:
+    // Upper bound on one sleep in pop(); a safety net, wake-ups normally come from push().
+    static constexpr std::chrono::milliseconds WAIT_SLICE{100};
+
+    struct Slot {
+        alignas(T) unsigned char storage[sizeof(T)];
+    };
+
+    T* slot(uint64_t index) {
+        return std::launder(reinterpret_cast<T*>(slots_[index & mask_].storage));
+    }
+
+    template <typename U>
+    bool emplace(U&& value) {
+        uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - headCache_ >= capacity_) {
+            headCache_ = head_.load(std::memory_order_acquire);
+            if (tail - headCache_ >= capacity_ && !makeRoom(tail)) {
+                return false;
+            }
+        }
+        new (slots_[tail & mask_].storage) T(std::forward<U>(value));
+        // Sequentially consistent with the consumerWaiting_ load below, pairing with
+        // waitForData(): either the consumer sees the new tail or we see it waiting.
+        tail_.store(tail + 1);
+        if (consumerWaiting_.load()) {
+            std::lock_guard<std::mutex> lock(waitMutex_);
+            dataAvailable_.notify_one();
+        }
+        return true;
+    }
+
+    bool makeRoom(uint64_t tail) {
+        switch (policy_) {
+            case OverflowPolicy::Drop:
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            case OverflowPolicy::Block:
+                producerStalls_.fetch_add(1, std::memory_order_relaxed);
+                do {
+                    std::this_thread::yield();
+                    headCache_ = head_.load(std::memory_order_acquire);
+                } while (tail - headCache_ >= capacity_);
+                return true;
+            case OverflowPolicy::OverwriteOldest: {
+                uint64_t head = headCache_;
+                // On failure the consumer advanced head itself, which also frees a slot.
+                if (head_.compare_exchange_strong(head, head + 1, std::memory_order_acq_rel)) {
+                    overwritten_.fetch_add(1, std::memory_order_relaxed);
+                    headCache_ = head + 1;
+                } else {
+                    headCache_ = head;
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <typename F>
+    size_t consumeValidated(F& fn, size_t maxItems) {
+        size_t count = 0;
+        while (count < maxItems) {
+            uint64_t head = head_.load(std::memory_order_acquire);
+            if (head == tail_.load(std::memory_order_acquire)) {
+                break;
+            }
+            alignas(T) unsigned char copy[sizeof(T)];
+            std::memcpy(copy, slots_[head & mask_].storage, sizeof(T));
+            if (head_.compare_exchange_strong(head, head + 1, std::memory_order_acq_rel)) {
+                fn(std::move(*std::launder(reinterpret_cast<T*>(copy))));
+                ++count;
+            }
+        }
+        return count;
+    }
+
+    OverflowPolicy policy_;
+    size_t capacity_;
+    uint64_t mask_;
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(64) std::atomic<uint64_t> head_{0};   // Next value to read; written by the consumer
+    alignas(64) std::atomic<uint64_t> tail_{0};   // Next slot to write; written by the producer
+    uint64_t headCache_ = 0;                      // Producer's last view of head_
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> overwritten_{0};
+    std::atomic<uint64_t> producerStalls_{0};
+    alignas(64) std::atomic<bool> consumerWaiting_{false};
+    std::mutex waitMutex_;
+    std::condition_variable dataAvailable_;
+};
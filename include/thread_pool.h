@@ -0,0 +1,67 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief Fixed-size work-stealing thread pool.
+ *
+ * Each worker owns a task deque. Submitted tasks are spread round-robin over
+ * the deques; a worker pops from the back of its own deque and, when that is
+ * empty, steals from the front of the others. This keeps workers busy when
+ * task durations vary widely, as they do for ROMs that halt early.
+ */
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * @brief Starts the worker threads.
+     * @param threadCount Number of workers; 0 uses the hardware concurrency.
+     */
+    explicit ThreadPool(size_t threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Queues a task for execution.
+     * @param task The task to run.
+     */
+    void submit(Task task);
+
+    /**
+     * @brief Blocks until every submitted task has finished.
+     */
+    void wait();
+
+    size_t size() const { return workers_.size(); }
+
+private:
+    struct Worker {
+        std::deque<Task> tasks;
+        std::mutex mutex;
+    };
+
+    bool popLocal(size_t index, Task& task);
+    bool steal(size_t thief, Task& task);
+    void workerLoop(size_t index);
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+    std::mutex stateMutex_;
+    std::condition_variable workAvailable_;
+    std::condition_variable allDone_;
+    std::atomic<size_t> queued_;
+    size_t pending_;
+    size_t nextWorker_;
+    bool stopping_;
+};
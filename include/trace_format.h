@@ -0,0 +1,97 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @file trace_format.h
+ * @brief Layout of CHIP-8 binary trace files (.c8t).
+ *
+ * A trace is a 16-byte file header followed by independent blocks:
+ *
+ *   File header   "C8TR" magic, u16 version, u16 header size, u32 flags, u32 reserved
+ *   Block header  u32 raw size, u32 stored size, u32 event count, u8 codec, 3 reserved
+ *   Block body    stored size bytes, LZ-compressed when codec == 1
+ *
+ * All integers are little-endian. Inside a block each event is a type byte,
+ * the zigzag varint delta of its cycle, then a type-specific payload in
+ * which program counters are zigzag varint deltas from the previous PC.
+ * The delta state resets at each block, so blocks decode on their own.
+ */
+namespace trace {
+
+constexpr uint8_t MAGIC[4] = {'C', '8', 'T', 'R'};
+constexpr uint16_t VERSION = 1;
+constexpr size_t FILE_HEADER_SIZE = 16;
+constexpr size_t BLOCK_HEADER_SIZE = 16;
+
+// Upper bound on a block's uncompressed size accepted by readers.
+constexpr uint32_t MAX_BLOCK_SIZE = 16u << 20;
+
+enum Codec : uint8_t {
+    CODEC_RAW = 0,
+    CODEC_LZ = 1
+};
+
+/**
+ * @brief Maps a signed delta to an unsigned value with small magnitudes first.
+ */
+inline uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+}
+
+inline int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+}
+
+/**
+ * @brief Appends an unsigned LEB128 varint.
+ */
+inline void putVarint(std::vector<uint8_t>& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+/**
+ * @brief Reads an unsigned LEB128 varint.
+ * @return false if the input ends inside the varint or it exceeds 64 bits.
+ */
+inline bool getVarint(const uint8_t*& in, const uint8_t* end, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (in == end) {
+            return false;
+        }
+        uint8_t byte = *in++;
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+inline void putLe16(uint8_t* out, uint16_t value) {
+    out[0] = static_cast<uint8_t>(value);
+    out[1] = static_cast<uint8_t>(value >> 8);
+}
+
+inline void putLe32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+}
+
+inline uint16_t getLe16(const uint8_t* in) {
+    return static_cast<uint16_t>(in[0] | (in[1] << 8));
+}
+
+inline uint32_t getLe32(const uint8_t* in) {
+    return static_cast<uint32_t>(in[0]) | static_cast<uint32_t>(in[1]) << 8 |
+           static_cast<uint32_t>(in[2]) << 16 | static_cast<uint32_t>(in[3]) << 24;
+}
+
+} // namespace trace
@@ -0,0 +1,53 @@
+#pragma once
+#include "event.h"
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @class TraceReader
+ * @brief Decodes a binary trace file (see trace_format.h) one event at a time.
+ *
+ * Reads and decompresses one block at a time, so memory use is bounded by
+ * the block size regardless of the trace length.
+ */
+class TraceReader {
+public:
+    /**
+     * @brief Opens a trace and validates its header.
+     * @param path Trace file.
+     * @return false if the file is missing or not a supported trace.
+     */
+    bool open(const std::string& path);
+
+    /**
+     * @brief Returns the next event, or nothing at the end of the trace.
+     *
+     * A truncated or corrupt block ends the trace early; check failed().
+     */
+    std::optional<EventVariant> next();
+
+    bool failed() const { return failed_; }
+    uint64_t blocksRead() const { return blocksRead_; }
+    uint64_t rawBytes() const { return rawBytes_; }
+    uint64_t storedBytes() const { return storedBytes_; }
+
+private:
+    bool loadBlock();
+    std::optional<EventVariant> fail(const char* reason);
+
+    std::ifstream file_;
+    std::vector<uint8_t> stored_;
+    std::vector<uint8_t> block_;
+    const uint8_t* cursor_ = nullptr;
+    const uint8_t* end_ = nullptr;
+    uint32_t eventsLeft_ = 0;
+    uint64_t lastCycle_ = 0;
+    uint16_t lastPc_ = 0;
+    bool failed_ = false;
+    uint64_t blocksRead_ = 0;
+    uint64_t rawBytes_ = 0;
+    uint64_t storedBytes_ = 0;
+};
@@ -0,0 +1,71 @@
+#pragma once
+#include "event.h"
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ * @class TraceWriter
+ * @brief Streams events into a binary trace file (see trace_format.h).
+ *
+ * Events are encoded into an in-memory block; full blocks are compressed
+ * (when that makes them smaller) and handed to a stdio stream with a large
+ * buffer, so the file is written in big sequential chunks rather than one
+ * small write per event.
+ */
+class TraceWriter {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    TraceWriter() = default;
+    ~TraceWriter();
+
+    TraceWriter(const TraceWriter&) = delete;
+    TraceWriter& operator=(const TraceWriter&) = delete;
+
+    /**
+     * @brief Creates the file and writes the file header.
+     * @param path Output file.
+     * @param compress Try LZ compression for each block.
+     * @param blockSize Uncompressed bytes per block.
+     * @return false if the file could not be created.
+     */
+    bool open(const std::string& path, bool compress = true, size_t blockSize = DEFAULT_BLOCK_SIZE);
+
+    /**
+     * @brief Encodes one event into the current block.
+     */
+    void write(const EventVariant& event);
+
+    /**
+     * @brief Ends the current block and flushes the file buffer.
+     */
+    void flush();
+
+    /**
+     * @brief Flushes and closes the file.
+     */
+    void close();
+
+    bool isOpen() const { return file_ != nullptr; }
+    uint64_t eventsWritten() const { return eventsWritten_; }
+    uint64_t rawBytes() const { return rawBytes_; }
+    uint64_t storedBytes() const { return storedBytes_; }
+
+private:
+    void finishBlock();
+
+    std::FILE* file_ = nullptr;
+    std::vector<char> fileBuffer_;
+    bool compress_ = true;
+    size_t blockSize_ = DEFAULT_BLOCK_SIZE;
+    std::vector<uint8_t> block_;
+    std::vector<uint8_t> compressed_;
+    uint32_t blockEvents_ = 0;
+    uint64_t lastCycle_ = 0;
+    uint16_t lastPc_ = 0;
+    uint64_t eventsWritten_ = 0;
+    uint64_t rawBytes_ = 0;
+    uint64_t storedBytes_ = 0;
+};
@@ -0,0 +1,61 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @class TripleBuffer
+ * @brief Lock-free single-producer, single-consumer exchange of the latest value.
+ *
+ * The producer fills a private back buffer and publishes it by swapping it
+ * with the shared middle slot; the consumer swaps its front buffer with the
+ * middle slot only when a newer value is there. Neither side ever waits for
+ * the other, and the consumer always sees the newest published value:
+ * values published faster than they are consumed are silently replaced.
+ *
+ * @tparam T Buffered value; copied or written in place by the producer.
+ */
+template <typename T>
+class TripleBuffer {
+public:
+    TripleBuffer() : middle(1), back(0), front(2) {}
+
+    /**
+     * @brief Producer side: the buffer to fill before publish().
+     */
+    T& writeBuffer() { return buffers[back]; }
+
+    /**
+     * @brief Producer side: makes the write buffer the newest value.
+     */
+    void publish() {
+        back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    /**
+     * @brief Consumer side: picks up the newest published value, if any.
+     * @return true if readBuffer() changed since the previous call.
+     */
+    bool update() {
+        if ((middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+            return false;
+        }
+        front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    /**
+     * @brief Consumer side: the value obtained by the last successful update().
+     */
+    const T& readBuffer() const { return buffers[front]; }
+
+private:
+    static constexpr uint8_t INDEX = 0x3;   // Buffer index bits of middle
+    static constexpr uint8_t FRESH = 0x4;   // Set when middle holds an unread value
+
+    // Each side's index lives on its own cache line to avoid false sharing.
+    alignas(64) std::atomic<uint8_t> middle;
+    alignas(64) uint8_t back;
+    alignas(64) uint8_t front;
+    std::array<T, 3> buffers;
+};
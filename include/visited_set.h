@@ -0,0 +1,119 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @class VisitedSet
+ * @brief Fixed-capacity lock-free set of 64-bit state hashes, shared by search threads.
+ *
+ * Open addressing with linear probing over an array of atomic slots: insert()
+ * claims the first empty slot of the hash's probe run with a single
+ * compare-exchange, and lookups never write. There is no lock and no shared
+ * counter, so threads only contend when they insert into the same cache line
+ * at the same moment. Slots only ever go from empty to a hash, so a reader
+ * that sees a hash can trust it.
+ *
+ * Hashes should be well mixed, e.g. Chip8::stateHash(); the value 0 marks an
+ * empty slot and is stored as 1. The table does not grow. Once a probe run
+ * exceeds MAX_PROBES, insert() gives up and reports the state as new, which
+ * costs a repeated visit but never prunes a state wrongly; such inserts are
+ * counted in overflowCount().
+ */
+class VisitedSet {
+public:
+    static constexpr size_t MAX_PROBES = 64;
+
+    /**
+     * @brief Creates an empty set.
+     * @param capacity Requested number of slots; rounded up to a power of two.
+     *                 Keep the load under about 70% for short probe runs.
+     */
+    explicit VisitedSet(size_t capacity) : overflow_(0) {
+        capacity_ = 1;
+        while (capacity_ < capacity) {
+            capacity_ <<= 1;
+        }
+        mask_ = capacity_ - 1;
+        slots_.reset(new std::atomic<uint64_t>[capacity_]);
+        clear();
+    }
+
+    VisitedSet(const VisitedSet&) = delete;
+    VisitedSet& operator=(const VisitedSet&) = delete;
+
+    /**
+     * @brief Adds a hash if it is not already present. Safe to call from any thread.
+     * @return true if the hash was not in the set (or the set is too full to tell).
+     */
+    bool insert(uint64_t hash) {
+        hash = hash != 0 ? hash : 1;
+        size_t index = static_cast<size_t>(hash) & mask_;
+        for (size_t probe = 0; probe < MAX_PROBES; ++probe) {
+            std::atomic<uint64_t>& slot = slots_[(index + probe) & mask_];
+            // Only the hash itself is published, so relaxed ordering suffices
+            uint64_t current = slot.load(std::memory_order_relaxed);
+            if (current == 0 && slot.compare_exchange_strong(current, hash, std::memory_order_relaxed)) {
+                return true;
+            }
+            if (current == hash) {
+                return false;
+            }
+        }
+        overflow_.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Returns whether a hash is in the set. Safe to call from any thread.
+     */
+    bool contains(uint64_t hash) const {
+        hash = hash != 0 ? hash : 1;
+        size_t index = static_cast<size_t>(hash) & mask_;
+        for (size_t probe = 0; probe < MAX_PROBES; ++probe) {
+            uint64_t current = slots_[(index + probe) & mask_].load(std::memory_order_relaxed);
+            if (current == hash) {
+                return true;
+            }
+            if (current == 0) {
+                return false;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Counts the stored hashes by scanning every slot; O(capacity).
+     */
+    size_t size() const {
+        size_t count = 0;
+        for (size_t i = 0; i < capacity_; ++i) {
+            count += slots_[i].load(std::memory_order_relaxed) != 0;
+        }
+        return count;
+    }
+
+    size_t capacity() const { return capacity_; }
+
+    /**
+     * @brief Number of inserts that found no free slot within MAX_PROBES.
+     */
+    uint64_t overflowCount() const { return overflow_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Empties the set. Not safe while other threads use it.
+     */
+    void clear() {
+        for (size_t i = 0; i < capacity_; ++i) {
+            slots_[i].store(0, std::memory_order_relaxed);
+        }
+        overflow_.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+    size_t capacity_;
+    size_t mask_;
+    std::atomic<uint64_t> overflow_;
+};
@@ -0,0 +1,128 @@
+#pragma once
+#include "chip8.h"
+#include "framebuffer.h"
+#include "opcode.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Lockstep statistics reported by VmBank::getStats().
+ */
+struct VmBankStats {
+    uint64_t steps = 0;          // Group steps: one decode shared by every lane in the group
+    uint64_t instructions = 0;   // Lane instructions executed
+    uint64_t vectorLanes = 0;    // Of which executed as SIMD lanes
+    double avgGroupSize = 0;     // instructions / steps; N when fully converged
+};
+
+/**
+ * @class VmBank
+ * @brief N CHIP-8 machines running the same program in lockstep.
+ *
+ * Registers live in structure-of-arrays form, V[register][lane], pc[lane] and
+ * so on, so one instruction applied to many lanes is a loop over contiguous
+ * bytes that the compiler vectorises. Memory and the display stay per lane,
+ * since programs write to both.
+ *
+ * Each step picks the lowest pc among the lanes still running and executes
+ * that instruction for every lane that sits on it with the same opcode. The
+ * ALU instructions 6XNN, 7XNN and 8XYN run as masked SIMD lanes, as do the
+ * other instructions that only touch registers: skips, ANNN, CXNN with each
+ * lane's own generator, and the FX timer and I moves; so do jumps that
+ * cannot be idle loops. Calls, draws, key and memory instructions run lane
+ * by lane after the shared decode. Lanes that diverge, e.g. after a
+ * CXNN-dependent branch, simply fall out of the group; running the lowest
+ * pc first lets lanes that fell behind catch up, and they rejoin as soon as
+ * their pcs line up again.
+ *
+ * Every instruction follows OpcodeHandler exactly, including VF ordering and
+ * idle detection, so a lane's results match a scalar Chip8 run step for
+ * step (see BatchConfig::bankWidth). Event logging is not supported.
+ *
+ * Instantiated for N = 8, 16 and 32 (see VmBank.cpp).
+ *
+ * @tparam N Number of lanes.
+ */
+template <size_t N>
+class VmBank {
+public:
+    static constexpr size_t LANES = N;
+
+    VmBank();
+
+    /**
+     * @brief Resets every lane and loads the same program into each.
+     * @return false if the program does not fit in memory.
+     */
+    bool loadProgram(const uint8_t* data, size_t size);
+
+    /**
+     * @brief Seeds one lane's CXNN generator, as Chip8::seedRandom().
+     */
+    void seedRandom(size_t lane, uint32_t seed);
+
+    /**
+     * @brief Sets one lane's keypad, bit i set while key i is held.
+     */
+    void setKeys(size_t lane, uint16_t keys);
+
+    /**
+     * @brief Runs each lane for up to budgets[lane] instructions.
+     *
+     * Like Chip8::execute(), a lane stops early once it goes idle. Lanes with
+     * a zero budget do not run and keep their idle state.
+     *
+     * @param budgets Instruction budget per lane.
+     * @param executed Receives the number of instructions each lane ran.
+     */
+    void execute(const uint64_t* budgets, uint64_t* executed);
+
+    /**
+     * @brief Advances one lane's delay and sound timers by one 60Hz tick.
+     */
+    void tickTimers(size_t lane);
+
+    uint64_t getCycleCount(size_t lane) const { return cycleCount[lane]; }
+    uint16_t getProgramCounter(size_t lane) const { return pc[lane]; }
+    IdleState getIdleState(size_t lane) const { return idleState[lane]; }
+    const Framebuffer& getFramebuffer(size_t lane) const { return gfx[lane]; }
+    VmBankStats getStats() const;
+
+private:
+    using LaneMask = std::array<uint8_t, N>;   // 0xFF for lanes taking part, 0 otherwise
+
+    // Padded so the lanes' images do not all map to the same cache sets:
+    // a 4 KiB stride would make every lane's fetch of one pc collide.
+    struct LaneMemory {
+        std::array<uint8_t, 4096> bytes;
+        uint8_t padding[64];
+    };
+
+    static bool isVector(const Instruction& inst);
+    void executeVector(const Instruction& inst, const LaneMask& mask);
+    void executeLane(size_t lane, const Instruction& inst);
+    void detectIdleLoop(size_t lane, uint16_t jumpAddress, uint16_t target);
+    void markWritten(uint16_t address, uint16_t length);
+
+    alignas(64) uint8_t V[16][N];
+    alignas(64) uint16_t pc[N];
+    alignas(64) uint16_t I[N];
+    alignas(64) uint16_t sp[N];
+    alignas(64) uint16_t stack[16][N];
+    alignas(64) uint8_t delayTimer[N];
+    alignas(64) uint8_t soundTimer[N];
+    alignas(64) uint32_t rngState[N];
+    alignas(64) uint64_t cycleCount[N];
+    IdleState idleState[N];
+    std::array<uint8_t, 16> key[N];
+    std::vector<LaneMemory> memory;   // One image per lane, on the heap
+    std::vector<Framebuffer> gfx;
+    uint16_t writtenLow;    // Stored-to address range since loadProgram(); outside it
+    uint16_t writtenHigh;   // every lane still holds the program as loaded
+
+    uint64_t steps;
+    uint64_t instructions;
+    uint64_t vectorLanes;
+};
@@ -0,0 +1,362 @@
+#include "aot_compiler.h"
+#include <cstdio>
+#include <iostream>
+#include <numeric>
+
+namespace {
+
+/**
+ * @brief Formats a value as upper-case hex with a 0x prefix.
+ */
+std::string hex(unsigned value, int digits) {
+    char text[8];
+    std::snprintf(text, sizeof(text), "0x%0*X", digits, value);
+    return text;
+}
+
+std::string reg(unsigned index) {
+    return "s.V[" + hex(index & 0x0F, 1) + "]";
+}
+
+// The instructions a block ends at, as in RomAnalysis and OpcodeHandler::decode()
+bool endsBlock(uint16_t opcode) {
+    switch (opcode & 0xF000) {
+        case 0x0000: return (opcode & 0x00FF) == 0xEE;
+        case 0x1000:
+        case 0x2000:
+        case 0x3000:
+        case 0x4000:
+        case 0x5000:
+        case 0x9000:
+        case 0xB000: return true;
+        case 0xE000: return (opcode & 0x00FF) == 0x9E || (opcode & 0x00FF) == 0xA1;
+    }
+    return false;
+}
+
+// Instructions run through their handler: rare, or not worth duplicating
+bool dispatched(uint16_t opcode) {
+    switch (opcode & 0xF000) {
+        case 0x0000: return (opcode & 0x00FF) != 0xE0 && (opcode & 0x00FF) != 0xEE;
+        case 0x8000: return (opcode & 0x000F) > 0x7 && (opcode & 0x000F) != 0xE;
+        case 0xE000: return !endsBlock(opcode);
+        case 0xF000:
+            switch (opcode & 0x00FF) {
+                case 0x07: case 0x15: case 0x18: case 0x1E: case 0x29: case 0x65: return false;
+            }
+            return true;
+    }
+    return false;
+}
+
+} // namespace
+
+/**
+ * @brief Analyzes an image and collects the instructions of each basic block.
+ *
+ * Blocks are cut at their first control transfer, so every compiled
+ * instruction but the last falls through to the next.
+ *
+ * @param rom Program bytes.
+ * @param size Number of bytes.
+ * @return true if the image was compiled.
+ */
+bool AotCompiler::compile(const uint8_t* rom, size_t size) {
+    image.clear();
+    blocks.clear();
+    codeMap.fill(0);
+    if (size == 0) {
+        std::cerr << "Empty ROM; nothing to compile" << std::endl;
+        return false;
+    }
+    if (!analysis.analyze(rom, size)) {
+        return false;
+    }
+    image.assign(rom, rom + size);
+
+    std::vector<bool> entries(MEMORY_SIZE);
+    for (const RomAnalysis::BasicBlock& basic : analysis.getBlocks()) {
+        Block block;
+        block.start = basic.start;
+        for (uint16_t address = basic.start; address < basic.end; address += 2) {
+            if (entries[address]) {
+                // Already compiled from an earlier leader
+                break;
+            }
+            entries[address] = true;
+            uint16_t opcode = word(address);
+            block.opcodes.push_back(opcode);
+            codeMap[address / 8] |= 1u << (address % 8);
+            codeMap[(address + 1) / 8] |= 1u << ((address + 1) % 8);
+            if (endsBlock(opcode)) {
+                break;
+            }
+        }
+        if (!block.opcodes.empty()) {
+            blocks.push_back(std::move(block));
+        }
+    }
+    return true;
+}
+
+size_t AotCompiler::getInstructionCount() const {
+    return std::accumulate(blocks.begin(), blocks.end(), size_t{0},
+                           [](size_t sum, const Block& block) { return sum + block.opcodes.size(); });
+}
+
+size_t AotCompiler::getDispatchCount() const {
+    size_t count = 0;
+    for (const Block& block : blocks) {
+        for (uint16_t opcode : block.opcodes) {
+            count += dispatched(opcode);
+        }
+    }
+    return count;
+}
+
+/**
+ * @brief Writes the translation unit: the image and code map, one function
+ *        per block, the pc switch and the exported AotModuleInfo.
+ *
+ * @param out Destination.
+ * @param romName Name of the ROM, for the header comment.
+ */
+void AotCompiler::writeSource(std::ostream& out, const std::string& romName) const {
+    out << "// Generated by chip8-aot from " << romName << ": " << blocks.size() << " blocks, "
+        << getInstructionCount() << " instructions. Do not edit.\n"
+        << "// Build with the core's headers, e.g.\n"
+        << "//   c++ -std=c++17 -O2 -shared -fPIC -I<chip8>/include <this file> -o <module>.so\n"
+        << "#include \"aot_runtime.h\"\n\n"
+        << "namespace {\n\n";
+
+    out << "const uint8_t image[] = {";
+    for (size_t k = 0; k < image.size(); ++k) {
+        out << (k % 16 == 0 ? "\n    " : " ") << hex(image[k], 2) << ',';
+    }
+    out << "\n};\n\n";
+
+    out << "const uint8_t codeMap[] = {";
+    for (size_t k = 0; k < codeMap.size(); ++k) {
+        out << (k % 16 == 0 ? "\n    " : " ") << hex(codeMap[k], 2) << ',';
+    }
+    out << "\n};\n\n";
+
+    for (const Block& block : blocks) {
+        writeBlock(out, block);
+    }
+
+    out << "uint64_t run(Chip8& chip8, uint64_t maxCycles) {\n"
+        << "    AotContext s(chip8);\n"
+        << "    uint64_t executed = 0;\n"
+        << "    while (executed < maxCycles) {\n"
+        << "        switch (s.pc) {\n";
+    for (const Block& block : blocks) {
+        for (size_t k = 0; k < block.opcodes.size(); ++k) {
+            out << (k % 8 == 0 ? "            " : " ") << "case " << hex(block.start + 2 * k, 4) << ':'
+                << (k % 8 == 7 || k + 1 == block.opcodes.size() ? "\n" : "");
+        }
+        out << "                executed += block_" << hex(block.start, 4) << "(s, maxCycles - executed);\n"
+            << "                break;\n";
+    }
+    out << "            default:\n"
+        << "                return executed;\n"
+        << "        }\n"
+        << "        if (s.idle != IdleState::Running || !s.attached()) {\n"
+        << "            return executed;\n"
+        << "        }\n"
+        << "    }\n"
+        << "    return executed;\n"
+        << "}\n\n"
+        << "} // namespace\n\n"
+        << "const AotModuleInfo chip8_aot_module = {\n"
+        << "    AOT_ABI_VERSION, sizeof(Chip8), image, sizeof(image), codeMap, " << blocks.size() << ", run,\n"
+        << "};\n";
+}
+
+/**
+ * @brief Writes one block as a function entered at any of its instructions.
+ *
+ * Each instruction is a case of a switch on pc and falls through to the
+ * next, counting towards the budget; the block leaves early with pc at the
+ * next instruction when the budget runs out.
+ *
+ * @param out Destination.
+ * @param block The block.
+ */
+void AotCompiler::writeBlock(std::ostream& out, const Block& block) const {
+    size_t count = block.opcodes.size();
+    uint16_t last = static_cast<uint16_t>(block.start + 2 * (count - 1));
+    out << "// " << hex(block.start, 4) << '-' << hex(last, 4) << '\n'
+        << "uint32_t block_" << hex(block.start, 4) << "(AotContext& s, [[maybe_unused]] uint64_t budget) {\n"
+        << "    uint32_t ran = 0;\n"
+        << "    switch (s.pc) {\n";
+    for (size_t k = 0; k < count; ++k) {
+        uint16_t address = static_cast<uint16_t>(block.start + 2 * k);
+        uint16_t opcode = block.opcodes[k];
+        if (k > 0) {
+            out << "            [[fallthrough]];\n";
+        }
+        out << "        case " << hex(address, 4) << ":   // " << RomAnalysis::disassemble(opcode) << '\n';
+        writeInstruction(out, address, opcode);
+        if (k + 1 == count) {
+            if (!endsBlock(opcode)) {
+                out << "            s.pc = " << hex(address + 2, 4) << ";\n";
+            }
+            out << "            return s.finish(" << hex(address, 4) << ", " << hex(opcode, 4) << ", ran + 1);\n";
+        } else {
+            out << "            if (++ran == budget) {\n"
+                << "                return s.leave(" << hex(address + 2, 4) << ", " << hex(opcode, 4) << ", ran);\n"
+                << "            }\n";
+        }
+    }
+    out << "    }\n"
+        << "    return ran;\n"
+        << "}\n\n";
+}
+
+/**
+ * @brief Writes the statements for one instruction, mirroring its handler
+ *        in OpcodeHandler.cpp. pc is only written by control transfers and
+ *        dispatched handlers; straight-line code leaves it to the block exit.
+ *
+ * @param out Destination.
+ * @param address Address of the instruction.
+ * @param opcode The instruction.
+ */
+void AotCompiler::writeInstruction(std::ostream& out, uint16_t address, uint16_t opcode) const {
+    const char* indent = "            ";
+    std::string x = reg(opcode >> 8);
+    std::string y = reg(opcode >> 4);
+    std::string vf = reg(0xF);
+    std::string nn = hex(opcode & 0x00FF, 2);
+    std::string nnn = hex(opcode & 0x0FFF, 3);
+    std::string skip = hex(static_cast<uint16_t>(address + 4), 4) + " : " + hex(static_cast<uint16_t>(address + 2), 4);
+    std::string op = hex(opcode, 4);
+
+    if (dispatched(opcode)) {
+        out << indent << "s.dispatch(" << hex(address, 4) << ", " << op << ");\n";
+        uint16_t low = opcode & 0x00FF;
+        if ((opcode & 0xF000) == 0xF000 && low == 0x0A) {
+            // No key held: pc stays on the FX0A and the machine waits
+            out << indent << "if (s.idle != IdleState::Running) {\n"
+                << indent << "    return s.leave(s.pc, " << op << ", ran + 1);\n"
+                << indent << "}\n";
+        } else if ((opcode & 0xF000) == 0xF000 && (low == 0x33 || low == 0x55)) {
+            // The store overwrote compiled code: finish on the interpreter
+            out << indent << "if (!s.attached()) {\n"
+                << indent << "    return s.leave(s.pc, " << op << ", ran + 1);\n"
+                << indent << "}\n";
+        }
+        return;
+    }
+
+    switch (opcode & 0xF000) {
+        case 0x0000:
+            if ((opcode & 0x00FF) == 0xE0) {
+                out << indent << "s.chip8.gfx.clear();\n"
+                    << indent << "s.chip8.drawFlag = true;\n";
+            } else {
+                out << indent << "s.sp = (s.sp - 1) & 0x0F;\n"
+                    << indent << "s.pc = static_cast<uint16_t>(s.stack[s.sp] + 2);\n";
+            }
+            break;
+        case 0x1000: {
+            uint16_t target = opcode & 0x0FFF;
+            if (target == address) {
+                out << indent << "s.idle = IdleState::Halted;\n";
+            } else if (target + 4 == address) {
+                // The FX07; 3X00; 1NNN poll loop, matched against the compiled bytes it jumps over
+                bool known = compiled(target) && compiled(target + 1) && compiled(target + 2) && compiled(target + 3);
+                if (!known) {
+                    out << indent << "s.dispatch(" << hex(address, 4) << ", " << op << ");\n";
+                    break;
+                }
+                uint8_t vx = word(target) >> 8 & 0x0F;
+                if ((word(target) & 0xF0FF) == 0xF007 && word(target + 2) == (0x3000 | vx << 8)) {
+                    out << indent << "if (s.delayTimer > 0) {\n"
+                        << indent << "    s.idle = IdleState::WaitingForTimer;\n"
+                        << indent << "}\n";
+                }
+            }
+            out << indent << "s.pc = " << nnn << ";\n";
+            break;
+        }
+        case 0x2000:
+            out << indent << "s.stack[s.sp] = " << hex(address, 4) << ";\n"
+                << indent << "s.sp = (s.sp + 1) & 0x0F;\n"
+                << indent << "s.pc = " << nnn << ";\n";
+            break;
+        case 0x3000: out << indent << "s.pc = " << x << " == " << nn << " ? " << skip << ";\n"; break;
+        case 0x4000: out << indent << "s.pc = " << x << " != " << nn << " ? " << skip << ";\n"; break;
+        case 0x5000: out << indent << "s.pc = " << x << " == " << y << " ? " << skip << ";\n"; break;
+        case 0x6000: out << indent << x << " = " << nn << ";\n"; break;
+        case 0x7000: out << indent << x << " += " << nn << ";\n"; break;
+        case 0x8000:
+            switch (opcode & 0x000F) {
+                case 0x0: out << indent << x << " = " << y << ";\n"; break;
+                case 0x1: out << indent << x << " |= " << y << ";\n"; break;
+                case 0x2: out << indent << x << " &= " << y << ";\n"; break;
+                case 0x3: out << indent << x << " ^= " << y << ";\n"; break;
+                case 0x4:
+                    out << indent << "{\n"
+                        << indent << "    uint16_t sum = " << x << " + " << y << ";\n"
+                        << indent << "    " << vf << " = sum > 255 ? 1 : 0;\n"
+                        << indent << "    " << x << " = sum & 0xFF;\n"
+                        << indent << "}\n";
+                    break;
+                case 0x5:
+                    out << indent << vf << " = " << x << " > " << y << " ? 1 : 0;\n"
+                        << indent << x << " -= " << y << ";\n";
+                    break;
+                case 0x6:
+                    out << indent << vf << " = " << x << " & 0x1;\n"
+                        << indent << x << " >>= 1;\n";
+                    break;
+                case 0x7:
+                    out << indent << vf << " = " << y << " > " << x << " ? 1 : 0;\n"
+                        << indent << x << " = " << y << " - " << x << ";\n";
+                    break;
+                case 0xE:
+                    out << indent << vf << " = (" << x << " & 0x80) >> 7;\n"
+                        << indent << x << " <<= 1;\n";
+                    break;
+            }
+            break;
+        case 0x9000: out << indent << "s.pc = " << x << " != " << y << " ? " << skip << ";\n"; break;
+        case 0xA000: out << indent << "s.I = " << nnn << ";\n"; break;
+        case 0xB000: out << indent << "s.pc = static_cast<uint16_t>(" << nnn << " + " << reg(0) << ");\n"; break;
+        case 0xC000: out << indent << x << " = static_cast<uint8_t>(s.random() % 256) & " << nn << ";\n"; break;
+        case 0xD000:
+            out << indent << "{\n"
+                << indent << "    uint8_t x = " << x << ";\n"
+                << indent << "    uint8_t y = " << y << ";\n"
+                << indent << "    bool collision = false;\n";
+            for (unsigned row = 0; row < (opcode & 0x000Fu); ++row) {
+                out << indent << "    collision |= s.chip8.gfx.drawSpriteRow(x, y + " << row
+                    << ", s.memory[(s.I + " << row << ") & 0x0FFF]);\n";
+            }
+            out << indent << "    " << vf << " = collision ? 1 : 0;\n"
+                << indent << "    s.chip8.drawFlag = true;\n"
+                << indent << "}\n";
+            break;
+        case 0xE000: {
+            std::string held = "s.key[" + x + " & 0x0F]";
+            out << indent << "s.pc = " << held << ((opcode & 0x00FF) == 0x9E ? " != 0" : " == 0") << " ? " << skip << ";\n";
+            break;
+        }
+        case 0xF000:
+            switch (opcode & 0x00FF) {
+                case 0x07: out << indent << x << " = s.delayTimer;\n"; break;
+                case 0x15: out << indent << "s.delayTimer = " << x << ";\n"; break;
+                case 0x18: out << indent << "s.soundTimer = " << x << ";\n"; break;
+                case 0x1E: out << indent << "s.I += " << x << ";\n"; break;
+                case 0x29: out << indent << "s.I = " << x << " * 5;\n"; break;
+                case 0x65:
+                    for (unsigned i = 0; i <= ((opcode >> 8) & 0x0Fu); ++i) {
+                        out << indent << reg(i) << " = s.memory[s.I + " << i << "];\n";
+                    }
+                    break;
+            }
+            break;
+    }
+}
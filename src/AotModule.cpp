@@ -0,0 +1,116 @@
+#include "aot_module.h"
+#include "aot_runtime.h"
+#include "opcode.h"
+#include <cstring>
+#include <iostream>
+#include <dlfcn.h>
+
+/**
+ * @brief Runs one instruction for generated code through the untraced handler.
+ *
+ * Out of line so modules link against the executable's handlers rather
+ * than carrying copies of them.
+ *
+ * @param chip8 The machine.
+ * @param op The instruction; pc already holds its address.
+ */
+void AotContext::dispatchOpcode(Chip8& chip8, uint16_t op) {
+    OpcodeHandler<TraceLevel::None>::dispatchOpcode(chip8, op);
+}
+
+/**
+ * @brief Constructs an empty module; load() one before use.
+ */
+AotModule::AotModule() : handle_(nullptr), info_(nullptr) {}
+
+/**
+ * @brief Unloads the shared object. No Chip8 may still have the module attached.
+ */
+AotModule::~AotModule() {
+    if (handle_) {
+        dlclose(handle_);
+    }
+}
+
+/**
+ * @brief Opens a shared object and checks it was generated for this build.
+ *
+ * @param path Path to the shared object.
+ * @return true if the module is ready to attach.
+ */
+bool AotModule::load(const std::string& path) {
+    void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!handle) {
+        std::cerr << "Failed to load AOT module: " << dlerror() << std::endl;
+        return false;
+    }
+    void* symbol = dlsym(handle, "chip8_aot_module");
+    const AotModuleInfo* info = static_cast<const AotModuleInfo*>(symbol);
+    const char* error = nullptr;
+    if (!info) {
+        error = "no chip8_aot_module symbol";
+    } else if (info->abiVersion != AOT_ABI_VERSION) {
+        error = "generated for another interface version";
+    } else if (info->chip8Size != sizeof(Chip8)) {
+        error = "compiled against another chip8.h";
+    }
+    if (error) {
+        std::cerr << "Invalid AOT module " << path << ": " << error << std::endl;
+        dlclose(handle);
+        return false;
+    }
+
+    if (handle_) {
+        dlclose(handle_);
+    }
+    handle_ = handle;
+    info_ = info;
+    path_ = path;
+    return true;
+}
+
+/**
+ * @brief Compares an image with the one the module was compiled from.
+ *
+ * @param rom Program bytes.
+ * @param size Number of bytes.
+ * @return true if they are identical.
+ */
+bool AotModule::matches(const uint8_t* rom, size_t size) const {
+    return info_ && size == info_->imageSize && std::memcmp(rom, info_->image, size) == 0;
+}
+
+/**
+ * @brief Tests a store's target range against the compiled code map.
+ *
+ * @param address First byte written.
+ * @param length Number of bytes written.
+ * @return true if the store overwrites compiled code.
+ */
+bool AotModule::covers(uint16_t address, uint16_t length) const {
+    for (uint16_t i = 0; i < length; ++i) {
+        uint16_t byte = (address + i) & 0x0FFF;
+        if (info_->codeMap[byte / 8] & (1u << (byte % 8))) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Enters the module's generated dispatch loop.
+ *
+ * @param chip8 The machine, with this module attached.
+ * @param maxCycles Instruction budget.
+ * @return uint64_t Instructions retired.
+ */
+uint64_t AotModule::run(Chip8& chip8, uint64_t maxCycles) const {
+    return info_->run(chip8, maxCycles);
+}
+
+/**
+ * @brief Returns the number of basic blocks the module compiled, 0 if none is loaded.
+ */
+uint32_t AotModule::getBlockCount() const {
+    return info_ ? info_->blockCount : 0;
+}
@@ -0,0 +1,272 @@
+#include "batch_runner.h"
+#include "chip8.h"
+#include "event_logger.h"
+#include "thread_pool.h"
+#include "vm_bank.h"
+#include <algorithm>
+#include <chrono>
+#include <map>
+#include <memory>
+
+/**
+ * @brief Constructs a BatchRunner with the given configuration.
+ *
+ * @param config Parameters shared by every instance.
+ */
+BatchRunner::BatchRunner(const BatchConfig& config) : config_(config) {}
+
+/**
+ * @brief Runs every job on the thread pool.
+ *
+ * @param jobs The instances to run.
+ * @return std::vector<BatchResult> One result per job, in job order.
+ */
+std::vector<BatchResult> BatchRunner::run(const std::vector<BatchJob>& jobs) const {
+    // Map each distinct ROM once; instances share the read-only image, and its analysis
+    RomLibrary files;
+    std::map<std::string, const RomLibrary::Rom*> roms;
+    std::map<const RomLibrary::Rom*, const AotModule*> natives;
+    for (const auto& job : jobs) {
+        if (roms.count(job.romPath) == 0) {
+            const RomLibrary::Rom* rom = config_.library ? config_.library->find(job.romPath) : nullptr;
+            if (!rom) {
+                rom = files.addFile(job.romPath);
+            }
+            roms[job.romPath] = rom;
+            if (!rom || natives.count(rom)) {
+                continue;
+            }
+            if (config_.precompile) {
+                rom->analysis();
+            }
+            natives[rom] = nullptr;
+            for (const AotModule* module : config_.aotModules) {
+                if (module->matches(rom->data(), rom->size())) {
+                    natives[rom] = module;
+                    break;
+                }
+            }
+        }
+    }
+
+    std::vector<BatchResult> results(jobs.size());
+    bool banked = !config_.profiler && (config_.bankWidth == 8 || config_.bankWidth == 16 || config_.bankWidth == 32);
+    {
+        ThreadPool pool(config_.threads);
+        // Same-image jobs waiting to fill a bank, in job order
+        std::map<const RomLibrary::Rom*, std::pair<std::vector<const BatchJob*>, std::vector<BatchResult*>>> pending;
+        auto submitBank = [&](const RomLibrary::Rom* image) {
+            auto& bank = pending[image];
+            if (bank.first.empty()) {
+                return;
+            }
+            const RomLibrary::Rom& rom = *image;
+            const BatchConfig& config = config_;
+            pool.submit([&rom, &config, jobs = bank.first, results = bank.second] {
+                switch (config.bankWidth) {
+                    case 8:  runBank<8>(rom, jobs, results, config); break;
+                    case 16: runBank<16>(rom, jobs, results, config); break;
+                    default: runBank<32>(rom, jobs, results, config); break;
+                }
+            });
+            bank.first.clear();
+            bank.second.clear();
+        };
+
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            const BatchJob& job = jobs[i];
+            const RomLibrary::Rom* image = roms[job.romPath];
+            if (!image) {
+                results[i].romPath = job.romPath;
+                results[i].seed = job.seed;
+                continue;
+            }
+            const AotModule* native = natives[image];
+            if (banked && job.trace == TraceLevel::None && !native) {
+                auto& bank = pending[image];
+                bank.first.push_back(&job);
+                bank.second.push_back(&results[i]);
+                if (bank.first.size() == config_.bankWidth) {
+                    submitBank(image);
+                }
+                continue;
+            }
+            const RomLibrary::Rom& rom = *image;
+            const RomAnalysis* shared = config_.precompile ? &rom.analysis() : nullptr;
+            BatchResult& result = results[i];
+            const BatchConfig& config = config_;
+            pool.submit([&rom, &job, &result, &config, shared, native] {
+                result = runInstance(rom, job, config, shared, native);
+            });
+        }
+        for (auto& entry : pending) {
+            submitBank(entry.first);
+        }
+        pool.wait();
+    }
+    return results;
+}
+
+/**
+ * @brief Runs a single instance to completion.
+ *
+ * @param rom ROM image.
+ * @param job The job being run.
+ * @param config Batch configuration.
+ * @param analysis Shared analysis of the ROM to precompile from, or nullptr.
+ * @param aot Module compiled from the ROM to attach, or nullptr.
+ * @return BatchResult The instance outcome.
+ */
+BatchResult BatchRunner::runInstance(const RomLibrary::Rom& rom, const BatchJob& job,
+                                     const BatchConfig& config, const RomAnalysis* analysis,
+                                     const AotModule* aot) {
+    BatchResult result;
+    result.romPath = job.romPath;
+    result.seed = job.seed;
+
+    Chip8 chip8;
+    chip8.setExecutionMode(config.mode);
+    chip8.seedRandom(job.seed);
+    if (job.trace != TraceLevel::None) {
+        chip8.setEventLogger(&EventLogger::createInstance(), job.trace);
+    }
+    std::unique_ptr<Profiler> profiler;
+    if (config.profiler) {
+        profiler = std::make_unique<Profiler>();
+        chip8.setProfiler(profiler.get());
+    }
+    if (!chip8.loadProgram(rom.data(), rom.size())) {
+        return result;
+    }
+    result.loaded = true;
+    chip8.setAotModule(aot);
+    result.native = aot != nullptr;
+
+    auto start = std::chrono::steady_clock::now();
+    if (analysis) {
+        chip8.precompile(*analysis);
+    }
+    uint64_t cyclesPerTick = std::max(1, config.cyclesPerSecond / 60);
+    uint64_t virtualCycles = 0;
+    while (virtualCycles < config.maxCycles) {
+        // Run up to the next timer tick (or the cycle limit, whichever is first)
+        uint64_t sliceEnd = std::min(config.maxCycles, (virtualCycles / cyclesPerTick + 1) * cyclesPerTick);
+        virtualCycles += chip8.execute(sliceEnd - virtualCycles);
+        IdleState idle = chip8.getIdleState();
+        if (idle == IdleState::Halted || idle == IdleState::WaitingForKey) {
+            // Headless instances get no input, so neither can ever resume
+            result.halted = true;
+            break;
+        }
+        if (idle == IdleState::WaitingForTimer) {
+            // Polling the delay timer: skip the idle cycles up to the next tick
+            virtualCycles = sliceEnd;
+        }
+        if (virtualCycles % cyclesPerTick == 0) {
+            chip8.tickTimers();
+            if (profiler) {
+                profiler->recordFrame();
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    if (profiler) {
+        config.profiler->merge(*profiler);
+        if (Profiler::takeDumpRequest()) {
+            config.profiler->dump(config.profilePath);
+        }
+    }
+
+    result.cycles = virtualCycles;
+    result.instructions = chip8.getCycleCount();
+    result.framebufferHash = chip8.gfx.hash();
+    result.stateHash = chip8.stateHash();
+    result.wallMs = std::chrono::duration<double, std::milli>(end - start).count();
+    return result;
+}
+
+/**
+ * @brief Runs up to N jobs on one ROM in a VmBank.
+ *
+ * Each lane keeps its own virtual clock and follows the loop of
+ * runInstance() exactly: the lanes are sliced at their own timer ticks,
+ * finish on their own, and sit out the remaining rounds with a zero budget.
+ *
+ * @param rom ROM image.
+ * @param jobs The jobs, at most N.
+ * @param results Receives one result per job.
+ * @param config Batch configuration.
+ */
+template <size_t N>
+void BatchRunner::runBank(const RomLibrary::Rom& rom, const std::vector<const BatchJob*>& jobs,
+                          const std::vector<BatchResult*>& results, const BatchConfig& config) {
+    size_t lanes = jobs.size();
+    for (size_t l = 0; l < lanes; ++l) {
+        results[l]->romPath = jobs[l]->romPath;
+        results[l]->seed = jobs[l]->seed;
+        results[l]->banked = true;
+    }
+    auto bank = std::make_unique<VmBank<N>>();
+    if (!bank->loadProgram(rom.data(), rom.size())) {
+        return;
+    }
+
+    uint64_t cyclesPerTick = std::max(1, config.cyclesPerSecond / 60);
+    uint64_t virtualCycles[N] = {};
+    uint64_t sliceEnd[N] = {};
+    uint64_t budgets[N] = {};
+    uint64_t executed[N];
+    bool done[N];
+    for (size_t l = 0; l < N; ++l) {
+        done[l] = l >= lanes || config.maxCycles == 0;
+        if (l < lanes) {
+            bank->seedRandom(l, jobs[l]->seed);
+            results[l]->loaded = true;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (;;) {
+        bool any = false;
+        for (size_t l = 0; l < N; ++l) {
+            budgets[l] = 0;
+            if (!done[l]) {
+                sliceEnd[l] = std::min(config.maxCycles, (virtualCycles[l] / cyclesPerTick + 1) * cyclesPerTick);
+                budgets[l] = sliceEnd[l] - virtualCycles[l];
+                any = true;
+            }
+        }
+        if (!any) {
+            break;
+        }
+        bank->execute(budgets, executed);
+        for (size_t l = 0; l < N; ++l) {
+            if (done[l]) {
+                continue;
+            }
+            virtualCycles[l] += executed[l];
+            IdleState idle = bank->getIdleState(l);
+            if (idle == IdleState::Halted || idle == IdleState::WaitingForKey) {
+                results[l]->halted = true;
+                done[l] = true;
+                continue;
+            }
+            if (idle == IdleState::WaitingForTimer) {
+                virtualCycles[l] = sliceEnd[l];
+            }
+            if (virtualCycles[l] % cyclesPerTick == 0) {
+                bank->tickTimers(l);
+            }
+            done[l] = virtualCycles[l] >= config.maxCycles;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    double wallMs = std::chrono::duration<double, std::milli>(end - start).count();
+    for (size_t l = 0; l < lanes; ++l) {
+        results[l]->cycles = virtualCycles[l];
+        results[l]->instructions = bank->getCycleCount(l);
+        results[l]->framebufferHash = bank->getFramebuffer(l).hash();
+        results[l]->wallMs = wallMs / lanes;
+    }
+}
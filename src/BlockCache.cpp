@@ -0,0 +1,158 @@
+#include "block_cache.h"
+
+// Blocks only run with tracing off, so they are built from the untraced handlers.
+using Handlers = OpcodeHandler<TraceLevel::None>;
+
+// Longest byte span a block can cover: MAX_BLOCK_LENGTH instructions plus a fused jump.
+const uint16_t MAX_BLOCK_BYTES = (BlockCache::MAX_BLOCK_LENGTH + 1) * 2;
+
+/**
+ * @brief Constructs an empty cache; blocks are translated on first use.
+ */
+BlockCache::BlockCache() = default;
+
+/**
+ * @brief Checks whether an instruction must terminate a block.
+ *
+ * Control flow ends a block because the following instruction may not run
+ * next; stores end it because they may overwrite the block itself.
+ *
+ * @param handler Decoded handler of the instruction.
+ * @return true if the instruction terminates a block.
+ */
+bool BlockCache::endsBlock(OpHandler handler) {
+    return handler == Handlers::op_00EE || handler == Handlers::op_1NNN ||
+           handler == Handlers::op_2NNN || handler == Handlers::op_BNNN ||
+           handler == Handlers::op_3XNN || handler == Handlers::op_4XNN ||
+           handler == Handlers::op_5XY0 || handler == Handlers::op_9XY0 ||
+           handler == Handlers::op_EX9E || handler == Handlers::op_EXA1 ||
+           handler == Handlers::op_FX0A || handler == Handlers::op_FX33 ||
+           handler == Handlers::op_FX55;
+}
+
+/**
+ * @brief Decodes a block starting at pc and fuses superinstructions.
+ *
+ * @param memory The CHIP-8 memory to translate from.
+ * @param pc Start address (already wrapped to the memory size).
+ * @return std::unique_ptr<Block> The translated block.
+ */
+std::unique_ptr<BlockCache::Block> BlockCache::translate(const PagedMemory& memory, uint16_t pc) {
+    auto block = std::make_unique<Block>();
+    block->start = pc;
+    block->skippableTail = false;
+
+    uint16_t address = pc;
+    while (block->code.size() < MAX_BLOCK_LENGTH && address + 1 < MEMORY_SIZE) {
+        Instruction inst = Handlers::decode(memory.word(address));
+        block->code.push_back(inst);
+        block->strides.push_back(1);
+        block->last = address;
+        address += 2;
+
+        if (endsBlock(inst.handler)) {
+            // A 3XNN;1NNN loop tail is fused into a single terminator
+            if (inst.handler == Handlers::op_3XNN && address + 1 < MEMORY_SIZE) {
+                Instruction next = Handlers::decode(memory.word(address));
+                if (next.handler == Handlers::op_1NNN) {
+                    block->skippableTail = true;
+                    block->code.push_back(next);
+                    block->strides.push_back(1);
+                    block->last = address;
+                    address += 2;
+                }
+            }
+            break;
+        }
+    }
+
+    if (block->code.empty()) {
+        // Last byte of memory: a single instruction wrapping to address 0
+        block->code.push_back(Handlers::decode(memory[address] << 8 | memory[0]));
+        block->strides.push_back(1);
+        block->last = address;
+        address += 2;
+    }
+
+    block->end = address;
+    block->length = static_cast<uint16_t>(block->code.size());
+    fuse(*block);
+    return block;
+}
+
+/**
+ * @brief Replaces known instruction pairs with superinstructions.
+ *
+ * The fused handler takes the first slot of the pair and the stride of that
+ * slot becomes 2; the second slot keeps its decoded operands for the fused
+ * handler to read.
+ *
+ * @param block The block to rewrite in place.
+ */
+void BlockCache::fuse(Block& block) {
+    for (size_t i = 0; i + 1 < block.code.size(); ) {
+        OpHandler first = block.code[i].handler;
+        OpHandler second = block.code[i + 1].handler;
+        OpHandler fused = nullptr;
+
+        if (first == Handlers::op_6XNN && second == Handlers::op_7XNN) {
+            fused = Handlers::op_6XNN_7XNN;
+        } else if (first == Handlers::op_ANNN && second == Handlers::op_DXYN) {
+            fused = Handlers::op_ANNN_DXYN;
+        } else if (first == Handlers::op_3XNN && second == Handlers::op_1NNN) {
+            fused = Handlers::op_3XNN_1NNN;
+        }
+
+        if (fused) {
+            block.code[i].handler = fused;
+            block.strides[i] = 2;
+            i += 2;
+        } else {
+            ++i;
+        }
+    }
+}
+
+/**
+ * @brief Drops every block overlapping a written range.
+ *
+ * Writes to data that was never translated return immediately. Otherwise
+ * only blocks starting within MAX_BLOCK_BYTES before the range can overlap
+ * it, so the scan is bounded regardless of how many blocks exist. Stores
+ * wrap at the end of memory like PagedMemory does, so positions are taken
+ * relative to the wrapped address.
+ *
+ * @param address First written address.
+ * @param length Number of bytes written.
+ */
+void BlockCache::invalidate(uint16_t address, uint16_t length) {
+    address &= MEMORY_SIZE - 1;
+    bool touchesCode = false;
+    for (uint16_t i = 0; i < length && !touchesCode; ++i) {
+        touchesCode = translatedBytes.test((address + i) & (MEMORY_SIZE - 1));
+    }
+    if (!touchesCode) {
+        return;
+    }
+
+    // offset is the block start relative to address; the block covers
+    // offset .. offset + size - 1 and the write covers 0 .. length - 1
+    for (int offset = -MAX_BLOCK_BYTES; offset < length; ++offset) {
+        std::unique_ptr<Block>& block = blocks[(address + offset) & (MEMORY_SIZE - 1)];
+        if (block && offset + (block->end - block->start) > 0) {
+            retired.push_back(std::move(block));
+        }
+    }
+}
+
+/**
+ * @brief Drops every block.
+ */
+void BlockCache::invalidateAll() {
+    for (auto& block : blocks) {
+        if (block) {
+            retired.push_back(std::move(block));
+        }
+    }
+    translatedBytes.reset();
+}
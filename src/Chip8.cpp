@@ -1,16 +1,283 @@
 #include "chip8.h"
-#include <fstream>
+#include "aot_module.h"
 #include <iostream>
-#include <vector>
-#include <opcode.h>
+#include <algorithm>
+#include "opcode.h"
+#include "decode_cache.h"
+#include "block_cache.h"
+#include "chip8_state.h"
+#include "event_logger.h"
+#include "hash.h"
+#include "profiler.h"
+#include "rom_analysis.h"
+#include "rom_library.h"
+#include <cstring>
+
+// Modulus of the minstd generator behind CXNN (2^31 - 1).
+const uint32_t MINSTD_MODULUS = 2147483647u;
 
 /**
  * @brief Constructs a Chip8 instance and initializes the emulator state.
+ *
+ * The instance has no event logger attached; call setEventLogger() to
+ * record execution events. Instructions are predecoded by default.
  */
-Chip8::Chip8() {
+Chip8::Chip8() : rngState(1), eventLogger(nullptr), traceLevel(TraceLevel::None), profiler(nullptr),
+                 aotModule(nullptr), executionMode(ExecutionMode::Predecoded),
+                 decodeCache(std::make_unique<DecodeCache>()), idleState(IdleState::Running) {
     initialize();
 }
 
+/**
+ * @brief Copies a machine's state, sharing its memory pages (see fork()).
+ *
+ * @param parent The machine to copy.
+ */
+Chip8::Chip8(const Chip8& parent)
+    : drawFlag(parent.drawFlag), gfx(parent.gfx), key(parent.key), memory(parent.memory), V(parent.V),
+      stack(parent.stack), I(parent.I), pc(parent.pc), sp(parent.sp), delay_timer(parent.delay_timer),
+      sound_timer(parent.sound_timer), opcode(parent.opcode), cycleCount(parent.cycleCount),
+      rngState(parent.rngState), eventLogger(nullptr), traceLevel(TraceLevel::None), profiler(nullptr),
+      aotModule(parent.aotModule), executionMode(ExecutionMode::Interpret), idleState(parent.idleState) {}
+
+Chip8::~Chip8() = default;
+
+/**
+ * @brief Creates a child machine that continues from this one's current state.
+ *
+ * The child shares every memory page with its parent; either side copies a
+ * page the first time it stores to it, so a fork costs a few hundred bytes
+ * of registers and display no matter how much memory the program uses.
+ * The child keeps its parent's AOT module, if any, and starts in Interpret
+ * mode without an event logger or profiler:
+ * a decode cache is 16 times the size of the memory it covers, so a fresh
+ * one would cost more than the fork saves. Call setExecutionMode() on
+ * long-lived children.
+ *
+ * @return std::unique_ptr<Chip8> The child.
+ */
+std::unique_ptr<Chip8> Chip8::fork() const {
+    return std::unique_ptr<Chip8>(new Chip8(*this));
+}
+
+/**
+ * @brief Selects how instructions are fetched and decoded.
+ *
+ * @param mode The execution mode to use from the next cycle on.
+ */
+void Chip8::setExecutionMode(ExecutionMode mode) {
+    executionMode = mode;
+    if (mode == ExecutionMode::Interpret) {
+        decodeCache.reset();
+    } else if (!decodeCache) {
+        decodeCache = std::make_unique<DecodeCache>();
+    }
+    if (mode != ExecutionMode::Translated) {
+        blockCache.reset();
+    } else if (!blockCache) {
+        blockCache = std::make_unique<BlockCache>();
+    }
+}
+
+/**
+ * @brief Seeds the CXNN random generator.
+ *
+ * Matches std::minstd_rand::seed(): the state is seed mod 2^31-1, with 0
+ * replaced by 1.
+ *
+ * @param seed The seed value.
+ */
+void Chip8::seedRandom(uint32_t seed) {
+    rngState = seed % MINSTD_MODULUS;
+    if (rngState == 0) {
+        rngState = 1;
+    }
+}
+
+/**
+ * @brief Advances the CXNN random generator.
+ *
+ * The generator is minstd (Park-Miller, multiplier 48271), the same sequence
+ * as std::minstd_rand, kept as a plain integer so snapshots can capture it.
+ *
+ * @return uint32_t The next value in [1, 2^31-2].
+ */
+uint32_t Chip8::nextRandom() {
+    rngState = static_cast<uint32_t>(static_cast<uint64_t>(rngState) * 48271u % MINSTD_MODULUS);
+    return rngState;
+}
+
+/**
+ * @brief Returns a hash identifying the machine state, for pruning duplicate states in a search.
+ *
+ * Covers memory, V, I, pc, sp, the stack, both timers, the CXNN generator
+ * and the display; two machines with equal hashes behave identically under
+ * the same input, barring collisions. The cycle counter, the keypad and
+ * configuration are left out. Memory, the only large part, is hashed
+ * incrementally as it is written (see PagedMemory::hash()). The rest is 40
+ * words, each keyed by its position and mixed independently so the
+ * multiplies overlap, which is cheaper than updating a hash on every
+ * register write.
+ *
+ * @return uint64_t The state hash.
+ */
+uint64_t Chip8::stateHash() const {
+    uint64_t words[8];
+    std::memcpy(&words[0], V.data(), 16);
+    std::memcpy(&words[2], stack.data(), 32);
+    words[6] = static_cast<uint64_t>(I) | static_cast<uint64_t>(pc) << 16 | static_cast<uint64_t>(sp) << 32 |
+               static_cast<uint64_t>(delay_timer) << 48 | static_cast<uint64_t>(sound_timer) << 56;
+    words[7] = rngState;
+
+    const uint64_t POSITION_KEY = 0x9e3779b97f4a7c15ULL;
+    uint64_t hash = memory.hash();
+    for (uint64_t i = 0; i < 8; ++i) {
+        hash ^= mix64(words[i] ^ (i + 1) * POSITION_KEY);
+    }
+    const uint64_t* rows = gfx.data();
+    for (uint64_t y = 0; y < Framebuffer::HEIGHT; ++y) {
+        hash ^= mix64(rows[y] ^ (y + 9) * POSITION_KEY);
+    }
+    return hash;
+}
+
+/**
+ * @brief Captures the complete machine state.
+ *
+ * @param state Receives the snapshot; its header is left as constructed.
+ */
+void Chip8::saveState(Chip8State& state) const {
+    memory.copyTo(state.memory.data());
+    std::memcpy(state.display.data(), gfx.data(), sizeof(state.display));
+    state.stack = stack;
+    state.V = V;
+    state.key = key;
+    state.cycleCount = cycleCount;
+    state.rngState = rngState;
+    state.I = I;
+    state.pc = pc;
+    state.sp = sp;
+    state.opcode = opcode;
+    state.delayTimer = delay_timer;
+    state.soundTimer = sound_timer;
+    state.drawFlag = drawFlag ? 1 : 0;
+}
+
+/**
+ * @brief Restores a snapshot taken with saveState().
+ *
+ * Memory is compared in chunks and only chunks that differ are copied and
+ * have their cached decodes dropped, so rolling back to a recent snapshot
+ * of the same program keeps the decode and block caches warm, and pages
+ * shared with forks stay shared unless they changed. The display
+ * marks the rows that changed as dirty.
+ *
+ * Snapshots may come from files, so the fields the core indexes with are
+ * checked too: a stack pointer past the 16 entries is rejected, and a
+ * random state outside minstd's range is folded into it as seedRandom()
+ * does, since a zero state would make CXNN return 0 forever.
+ *
+ * @param state The snapshot to restore.
+ * @return bool False (and nothing changed) if the snapshot header is invalid
+ *              or its stack pointer is out of range.
+ */
+bool Chip8::loadState(const Chip8State& state) {
+    if (!state.valid() || state.sp >= stack.size()) {
+        return false;
+    }
+    const size_t CHUNK = 64;
+    for (size_t page = 0; page < PagedMemory::PAGE_COUNT; ++page) {
+        const uint8_t* current = memory.pageData(page);
+        const uint8_t* saved = &state.memory[page * PagedMemory::PAGE_SIZE];
+        if (std::memcmp(current, saved, PagedMemory::PAGE_SIZE) == 0) {
+            continue;
+        }
+        for (size_t offset = 0; offset < PagedMemory::PAGE_SIZE; offset += CHUNK) {
+            if (std::memcmp(current + offset, saved + offset, CHUNK) != 0) {
+                uint16_t address = static_cast<uint16_t>(page * PagedMemory::PAGE_SIZE + offset);
+                memory.store(address, saved + offset, CHUNK);
+                current = memory.pageData(page);   // The store may have replaced a shared page
+                invalidateCode(address, CHUNK);
+            }
+        }
+    }
+    gfx.setRows(state.display.data());
+    stack = state.stack;
+    V = state.V;
+    key = state.key;
+    cycleCount = state.cycleCount;
+    seedRandom(state.rngState);
+    I = state.I;
+    pc = state.pc;
+    sp = state.sp;
+    opcode = state.opcode;
+    delay_timer = state.delayTimer;
+    sound_timer = state.soundTimer;
+    drawFlag = state.drawFlag != 0;
+    idleState = IdleState::Running;
+    if (profiler) {
+        profiler->resetCallStack();
+    }
+    return true;
+}
+
+/**
+ * @brief Attaches an event logger and selects what is reported to it.
+ *
+ * @param logger The logger, or nullptr to stop logging.
+ * @param level Trace level to use while a logger is attached.
+ */
+void Chip8::setEventLogger(EventLogger* logger, TraceLevel level) {
+    eventLogger = logger;
+    setTraceLevel(level);
+}
+
+/**
+ * @brief Switches to the handlers compiled for another trace level.
+ *
+ * Without a logger attached the level stays at TraceLevel::None. Cached
+ * decodes point at handlers of the previous level and are dropped. Blocks
+ * are left alone: Translated mode only runs them at TraceLevel::None and
+ * single-steps otherwise.
+ *
+ * @param level The trace level to use from the next cycle on.
+ */
+void Chip8::setTraceLevel(TraceLevel level) {
+    if (!eventLogger) {
+        level = TraceLevel::None;
+    }
+    if (level == traceLevel) {
+        return;
+    }
+    traceLevel = level;
+    if (decodeCache) {
+        decodeCache->invalidateAll();
+    }
+}
+
+/**
+ * @brief Discards cached decodes that cover a range of written memory.
+ *
+ * Must be called after every store to memory so self-modifying programs
+ * execute their new code. A store into code the attached AOT module
+ * compiled detaches the module.
+ *
+ * @param address First written address.
+ * @param length Number of bytes written.
+ */
+void Chip8::invalidateCode(uint16_t address, uint16_t length) {
+    if (aotModule && aotModule->covers(address, length)) {
+        // Self-modifying code: the native blocks no longer match memory
+        aotModule = nullptr;
+    }
+    if (decodeCache) {
+        decodeCache->invalidate(address, length);
+    }
+    if (blockCache) {
+        blockCache->invalidate(address, length);
+    }
+}
+
 /**
  * @brief Initializes the CHIP-8 system state.
  *
@@ -19,17 +286,19 @@ Chip8::Chip8() {
 void Chip8::initialize() {
     pc = 0x200; // Program counter starts at 0x200
     opcode = 0;
+    cycleCount = 0;
     I = 0;
     sp = 0;
 
-    // Clear display
-    gfx.fill(0);
+    // Clear display and keypad
+    gfx.clear();
+    key.fill(0);
     drawFlag = false;
 
     // Clear stack, registers, and memory
     stack.fill(0);
     V.fill(0);
-    memory.fill(0);
+    memory.clear();
 
     // Reset timers
     delay_timer = 0;
@@ -57,66 +326,270 @@ void Chip8::initialize() {
     };
 
     // Chip8 standard loads fontset into memory starting at 0x00
-    for(int i = 0; i < 80; ++i) {
-        memory[i] = chip8_fontset[i];
-    }
+    memory.store(0, chip8_fontset, sizeof(chip8_fontset));
 }
 
 /**
  * @brief Loads a CHIP-8 ROM into memory.
  *
- * Loads the ROM file contents into memory starting at 0x200.
- * Prints status messages on success or failure.
+ * Maps the file (see RomLibrary), which validates its size, and copies it
+ * into memory starting at 0x200. Prints status messages on success or
+ * failure.
  *
  * @param filename Path to the ROM file.
  */
 void Chip8::loadRom(const char* filename) {
-    
-    std::ifstream rom(filename, std::ios::binary | std::ios::ate);
-    
-    if (!rom.is_open()) {
-        std::cerr << "Failed to open ROM: " << filename << std::endl;
-        return;
+    RomLibrary library;
+    const RomLibrary::Rom* rom = library.addFile(filename);
+    if (rom && loadProgram(rom->data(), rom->size())) {
+        std::cout << "Loaded ROM: " << filename << " (" << rom->size() << " bytes)" << std::endl;
     }
+}
 
-    std::streamsize size = rom.tellg();
-    rom.seekg(0, std::ios::beg);
+/**
+ * @brief Copies a program image into memory starting at 0x200.
+ *
+ * Used by loadRom() and by callers that already hold the ROM in memory,
+ * such as the headless batch runner. Detaches any AOT module; attach the
+ * one compiled from this image afterwards.
+ *
+ * @param data Program bytes.
+ * @param size Number of bytes.
+ * @return true if the program fits in memory and was loaded, false otherwise.
+ */
+bool Chip8::loadProgram(const uint8_t* data, size_t size) {
+    if (size > memory.size() - 0x200) {
+        return false;
+    }
+    memory.store(0x200, data, size);
+    aotModule = nullptr;
+    if (decodeCache) {
+        decodeCache->invalidateAll();
+    }
+    if (blockCache) {
+        blockCache->invalidateAll();
+    }
+    return true;
+}
 
+/**
+ * @brief Fills the decode and block caches for the code a RomAnalysis found.
+ *
+ * Every instruction of every basic block is decoded, and in Translated
+ * mode each block is translated from its leader on, so the first pass over
+ * the program runs from the caches instead of discovering them. Call it
+ * after loading the analyzed image. Entries are built from the current
+ * memory, so a stale analysis only costs unused entries, never wrong code.
+ * Does nothing in Interpret mode.
+ *
+ * @param analysis Analysis of the loaded program.
+ */
+void Chip8::precompile(const RomAnalysis& analysis) {
+    if (executionMode == ExecutionMode::Interpret) {
+        return;
+    }
+    for (const RomAnalysis::BasicBlock& block : analysis.getBlocks()) {
+        for (uint16_t address = block.start; address < block.end; address += 2) {
+            switch (traceLevel) {
+                case TraceLevel::None:    decodeCache->fetch<TraceLevel::None>(memory, address); break;
+                case TraceLevel::Opcodes: decodeCache->fetch<TraceLevel::Opcodes>(memory, address); break;
+                case TraceLevel::Full:    decodeCache->fetch<TraceLevel::Full>(memory, address); break;
+            }
+        }
+        if (blockCache) {
+            // Stores and the length limit end translated blocks early; execution resumes after them
+            for (uint16_t address = block.start; address < block.end; ) {
+                address = blockCache->lookup(memory, address).end;
+            }
+        }
+    }
+}
 
-    std::vector<char> buffer(size);
+/**
+ * @brief Executes one emulation cycle.
+ *
+ * Fetches, decodes, and executes the next opcode. Outside Interpret mode the
+ * decode comes from the DecodeCache. Timers are not touched here; they run
+ * on their own 60Hz timebase (see tickTimers()).
+ */
+void Chip8::emulateCycle() {
+    if (profiler) {
+        switch (traceLevel) {
+            case TraceLevel::None:    step<TraceLevel::None, true>(); break;
+            case TraceLevel::Opcodes: step<TraceLevel::Opcodes, true>(); break;
+            case TraceLevel::Full:    step<TraceLevel::Full, true>(); break;
+        }
+        return;
+    }
+    switch (traceLevel) {
+        case TraceLevel::None:    step<TraceLevel::None>(); break;
+        case TraceLevel::Opcodes: step<TraceLevel::Opcodes>(); break;
+        case TraceLevel::Full:    step<TraceLevel::Full>(); break;
+    }
+}
 
-    if (rom.read(buffer.data(), size)) {
-        for(size_t i = 0; i < buffer.size(); ++i) {
-            memory[0x200 + i] = static_cast<uint8_t>(buffer[i]);
+/**
+ * @brief Executes one instruction with the handlers of trace level L.
+ *
+ * The Profiled instantiation also reports the instruction to the attached
+ * profiler, timing it when a sample is due; the other one has no profiler
+ * code at all.
+ */
+template <TraceLevel L, bool Profiled>
+void Chip8::step() {
+    if constexpr (Profiled) {
+        uint16_t address = pc;
+        if (profiler->sampleDue()) {
+            uint64_t start = Profiler::now();
+            runInstruction<L>();
+            profiler->recordSample(opcode, Profiler::now() - start);
+        } else {
+            runInstruction<L>();
         }
-        std::cout << "Loaded ROM: " << filename << " (" << size << " bytes)" << std::endl;
+        profiler->recordInstruction(address, opcode);
     } else {
-        std::cerr << "Failed to read ROM data." << std::endl;
+        runInstruction<L>();
     }
+}
+
+/**
+ * @brief Fetches, decodes and executes one instruction with the handlers of trace level L.
+ */
+template <TraceLevel L>
+void Chip8::runInstruction() {
+    if (executionMode != ExecutionMode::Interpret) {
+        // Copy the entry: the handler may invalidate its own cache slot
+        Instruction inst = decodeCache->fetch<L>(memory, pc);
+        opcode = inst.opcode;
+        if constexpr (L != TraceLevel::None) eventLogger->log(OpcodeEvent(cycleCount, pc, opcode));
+        inst.handler(*this, inst);
+    } else {
+        // Fetch Opcode
+        opcode = memory.word(pc);
 
-    rom.close();
+        // Decode and Execute Opcode
+        OpcodeHandler<L>::dispatchOpcode(*this, opcode);
+    }
+    ++cycleCount;
 }
 
 /**
- * @brief Executes one emulation cycle.
+ * @brief Single-steps up to maxCycles instructions, stopping when the core goes idle.
  *
- * Fetches, decodes, and executes the next opcode. Updates timers and handles sound.
+ * @param maxCycles Instruction budget.
+ * @return uint64_t Number of instructions executed.
  */
-void Chip8::emulateCycle() {
-    // Fetch Opcode
-    opcode = memory[pc] << 8 | memory[pc + 1];
-    
-    // Decode and Execute Opcode
-    OpcodeHandler::dispatchOpcode(*this, opcode);
+template <TraceLevel L, bool Profiled>
+uint64_t Chip8::stepUntilIdle(uint64_t maxCycles) {
+    uint64_t executed = 0;
+    while (executed < maxCycles) {
+        uint16_t pcBefore = pc;
+        step<L, Profiled>();
+        ++executed;
+        if (idleState != IdleState::Running || pc == pcBefore) {
+            if (idleState == IdleState::Running) {
+                idleState = IdleState::Halted;
+            }
+            break;
+        }
+    }
+    return executed;
+}
+
+/**
+ * @brief Executes up to maxCycles instructions.
+ *
+ * With an AOT module attached (see setAotModule()), its native code runs
+ * first, for as long as pc stays in code it compiled. In Translated mode
+ * whole blocks are run while they fit in the remaining budget, and the tail
+ * is single-stepped so the budget is met exactly. While tracing every
+ * instruction is single-stepped so each one is still logged. Execution
+ * stops early when the core goes idle (see getIdleState()): waiting for a
+ * key, polling the delay timer, or stuck on an instruction that leaves pc
+ * unchanged. Nothing can change until input arrives or a timer ticks, so
+ * callers can skip the rest of their budget.
+ *
+ * @param maxCycles Instruction budget.
+ * @return uint64_t Number of instructions executed.
+ */
+uint64_t Chip8::execute(uint64_t maxCycles) {
+    uint64_t executed = 0;
+    idleState = IdleState::Running;
 
-    // Update timers
+    if (aotModule && traceLevel == TraceLevel::None && !profiler) {
+        executed = aotModule->run(*this, maxCycles);
+        cycleCount += executed;
+        if (idleState != IdleState::Running || executed == maxCycles) {
+            return executed;
+        }
+    }
+
+    if (executionMode == ExecutionMode::Translated && traceLevel == TraceLevel::None) {
+        blockCache->releaseRetired();
+        while (executed < maxCycles) {
+            const BlockCache::Block& block = blockCache->lookup(memory, pc);
+            if (block.length > maxCycles - executed) {
+                break;
+            }
+
+            const Instruction* code = block.code.data();
+            const uint8_t* strides = block.strides.data();
+            size_t size = block.code.size();
+            uint16_t last = block.last;
+            bool sampled = profiler && profiler->sampleDue(block.length);
+            uint64_t started = sampled ? Profiler::now() : 0;
+            for (size_t i = 0; i < size; i += strides[i]) {
+                code[i].handler(*this, code[i]);
+            }
+            // A taken 3XNN skips the fused jump, so one fewer instruction ran
+            uint16_t ran = block.length;
+            opcode = code[size - 1].opcode;
+            if (block.skippableTail && V[code[size - 2].x] == code[size - 2].nn) {
+                --ran;
+                opcode = code[size - 2].opcode;
+            }
+            executed += ran;
+            cycleCount += ran;
+            if (profiler) {
+                profiler->recordBlock(block.start, code, ran, sampled ? std::max<uint64_t>(Profiler::now() - started, 1) : 0);
+            }
+
+            if (idleState != IdleState::Running || (pc & 0x0FFF) == last) {
+                if (idleState == IdleState::Running) {
+                    idleState = IdleState::Halted;
+                }
+                return executed;
+            }
+        }
+    }
+
+    if (profiler) {
+        switch (traceLevel) {
+            case TraceLevel::None:    return executed + stepUntilIdle<TraceLevel::None, true>(maxCycles - executed);
+            case TraceLevel::Opcodes: return executed + stepUntilIdle<TraceLevel::Opcodes, true>(maxCycles - executed);
+            case TraceLevel::Full:    return executed + stepUntilIdle<TraceLevel::Full, true>(maxCycles - executed);
+        }
+    }
+    switch (traceLevel) {
+        case TraceLevel::None:    return executed + stepUntilIdle<TraceLevel::None>(maxCycles - executed);
+        case TraceLevel::Opcodes: return executed + stepUntilIdle<TraceLevel::Opcodes>(maxCycles - executed);
+        case TraceLevel::Full:    return executed + stepUntilIdle<TraceLevel::Full>(maxCycles - executed);
+    }
+    return executed;
+}
+
+/**
+ * @brief Advances the delay and sound timers by one 60Hz tick.
+ *
+ * Called by the Scheduler once per timer period, independently of how many
+ * instructions were executed in between. Sound output is left to the
+ * frontend (see getSoundTimer()).
+ */
+void Chip8::tickTimers() {
     if (delay_timer > 0) {
         --delay_timer;
     }
     if (sound_timer > 0) {
         --sound_timer;
-        if (sound_timer == 1) {
-            std::cout << "BEEP!" << std::endl; // Placeholder for sound
-        }
     }
-}
\ No newline at end of file
+}
@@ -1,8 +1,11 @@
 #include "chip8renderer.h"
+#include "pixel_convert.h"
 
 const int VIDEO_SCALE = 10;
 const int VIDEO_WIDTH = 64;
 const int VIDEO_HEIGHT = 32;
+const uint32_t PIXEL_ON = 0xFFFFFFFF;   // White
+const uint32_t PIXEL_OFF = 0x000000FF;  // Black
 
 /**
  * @brief Initializes the SDL3 renderer, window, and texture for CHIP-8 display.
@@ -44,22 +47,57 @@ int Chip8Renderer::initialize(){
         SDL_Quit();
         return 1;
     }
+    return 0;
 }
 
 /**
- * @brief Renders the CHIP-8 video buffer to the SDL window.
+ * @brief Enables or disables waiting for the display refresh on present.
  *
- * Converts the CHIP-8 video buffer to pixel data and updates the SDL texture and window.
+ * @param enabled True to synchronise presents with the display refresh.
+ * @return bool True if the renderer accepted the setting.
+ */
+bool Chip8Renderer::setVSync(bool enabled){
+    if (!SDL_SetRenderVSync(renderer, enabled ? 1 : 0)) {
+        std::cerr << "Failed to set vsync: " << SDL_GetError() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Renders the CHIP-8 framebuffer to the SDL window.
+ *
+ * Locks the band of the streaming texture spanning the dirty rows and
+ * expands those rows straight into it, so no intermediate pixel buffer is
+ * built and unchanged rows are neither converted nor uploaded. A locked
+ * region is write-only, so every row inside the band is rewritten, not
+ * only the dirty ones.
  *
- * @param videoBuffer Pointer to the CHIP-8 video buffer (size: 64x32).
+ * @param framebuffer The CHIP-8 display.
+ * @param dirtyRows Rows changed since the previous call (bit y = row y).
  */
-void Chip8Renderer::render(const uint8_t* videoBuffer){
-    uint32_t pixels[VIDEO_WIDTH * VIDEO_HEIGHT];
-    for (int i = 0; i < VIDEO_WIDTH * VIDEO_HEIGHT; ++i) {
-        pixels[i] = videoBuffer[i] ? 0xFFFFFFFF : 0x000000FF; // White or Black
+void Chip8Renderer::render(const Framebuffer& framebuffer, uint32_t dirtyRows){
+    if (dirtyRows != 0) {
+        int first = 0;
+        while (!(dirtyRows & (1u << first))) {
+            ++first;
+        }
+        int last = VIDEO_HEIGHT - 1;
+        while (!(dirtyRows & (1u << last))) {
+            --last;
+        }
+
+        SDL_Rect band = {0, first, VIDEO_WIDTH, last - first + 1};
+        void* pixels = nullptr;
+        int pitch = 0;
+        if (SDL_LockTexture(texture, &band, &pixels, &pitch)) {
+            expandRows(framebuffer.data() + first, band.h, pixels, pitch, PIXEL_ON, PIXEL_OFF);
+            SDL_UnlockTexture(texture);
+        } else {
+            std::cerr << "Failed to lock SDL texture: " << SDL_GetError() << std::endl;
+        }
     }
 
-    SDL_UpdateTexture(texture, nullptr, pixels, VIDEO_WIDTH * sizeof(uint32_t));
     SDL_RenderTexture(renderer, texture, nullptr, nullptr);
     SDL_RenderPresent(renderer);
 }
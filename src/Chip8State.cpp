@@ -0,0 +1,86 @@
+#include "chip8_state.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+/**
+ * @brief Copies the snapshot into a caller-provided buffer.
+ *
+ * @param out Destination buffer.
+ * @param capacity Size of out in bytes.
+ * @return size_t Bytes written, or 0 if the buffer is too small.
+ */
+size_t Chip8State::serialize(uint8_t* out, size_t capacity) const {
+    if (capacity < sizeof(Chip8State)) {
+        return 0;
+    }
+    std::memcpy(out, this, sizeof(Chip8State));
+    return sizeof(Chip8State);
+}
+
+/**
+ * @brief Replaces the snapshot with one read from a buffer.
+ *
+ * The header is checked before anything is copied, so a rejected buffer
+ * leaves the snapshot unchanged. The header's default member initializers
+ * make the struct non-trivial but not non-trivially-copyable (see the
+ * static_assert in chip8_state.h), so a raw copy over it is well defined.
+ *
+ * @param in Serialized snapshot.
+ * @param length Number of bytes available at in.
+ * @return bool False if the buffer is too short or the header does not match.
+ */
+bool Chip8State::deserialize(const uint8_t* in, size_t length) {
+    if (length < sizeof(Chip8State)) {
+        return false;
+    }
+    Chip8State header;
+    std::memcpy(static_cast<void*>(&header), in, offsetof(Chip8State, memory));
+    if (!header.valid()) {
+        return false;
+    }
+    std::memcpy(static_cast<void*>(this), in, sizeof(Chip8State));
+    return true;
+}
+
+/**
+ * @brief Writes the snapshot to a file.
+ *
+ * @param path Output file.
+ * @return bool False if the file could not be written.
+ */
+bool Chip8State::saveToFile(const std::string& path) const {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        std::cerr << "Failed to create state file: " << path << std::endl;
+        return false;
+    }
+    bool ok = std::fwrite(this, sizeof(Chip8State), 1, file) == 1;
+    ok = std::fclose(file) == 0 && ok;
+    if (!ok) {
+        std::cerr << "Failed to write state file: " << path << std::endl;
+    }
+    return ok;
+}
+
+/**
+ * @brief Replaces the snapshot with one read from a file.
+ *
+ * @param path Snapshot file written by saveToFile().
+ * @return bool False if the file is missing, short, or not a supported snapshot.
+ */
+bool Chip8State::loadFromFile(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        std::cerr << "Failed to open state file: " << path << std::endl;
+        return false;
+    }
+    alignas(Chip8State) uint8_t buffer[sizeof(Chip8State)];
+    size_t length = std::fread(buffer, 1, sizeof(buffer), file);
+    std::fclose(file);
+    if (!deserialize(buffer, length)) {
+        std::cerr << "Not a supported CHIP-8 state file: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
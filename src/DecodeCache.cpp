@@ -0,0 +1,32 @@
+#include "decode_cache.h"
+
+/**
+ * @brief Constructs an empty cache; every entry decodes on first use.
+ */
+DecodeCache::DecodeCache() {
+    invalidateAll();
+}
+
+/**
+ * @brief Drops the entries whose opcode bytes overlap a written range.
+ *
+ * An instruction at address A covers bytes A and A+1, so the entry just
+ * before the range is dropped as well.
+ *
+ * @param address First written address.
+ * @param length Number of bytes written.
+ */
+void DecodeCache::invalidate(uint16_t address, uint16_t length) {
+    for (uint32_t i = 0; i <= length; ++i) {
+        entries[(address + MEMORY_SIZE - 1 + i) & (MEMORY_SIZE - 1)].handler = nullptr;
+    }
+}
+
+/**
+ * @brief Drops every entry.
+ */
+void DecodeCache::invalidateAll() {
+    for (auto& entry : entries) {
+        entry.handler = nullptr;
+    }
+}
@@ -1,4 +1,25 @@
 #include "event.h"
+#include <sstream>
+
+/**
+ * @brief Returns the name used for an event type in logs.
+ *
+ * @param type The event type.
+ * @return const char* The type name, e.g. "OpcodeEvent".
+ */
+const char* eventTypeName(EventType type) {
+    switch (type) {
+        case EventType::Stack: return "StackEvent";
+        case EventType::Opcode: return "OpcodeEvent";
+        case EventType::Register: return "RegisterEvent";
+        case EventType::Memory: return "MemoryEvent";
+        case EventType::Input: return "InputEvent";
+        case EventType::Timer: return "TimerEvent";
+        case EventType::Draw: return "DrawEvent";
+        case EventType::FramebufferCleared: return "FramebufferClearedEvent";
+    }
+    return "UnknownEvent";
+}
 
 /**
  * @brief Serializes an EventVariant to a JSON-like string.
@@ -14,44 +35,54 @@ std::string serializeEvent(const EventVariant& ev) {
     std::visit([&oss](auto&& arg) {
         using T = std::decay_t<decltype(arg)>;
 
-        oss << "{ \"type\": \"" << arg.type << "\", ";
-        // Serialize timestamp as milliseconds since epoch
-        auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(arg.timestamp.time_since_epoch()).count();
-        oss << "\"timestamp\": " << ms << ", ";
+        oss << "{ \"type\": \"" << eventTypeName(arg.type) << "\", ";
+        oss << "\"cycle\": " << arg.cycle;
 
         if constexpr (std::is_same_v<T, StackEvent>) {
-            oss << "\"pc\": " << arg.pc << ", \"target\": " << arg.target << ", \"stack\": [";
+            oss << ", \"pc\": " << arg.pc << ", \"target\": " << arg.target << ", \"stack\": [";
             for (size_t i = 0; i < arg.stack.size(); ++i) {
                 oss << arg.stack[i];
                 if (i + 1 < arg.stack.size()) oss << ", ";
             }
-            oss << "]";
+            oss << "], \"sp\": " << static_cast<int>(arg.depth);
         } else if constexpr (std::is_same_v<T, OpcodeEvent>) {
-            oss << "\"pc\": " << arg.pc << ", \"opcode\": " << arg.opcode;
+            oss << ", \"pc\": " << arg.pc << ", \"opcode\": " << arg.opcode;
         } else if constexpr (std::is_same_v<T, RegisterEvent>) {
-            oss << "\"changes\": {";
+            oss << ", \"changes\": {";
             bool first = true;
-            for (auto& [reg, val] : arg.changes) {
+            for (int reg = 0; reg < 16; ++reg) {
+                if (!(arg.mask & (1u << reg))) continue;
                 if (!first) oss << ", ";
-                oss << "\"V" << reg << "\": " << val;
+                oss << "\"V" << reg << "\": " << static_cast<int>(arg.values[reg]);
                 first = false;
             }
             oss << "}";
         } else if constexpr (std::is_same_v<T, MemoryEvent>) {
-            oss << "\"memoryDiff\": {";
-            bool first = true;
-            for (auto& [addr, val] : arg.memoryDiff) {
-                if (!first) oss << ", ";
-                oss << "\"0x" << std::hex << addr << "\": " << std::dec << val;
-                first = false;
+            oss << ", \"memoryDiff\": {";
+            for (int i = 0; i < arg.length; ++i) {
+                if (i > 0) oss << ", ";
+                oss << "\"0x" << std::hex << (arg.address + i) << "\": " << std::dec
+                    << static_cast<int>(arg.values[i]);
             }
             oss << "}";
         } else if constexpr (std::is_same_v<T, InputEvent>) {
-            oss << "\"key\": " << arg.key << ", \"pressed\": " << (arg.pressed ? "true" : "false");
+            oss << ", \"key\": " << static_cast<int>(arg.key) << ", \"pressed\": " << (arg.pressed ? "true" : "false");
+        } else if constexpr (std::is_same_v<T, TimerEvent>) {
+            oss << ", \"timer\": \"" << (arg.sound ? "sound" : "delay") << "\", \"value\": "
+                << static_cast<int>(arg.value);
+        } else if constexpr (std::is_same_v<T, DrawEvent>) {
+            oss << ", \"x\": " << static_cast<int>(arg.x) << ", \"y\": " << static_cast<int>(arg.y)
+                << ", \"address\": " << arg.address << ", \"collision\": " << (arg.collision ? "true" : "false")
+                << ", \"sprite\": [";
+            for (int i = 0; i < arg.height; ++i) {
+                if (i > 0) oss << ", ";
+                oss << static_cast<int>(arg.sprite[i]);
+            }
+            oss << "]";
         }
 
         oss << " }";
     }, ev);
 
     return oss.str();
-}
\ No newline at end of file
+}
@@ -0,0 +1,94 @@
+#include "frame_pacer.h"
+#include <algorithm>
+
+// How early a capped present may start, to absorb jitter in the emulation frame clock.
+const std::chrono::milliseconds PRESENT_SLACK(2);
+
+// A present starting this long after it was due counts as a missed deadline.
+const std::chrono::microseconds MISSED_DEADLINE_LATENESS(8333);
+
+/**
+ * @brief Constructs a pacer with the given present cap and no frame skipping.
+ *
+ * @param maxPresentHz Maximum presents per second, or 0 for no cap.
+ */
+FramePacer::FramePacer(double maxPresentHz)
+    : interval(Clock::duration::zero()), maxFrameSkip(DEFAULT_MAX_FRAME_SKIP), consecutiveSkips(0),
+      pending(false), intervalSumMs(0.0), presentSumMs(0.0) {
+    setMaxPresentHz(maxPresentHz);
+}
+
+/**
+ * @brief Caps the present rate.
+ *
+ * @param hz Maximum presents per second, or 0 for no cap.
+ */
+void FramePacer::setMaxPresentHz(double hz) {
+    interval = hz > 0.0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / hz))
+                        : Clock::duration::zero();
+}
+
+/**
+ * @brief Decides whether the current emulated frame is presented.
+ *
+ * Nothing is presented until the display changes. A pending change is
+ * deferred while the cap interval has not elapsed since the previous
+ * present, and dropped (up to maxFrameSkip frames in a row) while emulation
+ * is behind, so the CPU can catch up instead of waiting on the display.
+ *
+ * @param changed True if the display changed during the frame.
+ * @param behind True if emulation missed its frame deadline.
+ * @return true if the caller should render and present now.
+ */
+bool FramePacer::shouldPresent(bool changed, bool behind) {
+    Clock::time_point now = Clock::now();
+    if (changed && !pending) {
+        pending = true;
+        pendingSince = now;
+    }
+    if (!pending) {
+        return false;
+    }
+
+    if (stats.presented > 0 && now + PRESENT_SLACK < lastPresent + interval) {
+        ++stats.deferred;
+        return false;
+    }
+    if (behind && consecutiveSkips < maxFrameSkip) {
+        ++consecutiveSkips;
+        ++stats.skipped;
+        return false;
+    }
+
+    consecutiveSkips = 0;
+    presentStart = now;
+    return true;
+}
+
+/**
+ * @brief Records the timing of a finished present.
+ */
+void FramePacer::presented() {
+    Clock::time_point now = Clock::now();
+    presentSumMs += std::chrono::duration<double, std::milli>(now - presentStart).count();
+
+    if (stats.presented > 0) {
+        double intervalMs = std::chrono::duration<double, std::milli>(presentStart - lastPresent).count();
+        uint64_t intervals = stats.presented;
+        intervalSumMs += intervalMs;
+        stats.minIntervalMs = intervals == 1 ? intervalMs : std::min(stats.minIntervalMs, intervalMs);
+        stats.maxIntervalMs = std::max(stats.maxIntervalMs, intervalMs);
+        stats.avgIntervalMs = intervalSumMs / intervals;
+    }
+
+    // The present was due when the change arrived, or once the cap allowed it
+    Clock::time_point due = stats.presented > 0 ? std::max(pendingSince, lastPresent + interval) : pendingSince;
+    if (presentStart - due > MISSED_DEADLINE_LATENESS) {
+        ++stats.missedDeadlines;
+    }
+
+    lastPresent = presentStart;
+    pending = false;
+    ++stats.presented;
+    stats.avgPresentMs = presentSumMs / stats.presented;
+}
@@ -0,0 +1,39 @@
+#include "framebuffer.h"
+#include "hash.h"
+
+/**
+ * @brief Expands the display to one byte (0 or 1) per pixel, row-major.
+ *
+ * @param out Destination of PIXEL_COUNT bytes.
+ */
+void Framebuffer::toBytes(uint8_t* out) const {
+    for (int y = 0; y < HEIGHT; ++y) {
+        uint64_t row = rows[y];
+        for (int x = 0; x < WIDTH; ++x) {
+            out[y * WIDTH + x] = (row >> (WIDTH - 1 - x)) & 1;
+        }
+    }
+}
+
+/**
+ * @brief Returns a byte-per-pixel copy of the display.
+ *
+ * @return std::array<uint8_t, PIXEL_COUNT> The expanded pixels.
+ */
+std::array<uint8_t, Framebuffer::PIXEL_COUNT> Framebuffer::toBytes() const {
+    std::array<uint8_t, PIXEL_COUNT> bytes;
+    toBytes(bytes.data());
+    return bytes;
+}
+
+/**
+ * @brief Hashes the packed rows.
+ *
+ * Only 256 bytes are hashed, so comparing final screens across many batch
+ * instances is cheap.
+ *
+ * @return uint64_t FNV-1a hash of the display.
+ */
+uint64_t Framebuffer::hash() const {
+    return fnv1a64(rows.data(), sizeof(rows));
+}
@@ -0,0 +1,277 @@
+#include "input_movie.h"
+#include "hash.h"
+#include "scheduler.h"
+#include "trace_format.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+namespace {
+
+constexpr uint8_t MOVIE_MAGIC[4] = {'C', '8', 'M', 'V'};
+constexpr size_t MOVIE_HEADER_SIZE = 32;
+
+void putLe64(uint8_t* out, uint64_t value) {
+    trace::putLe32(out, static_cast<uint32_t>(value));
+    trace::putLe32(out + 4, static_cast<uint32_t>(value >> 32));
+}
+
+uint64_t getLe64(const uint8_t* in) {
+    return trace::getLe32(in) | static_cast<uint64_t>(trace::getLe32(in + 4)) << 32;
+}
+
+} // namespace
+
+/**
+ * @brief Starts a new recording, discarding any records.
+ *
+ * @param rom ROM image being run.
+ * @param romSize Size of the ROM image.
+ * @param seed Seed passed to Chip8::seedRandom().
+ * @param cyclesPerSecond Fixed CPU speed of the Scheduler.
+ */
+void InputMovie::begin(const uint8_t* rom, size_t romSize, uint32_t seed, int cyclesPerSecond) {
+    this->seed = seed;
+    this->cyclesPerSecond = cyclesPerSecond;
+    this->romSize = static_cast<uint32_t>(romSize);
+    romHash = fnv1a64(rom, romSize);
+    records.clear();
+}
+
+/**
+ * @brief Records the key bitmask applied at the start of a frame.
+ *
+ * @param frame Frame index.
+ * @param cycle Cycle count before the frame runs.
+ * @param keys Key bitmask.
+ */
+void InputMovie::recordInput(uint64_t frame, uint64_t cycle, uint16_t keys) {
+    records.push_back({MovieRecord::Input, frame, cycle, keys, 0});
+}
+
+/**
+ * @brief Records the end of a frame, adding a checkpoint every CHECKPOINT_INTERVAL frames.
+ *
+ * @param frame Frame index.
+ * @param cycle Cycle count after the frame ran.
+ * @param framebufferHash Framebuffer::hash() after the frame ran.
+ */
+void InputMovie::recordFrameEnd(uint64_t frame, uint64_t cycle, uint64_t framebufferHash) {
+    if ((frame + 1) % CHECKPOINT_INTERVAL == 0) {
+        records.push_back({MovieRecord::Checkpoint, frame, cycle, 0, framebufferHash});
+    }
+}
+
+/**
+ * @brief Drops every record from frame on.
+ *
+ * @param frame First frame to forget.
+ */
+void InputMovie::truncate(uint64_t frame) {
+    while (!records.empty() && records.back().frame >= frame) {
+        records.pop_back();
+    }
+}
+
+/**
+ * @brief Marks the last recorded frame.
+ *
+ * @param frame Index of the last frame that ran.
+ * @param cycle Cycle count after it ran.
+ * @param framebufferHash Framebuffer::hash() after it ran.
+ */
+void InputMovie::finish(uint64_t frame, uint64_t cycle, uint64_t framebufferHash) {
+    truncate(frame + 1);
+    if (!records.empty() && records.back().type == MovieRecord::Checkpoint && records.back().frame == frame) {
+        records.pop_back();
+    }
+    records.push_back({MovieRecord::End, frame, cycle, 0, framebufferHash});
+}
+
+/**
+ * @brief Checks that a ROM image is the one the movie was recorded with.
+ *
+ * @param rom ROM image.
+ * @param romSize Size of the ROM image.
+ * @return bool True if size and hash match.
+ */
+bool InputMovie::matchesRom(const uint8_t* rom, size_t romSize) const {
+    return romSize == this->romSize && fnv1a64(rom, romSize) == romHash;
+}
+
+/**
+ * @brief Writes the movie to a file.
+ *
+ * @param path Output file.
+ * @return bool False if the file could not be written.
+ */
+bool InputMovie::save(const std::string& path) const {
+    std::vector<uint8_t> out(MOVIE_HEADER_SIZE, 0);
+    std::copy(std::begin(MOVIE_MAGIC), std::end(MOVIE_MAGIC), out.begin());
+    trace::putLe16(&out[4], VERSION);
+    trace::putLe16(&out[6], MOVIE_HEADER_SIZE);
+    trace::putLe32(&out[8], seed);
+    trace::putLe32(&out[12], static_cast<uint32_t>(cyclesPerSecond));
+    trace::putLe32(&out[16], romSize);
+    putLe64(&out[24], romHash);
+
+    uint64_t lastFrame = 0;
+    uint64_t lastCycle = 0;
+    for (const MovieRecord& record : records) {
+        out.push_back(record.type);
+        trace::putVarint(out, record.frame - lastFrame);
+        trace::putVarint(out, record.cycle - lastCycle);
+        lastFrame = record.frame;
+        lastCycle = record.cycle;
+        if (record.type == MovieRecord::Input) {
+            out.push_back(static_cast<uint8_t>(record.keys));
+            out.push_back(static_cast<uint8_t>(record.keys >> 8));
+        } else {
+            size_t at = out.size();
+            out.resize(at + 8);
+            putLe64(&out[at], record.hash);
+        }
+    }
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.write(reinterpret_cast<const char*>(out.data()), out.size())) {
+        std::cerr << "Failed to write movie: " << path << std::endl;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Reads a movie written by save().
+ *
+ * @param path Movie file.
+ * @return bool False if the file is missing, truncated or not a supported movie.
+ */
+bool InputMovie::load(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open movie: " << path << std::endl;
+        return false;
+    }
+    std::vector<uint8_t> in((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (in.size() < MOVIE_HEADER_SIZE || !std::equal(std::begin(MOVIE_MAGIC), std::end(MOVIE_MAGIC), in.begin()) ||
+        trace::getLe16(&in[4]) != VERSION || trace::getLe16(&in[6]) < MOVIE_HEADER_SIZE ||
+        trace::getLe16(&in[6]) > in.size()) {
+        std::cerr << "Not a supported CHIP-8 movie: " << path << std::endl;
+        return false;
+    }
+    seed = trace::getLe32(&in[8]);
+    cyclesPerSecond = static_cast<int>(trace::getLe32(&in[12]));
+    romSize = trace::getLe32(&in[16]);
+    romHash = getLe64(&in[24]);
+
+    records.clear();
+    const uint8_t* cursor = in.data() + trace::getLe16(&in[6]);
+    const uint8_t* end = in.data() + in.size();
+    MovieRecord record = {};
+    while (cursor < end) {
+        uint8_t type = *cursor++;
+        uint64_t frameDelta, cycleDelta;
+        size_t payload = type == MovieRecord::Input ? 2 : 8;
+        if (type > MovieRecord::End || !trace::getVarint(cursor, end, frameDelta) ||
+            !trace::getVarint(cursor, end, cycleDelta) || static_cast<size_t>(end - cursor) < payload) {
+            std::cerr << "Corrupt movie: " << path << std::endl;
+            return false;
+        }
+        record.type = static_cast<MovieRecord::Type>(type);
+        record.frame += frameDelta;
+        record.cycle += cycleDelta;
+        record.keys = type == MovieRecord::Input ? static_cast<uint16_t>(cursor[0] | cursor[1] << 8) : 0;
+        record.hash = type == MovieRecord::Input ? 0 : getLe64(cursor);
+        cursor += payload;
+        records.push_back(record);
+    }
+    return true;
+}
+
+/**
+ * @brief Replays a movie headless, as fast as possible, checking every checkpoint.
+ *
+ * Frames run through a Scheduler at the recorded CPU speed, without waiting
+ * between frames, so each frame gets the same instruction budget as when it
+ * was recorded. Input records are applied before their frame runs and must
+ * find the core at the recorded cycle; checkpoints must match both the cycle
+ * count and the framebuffer hash.
+ *
+ * @param movie The recording.
+ * @param rom ROM image.
+ * @param mode Execution mode to replay in.
+ * @return ReplayResult Replay outcome; stops at the first mismatch.
+ */
+ReplayResult replayMovie(const InputMovie& movie, const std::vector<uint8_t>& rom, ExecutionMode mode) {
+    ReplayResult result;
+    if (!movie.matchesRom(rom.data(), rom.size())) {
+        result.mismatch = "ROM does not match the recording";
+        return result;
+    }
+    if (movie.getCyclesPerSecond() <= 0) {
+        result.mismatch = "movie has no fixed CPU speed";
+        return result;
+    }
+
+    Chip8 chip8;
+    chip8.setExecutionMode(mode);
+    chip8.seedRandom(movie.getSeed());
+    chip8.loadProgram(rom.data(), rom.size());
+    Scheduler scheduler(movie.getCyclesPerSecond());
+    scheduler.start();
+
+    const std::vector<MovieRecord>& records = movie.getRecords();
+    uint64_t lastFrame = records.empty() ? 0 : records.back().frame;
+    size_t next = 0;
+    auto fail = [&](uint64_t frame, const char* what) {
+        result.mismatchFrame = frame;
+        result.mismatch = what;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    bool ok = true;
+    for (uint64_t frame = 0; ok && frame <= lastFrame && !records.empty(); ++frame) {
+        for (; next < records.size() && records[next].frame == frame &&
+               records[next].type == MovieRecord::Input; ++next) {
+            if (records[next].cycle != chip8.getCycleCount()) {
+                fail(frame, "input applied at a different cycle");
+                ok = false;
+                break;
+            }
+            for (int i = 0; i < 16; ++i) {
+                chip8.key[i] = (records[next].keys >> i) & 1;
+            }
+        }
+        if (!ok) {
+            break;
+        }
+
+        scheduler.runFrame(chip8);
+        result.frames = frame + 1;
+
+        for (; next < records.size() && records[next].frame == frame; ++next) {
+            const MovieRecord& record = records[next];
+            if (record.cycle != chip8.getCycleCount()) {
+                fail(frame, "cycle count differs at checkpoint");
+                ok = false;
+                break;
+            }
+            if (record.hash != chip8.gfx.hash()) {
+                fail(frame, "framebuffer differs at checkpoint");
+                ok = false;
+                break;
+            }
+            ++result.checkpoints;
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    result.matched = ok;
+    result.instructions = chip8.getCycleCount();
+    result.framebufferHash = chip8.gfx.hash();
+    result.wallMs = std::chrono::duration<double, std::milli>(end - start).count();
+    return result;
+}
@@ -0,0 +1,170 @@
+#include "lz_codec.h"
+#include <cstring>
+
+// Shortest back-reference worth encoding.
+const size_t MIN_MATCH = 4;
+
+// Farthest back-reference a 16-bit offset can express.
+const size_t MAX_OFFSET = 65535;
+
+// log2 of the number of hash table slots used to find match candidates.
+const int HASH_BITS = 13;
+
+/**
+ * @brief Loads 4 bytes without alignment requirements.
+ */
+static uint32_t read32(const uint8_t* p) {
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Hashes 4 bytes into a hash table slot.
+ */
+static uint32_t hash32(uint32_t sequence) {
+    return (sequence * 2654435761u) >> (32 - HASH_BITS);
+}
+
+/**
+ * @brief Appends a length that did not fit its 4-bit token field.
+ */
+static void writeLength(std::vector<uint8_t>& output, size_t length) {
+    while (length >= 255) {
+        output.push_back(255);
+        length -= 255;
+    }
+    output.push_back(static_cast<uint8_t>(length));
+}
+
+/**
+ * @brief Appends one sequence: a literal run, optionally followed by a match.
+ */
+static void writeSequence(std::vector<uint8_t>& output, const uint8_t* literals, size_t literalLength,
+                          size_t offset, size_t matchLength) {
+    size_t matchCode = matchLength ? matchLength - MIN_MATCH : 0;
+    uint8_t token = static_cast<uint8_t>((literalLength < 15 ? literalLength : 15) << 4);
+    token |= static_cast<uint8_t>(matchCode < 15 ? matchCode : 15);
+    output.push_back(token);
+    if (literalLength >= 15) {
+        writeLength(output, literalLength - 15);
+    }
+    output.insert(output.end(), literals, literals + literalLength);
+    if (matchLength == 0) {
+        return;
+    }
+    output.push_back(static_cast<uint8_t>(offset));
+    output.push_back(static_cast<uint8_t>(offset >> 8));
+    if (matchCode >= 15) {
+        writeLength(output, matchCode - 15);
+    }
+}
+
+/**
+ * @brief Compresses a buffer with a greedy single-probe LZ77 search.
+ *
+ * @param input Data to compress.
+ * @param size Number of bytes in input.
+ * @param output Receives the compressed bytes (appended).
+ */
+void lzCompress(const uint8_t* input, size_t size, std::vector<uint8_t>& output) {
+    std::vector<int64_t> table(size_t(1) << HASH_BITS, -1);
+    size_t anchor = 0;
+    size_t pos = 0;
+
+    while (pos + MIN_MATCH <= size) {
+        uint32_t sequence = read32(input + pos);
+        uint32_t slot = hash32(sequence);
+        int64_t candidate = table[slot];
+        table[slot] = static_cast<int64_t>(pos);
+
+        if (candidate >= 0 && pos - candidate <= MAX_OFFSET && read32(input + candidate) == sequence) {
+            size_t matchLength = MIN_MATCH;
+            while (pos + matchLength < size && input[candidate + matchLength] == input[pos + matchLength]) {
+                ++matchLength;
+            }
+            writeSequence(output, input + anchor, pos - anchor, pos - candidate, matchLength);
+            pos += matchLength;
+            anchor = pos;
+        } else {
+            ++pos;
+        }
+    }
+
+    if (anchor < size) {
+        writeSequence(output, input + anchor, size - anchor, 0, 0);
+    }
+}
+
+/**
+ * @brief Reads a length continued past its 4-bit token field.
+ *
+ * @return false if the input ends inside the length.
+ */
+static bool readLength(const uint8_t*& in, const uint8_t* end, size_t& length) {
+    uint8_t byte;
+    do {
+        if (in == end) {
+            return false;
+        }
+        byte = *in++;
+        length += byte;
+    } while (byte == 255);
+    return true;
+}
+
+/**
+ * @brief Decompresses data produced by lzCompress().
+ *
+ * Every length and offset is checked against both buffers, so corrupt
+ * input fails cleanly instead of reading or writing out of bounds.
+ *
+ * @param input Compressed data.
+ * @param size Number of compressed bytes.
+ * @param output Destination of expectedSize bytes.
+ * @param expectedSize Exact uncompressed size.
+ * @return bool True on success.
+ */
+bool lzDecompress(const uint8_t* input, size_t size, uint8_t* output, size_t expectedSize) {
+    const uint8_t* in = input;
+    const uint8_t* end = input + size;
+    size_t out = 0;
+
+    while (in < end) {
+        uint8_t token = *in++;
+
+        size_t literalLength = token >> 4;
+        if (literalLength == 15 && !readLength(in, end, literalLength)) {
+            return false;
+        }
+        if (literalLength > static_cast<size_t>(end - in) || literalLength > expectedSize - out) {
+            return false;
+        }
+        std::memcpy(output + out, in, literalLength);
+        in += literalLength;
+        out += literalLength;
+
+        if (in == end) {
+            break;  // The final sequence carries literals only
+        }
+
+        if (end - in < 2) {
+            return false;
+        }
+        size_t offset = in[0] | (in[1] << 8);
+        in += 2;
+        size_t matchLength = token & 0x0F;
+        if (matchLength == 15 && !readLength(in, end, matchLength)) {
+            return false;
+        }
+        matchLength += MIN_MATCH;
+        if (offset == 0 || offset > out || matchLength > expectedSize - out) {
+            return false;
+        }
+        // Byte by byte: the source may overlap the bytes being written
+        for (size_t i = 0; i < matchLength; ++i, ++out) {
+            output[out] = output[out - offset];
+        }
+    }
+    return out == expectedSize;
+}
@@ -4,44 +4,142 @@
 #include "event.h"
 
 /**
- * @brief Handles 0x0--- opcodes.
+ * @brief Flags idle loops ending in a jump from jumpAddress to target.
  *
- * Implements:
- *   - 0x00E0: CLS - Clear the display.
- *   - 0x00EE: RET - Return from a subroutine.
+ * Recognises a jump to itself, and the delay timer poll loop
+ *     target:     FX07  (Vx = DT)
+ *     target + 2: 3X00  (skip if Vx == 0)
+ *     target + 4: 1NNN  (jump back to target)
+ * taken while the delay timer is still running. The loop can only exit
+ * after a timer tick, so the core may stop until then.
  *
  * @param chip8 Reference to the Chip8 instance.
+ * @param jumpAddress Address of the jump instruction.
+ * @param target Jump destination.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::detectIdleLoop(Chip8& chip8, uint16_t jumpAddress, uint16_t target) {
+    if (target == jumpAddress) {
+        chip8.idleState = IdleState::Halted;
+    } else if (target + 4 == jumpAddress && chip8.delay_timer > 0) {
+        const auto& memory = chip8.memory;
+        uint8_t x = memory[target] & 0x0F;
+        if ((memory[target] & 0xF0) == 0xF0 && memory[target + 1] == 0x07 &&
+            memory[target + 2] == (0x30 | x) && memory[target + 3] == 0x00) {
+            chip8.idleState = IdleState::WaitingForTimer;
+        }
+    }
+}
+
+/**
+ * @brief Decodes an opcode into its handler and operand fields.
+ *
+ * This is the only place that switches on opcode bits. The result can be
+ * executed directly or cached per address (see DecodeCache).
+ *
  * @param opcode The 16-bit opcode value.
+ * @return Instruction The decoded instruction.
  */
-void OpcodeHandler::handle_0x0(Chip8& chip8, uint16_t opcode) {
-    switch(opcode & 0x00FF) {
-        /* CLS */
-            case 0x00E0: 
-                chip8.gfx.fill(0);
-                {
-                    std::map<uint16_t, int> memoryDiff;
-                    for (uint16_t i = 0; i < chip8.gfx.size(); ++i) {
-                        memoryDiff[i] = 0;
-                    }
-                    EventLogger::pushLog(MemoryEvent(memoryDiff));
-                }
-                chip8.drawFlag = true;
-                chip8.pc += 2;
-                break;
-        /* RET */
-        case 0x00EE: 
-            chip8.sp--;
-            EventLogger::pushLog(StackEvent(chip8.pc, chip8.stack[chip8.sp], std::vector<uint16_t>(chip8.stack.begin(), chip8.stack.end())));
-            chip8.pc = chip8.stack[chip8.sp];
-            chip8.pc += 2;
+template <TraceLevel L>
+Instruction OpcodeHandler<L>::decode(uint16_t opcode) {
+    Instruction inst;
+    inst.opcode = opcode;
+    inst.nnn = opcode & 0x0FFF;
+    inst.x = (opcode & 0x0F00) >> 8;
+    inst.y = (opcode & 0x00F0) >> 4;
+    inst.n = opcode & 0x000F;
+    inst.nn = opcode & 0x00FF;
+    inst.handler = op_unknown;
+
+    switch (opcode & 0xF000) {
+        case 0x0000:
+            switch (opcode & 0x00FF) {
+                case 0x00E0: inst.handler = op_00E0; break;
+                case 0x00EE: inst.handler = op_00EE; break;
+            }
             break;
-        /* Unknown opcode */
-        default:
-            std::cerr << "Unknown opcode [0x0000]: " << std::hex << opcode << std::endl;
-            chip8.pc += 2;
+        case 0x1000: inst.handler = op_1NNN; break;
+        case 0x2000: inst.handler = op_2NNN; break;
+        case 0x3000: inst.handler = op_3XNN; break;
+        case 0x4000: inst.handler = op_4XNN; break;
+        case 0x5000: inst.handler = op_5XY0; break;
+        case 0x6000: inst.handler = op_6XNN; break;
+        case 0x7000: inst.handler = op_7XNN; break;
+        case 0x8000:
+            switch (opcode & 0x000F) {
+                case 0x0000: inst.handler = op_8XY0; break;
+                case 0x0001: inst.handler = op_8XY1; break;
+                case 0x0002: inst.handler = op_8XY2; break;
+                case 0x0003: inst.handler = op_8XY3; break;
+                case 0x0004: inst.handler = op_8XY4; break;
+                case 0x0005: inst.handler = op_8XY5; break;
+                case 0x0006: inst.handler = op_8XY6; break;
+                case 0x0007: inst.handler = op_8XY7; break;
+                case 0x000E: inst.handler = op_8XYE; break;
+            }
+            break;
+        case 0x9000: inst.handler = op_9XY0; break;
+        case 0xA000: inst.handler = op_ANNN; break;
+        case 0xB000: inst.handler = op_BNNN; break;
+        case 0xC000: inst.handler = op_CXNN; break;
+        case 0xD000: inst.handler = op_DXYN; break;
+        case 0xE000:
+            switch (opcode & 0x00FF) {
+                case 0x009E: inst.handler = op_EX9E; break;
+                case 0x00A1: inst.handler = op_EXA1; break;
+            }
+            break;
+        case 0xF000:
+            switch (opcode & 0x00FF) {
+                case 0x0007: inst.handler = op_FX07; break;
+                case 0x000A: inst.handler = op_FX0A; break;
+                case 0x0015: inst.handler = op_FX15; break;
+                case 0x0018: inst.handler = op_FX18; break;
+                case 0x001E: inst.handler = op_FX1E; break;
+                case 0x0029: inst.handler = op_FX29; break;
+                case 0x0033: inst.handler = op_FX33; break;
+                case 0x0055: inst.handler = op_FX55; break;
+                case 0x0065: inst.handler = op_FX65; break;
+            }
             break;
     }
-    
+    return inst;
+}
+
+/**
+ * @brief Handles 0x00E0 opcode.
+ *
+ * Implements:
+ *   - 0x00E0: CLS - Clear the display.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The decoded instruction.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_00E0(Chip8& chip8, const Instruction& /*inst*/) {
+    /* CLS */
+    chip8.gfx.clear();
+    if constexpr (L == TraceLevel::Full) chip8.eventLogger->log(FramebufferClearedEvent(chip8.cycleCount));
+    chip8.drawFlag = true;
+    chip8.pc += 2;
+}
+
+/**
+ * @brief Handles 0x00EE opcode.
+ *
+ * Implements:
+ *   - 0x00EE: RET - Return from a subroutine.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The decoded instruction.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_00EE(Chip8& chip8, const Instruction& /*inst*/) {
+    /* RET */
+    chip8.sp = (chip8.sp - 1) & 0x0F;   // Wraps within the 16 entries, as in VmBank
+    if constexpr (L == TraceLevel::Full) chip8.eventLogger->log(StackEvent(chip8.cycleCount, chip8.pc, chip8.stack[chip8.sp], chip8.sp, chip8.stack));
+    chip8.pc = chip8.stack[chip8.sp];
+    chip8.pc += 2;
 }
 
 /**
@@ -51,11 +149,13 @@ void OpcodeHandler::handle_0x0(Chip8& chip8, uint16_t opcode) {
  *   - 0x1NNN: JP addr - Jump to address NNN.
  *
  * @param chip8 Reference to the Chip8 instance.
- * @param opcode The 16-bit opcode value.
+ * @param inst The decoded instruction.
  */
-void OpcodeHandler::handle_0x1(Chip8& chip8, uint16_t opcode) {
+template <TraceLevel L>
+void OpcodeHandler<L>::op_1NNN(Chip8& chip8, const Instruction& inst) {
     /* JP addr */
-    chip8.pc = opcode & 0x0FFF;
+    detectIdleLoop(chip8, chip8.pc, inst.nnn);
+    chip8.pc = inst.nnn;
 }
 
 /**
@@ -65,14 +165,15 @@ void OpcodeHandler::handle_0x1(Chip8& chip8, uint16_t opcode) {
  *   - 0x2NNN: CALL addr - Call subroutine at address NNN.
  *
  * @param chip8 Reference to the Chip8 instance.
- * @param opcode The 16-bit opcode value.
+ * @param inst The decoded instruction.
  */
-void OpcodeHandler::handle_0x2(Chip8& chip8, uint16_t opcode) {
+template <TraceLevel L>
+void OpcodeHandler<L>::op_2NNN(Chip8& chip8, const Instruction& inst) {
     /* CALL addr */
     chip8.stack[chip8.sp] = chip8.pc;
-    chip8.sp++;
-    EventLogger::pushLog(StackEvent(chip8.pc, opcode & 0x0FFF, std::vector<uint16_t>(chip8.stack.begin(), chip8.stack.end())));
-    chip8.pc = opcode & 0x0FFF;
+    chip8.sp = (chip8.sp + 1) & 0x0F;   // Wraps like 00EE
+    if constexpr (L == TraceLevel::Full) chip8.eventLogger->log(StackEvent(chip8.cycleCount, chip8.pc, inst.nnn, chip8.sp, chip8.stack));
+    chip8.pc = inst.nnn;
 }
 
 /**
@@ -82,13 +183,12 @@ void OpcodeHandler::handle_0x2(Chip8& chip8, uint16_t opcode) {
  *   - 0x3XNN: SE Vx, NN - Skip next instruction if Vx == NN.
  *
  * @param chip8 Reference to the Chip8 instance.
- * @param opcode The 16-bit opcode value.
+ * @param inst The decoded instruction.
  */
-void OpcodeHandler::handle_0x3(Chip8& chip8, uint16_t opcode) {
+template <TraceLevel L>
+void OpcodeHandler<L>::op_3XNN(Chip8& chip8, const Instruction& inst) {
     /* SE Vx, byte */
-    uint8_t Vx = (opcode & 0x0F00) >> 8;
-    uint8_t byte = opcode & 0x00FF;
-    if (chip8.V[Vx] == byte) {
+    if (chip8.V[inst.x] == inst.nn) {
         chip8.pc += 4;
     } else {
         chip8.pc += 2;
@@ -102,13 +202,12 @@ void OpcodeHandler::handle_0x3(Chip8& chip8, uint16_t opcode) {
  *   - 0x4XNN: SNE Vx, NN - Skip next instruction if Vx != NN.
  *
  * @param chip8 Reference to the Chip8 instance.
- * @param opcode The 16-bit opcode value.
+ * @param inst The decoded instruction.
  */
-void OpcodeHandler::handle_0x4(Chip8& chip8, uint16_t opcode) {
+template <TraceLevel L>
+void OpcodeHandler<L>::op_4XNN(Chip8& chip8, const Instruction& inst) {
     /* SNE Vx, byte */
-    uint8_t Vx = (opcode & 0x0F00) >> 8;
-    uint8_t byte = opcode & 0x00FF;
-    if (chip8.V[Vx] != byte) {
+    if (chip8.V[inst.x] != inst.nn) {
         chip8.pc += 4;
     } else {
         chip8.pc += 2;
@@ -122,13 +221,12 @@ void OpcodeHandler::handle_0x4(Chip8& chip8, uint16_t opcode) {
  *   - 0x5XY0: SE Vx, Vy - Skip next instruction if Vx == Vy.
  *
  * @param chip8 Reference to the Chip8 instance.
- * @param opcode The 16-bit opcode value.
+ * @param inst The decoded instruction.
  */
-void OpcodeHandler::handle_0x5(Chip8& chip8, uint16_t opcode) {
+template <TraceLevel L>
+void OpcodeHandler<L>::op_5XY0(Chip8& chip8, const Instruction& inst) {
     /* SE Vx, Vy */
-    uint8_t Vx = (opcode & 0x0F00) >> 8;
-    uint8_t Vy = (opcode & 0x00F0) >> 4;
-    if (chip8.V[Vx] == chip8.V[Vy]) {
+    if (chip8.V[inst.x] == chip8.V[inst.y]) {
         chip8.pc += 4;
     } else {
         chip8.pc += 2;
@@ -142,14 +240,13 @@ void OpcodeHandler::handle_0x5(Chip8& chip8, uint16_t opcode) {
  *   - 0x6XNN: LD Vx, NN - Set Vx = NN.
  *
  * @param chip8 Reference to the Chip8 instance.
- * @param opcode The 16-bit opcode value.
+ * @param inst The decoded instruction.
  */
-void OpcodeHandler::handle_0x6(Chip8& chip8, uint16_t opcode) {
+template <TraceLevel L>
+void OpcodeHandler<L>::op_6XNN(Chip8& chip8, const Instruction& inst) {
     /* LD Vx, byte */
-    uint8_t Vx = (opcode & 0x0F00) >> 8;
-    uint8_t byte = opcode & 0x00FF;
-    chip8.V[Vx] = byte;
-    EventLogger::pushLog(RegisterEvent(std::map<int, int>{{Vx, byte}}));
+    chip8.V[inst.x] = inst.nn;
+    if constexpr (L == TraceLevel::Full) chip8.eventLogger->log(RegisterEvent(chip8.cycleCount).set(inst.x, inst.nn));
     chip8.pc += 2;
 }
 
@@ -160,94 +257,163 @@ void OpcodeHandler::handle_0x6(Chip8& chip8, uint16_t opcode) {
  *   - 0x7XNN: ADD Vx, NN - Set Vx = Vx + NN.
  *
  * @param chip8 Reference to the Chip8 instance.
- * @param opcode The 16-bit opcode value.
+ * @param inst The decoded instruction.
  */
-void OpcodeHandler::handle_0x7(Chip8& chip8, uint16_t opcode) {
+template <TraceLevel L>
+void OpcodeHandler<L>::op_7XNN(Chip8& chip8, const Instruction& inst) {
     /* ADD Vx, byte */
-    uint8_t Vx = (opcode & 0x0F00) >> 8;
-    uint8_t byte = opcode & 0x00FF;
-    chip8.V[Vx] += byte;
-    EventLogger::pushLog(RegisterEvent(std::map<int, int>{{Vx, chip8.V[Vx]}}));
+    chip8.V[inst.x] += inst.nn;
+    if constexpr (L == TraceLevel::Full) chip8.eventLogger->log(RegisterEvent(chip8.cycleCount).set(inst.x, chip8.V[inst.x]));
     chip8.pc += 2;
 }
 
 /**
- * @brief Handles 0x8XY_ opcodes.
+ * @brief Handles 0x8XY0 opcode.
  *
  * Implements:
  *   - 0x8XY0: LD Vx, Vy - Set Vx = Vy.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The decoded instruction.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_8XY0(Chip8& chip8, const Instruction& inst) {
+    chip8.V[inst.x] = chip8.V[inst.y];
+    if constexpr (L == TraceLevel::Full) chip8.eventLogger->log(RegisterEvent(chip8.cycleCount).set(inst.x, chip8.V[inst.x]));
+    chip8.pc += 2;
+}
+
+/**
+ * @brief Handles 0x8XY1 opcode.
+ *
+ * Implements:
  *   - 0x8XY1: OR Vx, Vy - Set Vx = Vx OR Vy.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The decoded instruction.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_8XY1(Chip8& chip8, const Instruction& inst) {
+    chip8.V[inst.x] |= chip8.V[inst.y];
+    if constexpr (L == TraceLevel::Full) chip8.eventLogger->log(RegisterEvent(chip8.cycleCount).set(inst.x, chip8.V[inst.x]));
+    chip8.pc += 2;
+}
+
+/**
+ * @brief Handles 0x8XY2 opcode.
+ *
+ * Implements:
  *   - 0x8XY2: AND Vx, Vy - Set Vx = Vx AND Vy.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The decoded instruction.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_8XY2(Chip8& chip8, const Instruction& inst) {
+    chip8.V[inst.x] &= chip8.V[inst.y];
+    if constexpr (L == TraceLevel::Full) chip8.eventLogger->log(RegisterEvent(chip8.cycleCount).set(inst.x, chip8.V[inst.x]));
+    chip8.pc += 2;
+}
+
+/**
+ * @brief Handles 0x8XY3 opcode.
+ *
+ * Implements:
  *   - 0x8XY3: XOR Vx, Vy - Set Vx = Vx XOR Vy.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The decoded instruction.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_8XY3(Chip8& chip8, const Instruction& inst) {
+    chip8.V[inst.x] ^= chip8.V[inst.y];
+    if constexpr (L == TraceLevel::Full) chip8.eventLogger->log(RegisterEvent(chip8.cycleCount).set(inst.x, chip8.V[inst.x]));
+    chip8.pc += 2;
+}
+
+/**
+ * @brief Handles 0x8XY4 opcode.
+ *
+ * Implements:
  *   - 0x8XY4: ADD Vx, Vy - Set Vx = Vx + Vy, set VF = carry.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The decoded instruction.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_8XY4(Chip8& chip8, const Instruction& inst) {
+    uint16_t sum = chip8.V[inst.x] + chip8.V[inst.y];
+    chip8.V[0xF] = (sum > 255) ? 1 : 0; // Set carry flag
+    chip8.V[inst.x] = sum & 0xFF;
+    if constexpr (L == TraceLevel::Full) chip8.eventLogger->log(RegisterEvent(chip8.cycleCount).set(inst.x, chip8.V[inst.x]).set(0xF, chip8.V[0xF]));
+    chip8.pc += 2;
+}
+
+/**
+ * @brief Handles 0x8XY5 opcode.
+ *
+ * Implements:
  *   - 0x8XY5: SUB Vx, Vy - Set Vx = Vx - Vy, set VF = NOT borrow.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The decoded instruction.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_8XY5(Chip8& chip8, const Instruction& inst) {
+    chip8.V[0xF] = (chip8.V[inst.x] > chip8.V[inst.y]) ? 1 : 0; // Set borrow flag
+    chip8.V[inst.x] -= chip8.V[inst.y];
+    if constexpr (L == TraceLevel::Full) chip8.eventLogger->log(RegisterEvent(chip8.cycleCount).set(inst.x, chip8.V[inst.x]).set(0xF, chip8.V[0xF]));
+    chip8.pc += 2;
+}
+
+/**
+ * @brief Handles 0x8XY6 opcode.
+ *
+ * Implements:
  *   - 0x8XY6: SHR Vx - Set Vx = Vx >> 1, set VF = least significant bit of Vx.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The decoded instruction.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_8XY6(Chip8& chip8, const Instruction& inst) {
+    chip8.V[0xF] = chip8.V[inst.x] & 0x1; // Store least significant bit
+    chip8.V[inst.x] >>= 1;
+    if constexpr (L == TraceLevel::Full) chip8.eventLogger->log(RegisterEvent(chip8.cycleCount).set(inst.x, chip8.V[inst.x]).set(0xF, chip8.V[0xF]));
+    chip8.pc += 2;
+}
+
+/**
+ * @brief Handles 0x8XY7 opcode.
+ *
+ * Implements:
  *   - 0x8XY7: SUBN Vx, Vy - Set Vx = Vy - Vx, set VF = NOT borrow.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The decoded instruction.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_8XY7(Chip8& chip8, const Instruction& inst) {
+    chip8.V[0xF] = (chip8.V[inst.y] > chip8.V[inst.x]) ? 1 : 0; // Set borrow flag
+    chip8.V[inst.x] = chip8.V[inst.y] - chip8.V[inst.x];
+    if constexpr (L == TraceLevel::Full) chip8.eventLogger->log(RegisterEvent(chip8.cycleCount).set(inst.x, chip8.V[inst.x]).set(0xF, chip8.V[0xF]));
+    chip8.pc += 2;
+}
+
+/**
+ * @brief Handles 0x8XYE opcode.
+ *
+ * Implements:
  *   - 0x8XYE: SHL Vx - Set Vx = Vx << 1, set VF = most significant bit of Vx.
  *
  * @param chip8 Reference to the Chip8 instance.
- * @param opcode The 16-bit opcode value.
+ * @param inst The decoded instruction.
  */
-void OpcodeHandler::handle_0x8(Chip8& chip8, uint16_t opcode) {
-    uint8_t x = (opcode & 0x0F00) >> 8;
-    uint8_t y = (opcode & 0x00F0) >> 4;
-    switch (opcode & 0x000F) {
-        case 0x0000: { /* 8XY0: LD Vx, Vy */
-            chip8.V[x] = chip8.V[y];
-            EventLogger::pushLog(RegisterEvent(std::map<int, int>{{x, chip8.V[x]}}));
-            break;
-        }
-        case 0x0001: { /* 8XY1: OR Vx, Vy */
-            chip8.V[x] |= chip8.V[y];
-            EventLogger::pushLog(RegisterEvent(std::map<int, int>{{x, chip8.V[x]}}));
-            break;
-        }
-        case 0x0002: { /* 8XY2: AND Vx, Vy */
-            chip8.V[x] &= chip8.V[y];
-            EventLogger::pushLog(RegisterEvent(std::map<int, int>{{x, chip8.V[x]}}));
-            break;
-        }
-        case 0x0003: { /* 8XY3: XOR Vx, Vy */
-            chip8.V[x] ^= chip8.V[y];
-            EventLogger::pushLog(RegisterEvent(std::map<int, int>{{x, chip8.V[x]}}));
-            break;
-        }
-        case 0x0004: { /* 8XY4: ADD Vx, Vy */
-            uint16_t sum = chip8.V[x] + chip8.V[y];
-            chip8.V[0xF] = (sum > 255) ? 1 : 0; // Set carry flag
-            chip8.V[x] = sum & 0xFF;
-            EventLogger::pushLog(RegisterEvent({{x, chip8.V[x]}, {0xF, chip8.V[0xF]}}));
-            break;
-        }
-        case 0x0005: { /* 8XY5: SUB Vx, Vy */
-            chip8.V[0xF] = (chip8.V[x] > chip8.V[y]) ? 1 : 0; // Set borrow flag
-            chip8.V[x] -= chip8.V[y];
-            EventLogger::pushLog(RegisterEvent({{x, chip8.V[x]}, {0xF, chip8.V[0xF]}}));
-            break;
-        }
-        case 0x0006: { /* 8XY6: SHR Vx {, Vy} */
-            chip8.V[0xF] = chip8.V[x] & 0x1; // Store least significant bit
-            chip8.V[x] >>= 1;
-            EventLogger::pushLog(RegisterEvent({{x, chip8.V[x]}, {0xF, chip8.V[0xF]}}));
-            break;
-        }
-        case 0x0007: { /* 8XY7: SUBN Vx, Vy */
-            chip8.V[0xF] = (chip8.V[y] > chip8.V[x]) ? 1 : 0; // Set borrow flag
-            chip8.V[x] = chip8.V[y] - chip8.V[x];
-            EventLogger::pushLog(RegisterEvent({{x, chip8.V[x]}, {0xF, chip8.V[0xF]}}));
-            break;
-        }
-        case 0x000E: { /* 8XYE: SHL Vx {, Vy} */
-            chip8.V[0xF] = (chip8.V[x] & 0x80) >> 7; // Store most significant bit
-            chip8.V[x] <<= 1;
-            EventLogger::pushLog(RegisterEvent({{x, chip8.V[x]}, {0xF, chip8.V[0xF]}}));
-            break;
-        }
-        default: {
-            std::cerr << "Unknown opcode [0x8000]: " << std::hex << opcode << std::endl;
-            break;
-        }
-    }
+template <TraceLevel L>
+void OpcodeHandler<L>::op_8XYE(Chip8& chip8, const Instruction& inst) {
+    chip8.V[0xF] = (chip8.V[inst.x] & 0x80) >> 7; // Store most significant bit
+    chip8.V[inst.x] <<= 1;
+    if constexpr (L == TraceLevel::Full) chip8.eventLogger->log(RegisterEvent(chip8.cycleCount).set(inst.x, chip8.V[inst.x]).set(0xF, chip8.V[0xF]));
     chip8.pc += 2;
 }
 
@@ -258,13 +424,12 @@ void OpcodeHandler::handle_0x8(Chip8& chip8, uint16_t opcode) {
  *   - 0x9XY0: SNE Vx, Vy - Skip next instruction if Vx != Vy.
  *
  * @param chip8 Reference to the Chip8 instance.
- * @param opcode The 16-bit opcode value.
+ * @param inst The decoded instruction.
  */
-void OpcodeHandler::handle_0x9(Chip8& chip8, uint16_t opcode) {
+template <TraceLevel L>
+void OpcodeHandler<L>::op_9XY0(Chip8& chip8, const Instruction& inst) {
     /* SNE Vx, Vy */
-    uint8_t Vx = (opcode & 0x0F00) >> 8;
-    uint8_t Vy = (opcode & 0x00F0) >> 4;
-    if (chip8.V[Vx] != chip8.V[Vy]) {
+    if (chip8.V[inst.x] != chip8.V[inst.y]) {
         chip8.pc += 4;
     } else {
         chip8.pc += 2;
@@ -278,11 +443,12 @@ void OpcodeHandler::handle_0x9(Chip8& chip8, uint16_t opcode) {
  *   - 0xANNN: LD I, addr - Set I = NNN.
  *
  * @param chip8 Reference to the Chip8 instance.
- * @param opcode The 16-bit opcode value.
+ * @param inst The decoded instruction.
  */
-void OpcodeHandler::handle_0xA(Chip8& chip8, uint16_t opcode) {
+template <TraceLevel L>
+void OpcodeHandler<L>::op_ANNN(Chip8& chip8, const Instruction& inst) {
     /* LD I, addr */
-    chip8.I = opcode & 0x0FFF;
+    chip8.I = inst.nnn;
     chip8.pc += 2;
 }
 
@@ -293,11 +459,12 @@ void OpcodeHandler::handle_0xA(Chip8& chip8, uint16_t opcode) {
  *   - 0xBNNN: JP V0, addr - Jump to address NNN + V0.
  *
  * @param chip8 Reference to the Chip8 instance.
- * @param opcode The 16-bit opcode value.
+ * @param inst The decoded instruction.
  */
-void OpcodeHandler::handle_0xB(Chip8& chip8, uint16_t opcode) {
+template <TraceLevel L>
+void OpcodeHandler<L>::op_BNNN(Chip8& chip8, const Instruction& inst) {
     /* JP V0, addr */
-    chip8.pc = (opcode & 0x0FFF) + chip8.V[0];
+    chip8.pc = inst.nnn + chip8.V[0];
 }
 
 /**
@@ -307,17 +474,15 @@ void OpcodeHandler::handle_0xB(Chip8& chip8, uint16_t opcode) {
  *   - 0xCXNN: RND Vx, byte - Set Vx = random byte AND NN.
  *
  * @param chip8 Reference to the Chip8 instance.
- * @param opcode The 16-bit opcode value.
+ * @param inst The decoded instruction.
  */
-void OpcodeHandler::handle_0xC(Chip8& chip8, uint16_t opcode) {
+template <TraceLevel L>
+void OpcodeHandler<L>::op_CXNN(Chip8& chip8, const Instruction& inst) {
     /* RND Vx, byte */
-    uint8_t Vx = (opcode & 0x0F00) >> 8;
-    uint8_t byte = opcode & 0x00FF;
-    uint8_t randByte = rand() % 256; // Generate random byte
-    chip8.V[Vx] = randByte & byte;
-    EventLogger::pushLog(RegisterEvent(std::map<int, int>{{Vx, chip8.V[Vx]}}));
+    uint8_t randByte = chip8.nextRandom() % 256; // Generate random byte from the instance's generator
+    chip8.V[inst.x] = randByte & inst.nn;
+    if constexpr (L == TraceLevel::Full) chip8.eventLogger->log(RegisterEvent(chip8.cycleCount).set(inst.x, chip8.V[inst.x]));
     chip8.pc += 2;
-
 }
 
 /**
@@ -325,210 +490,309 @@ void OpcodeHandler::handle_0xC(Chip8& chip8, uint16_t opcode) {
 * Implements:
 *   - 0xDXYN: DRW Vx, Vy, nibble - Display n-byte sprite starting at memory location I at (Vx, Vy), set VF = collision.
 * @param chip8 Reference to the Chip8 instance.
-* @param opcode The 16-bit opcode value.
+* @param inst The decoded instruction.
 */
-void OpcodeHandler::handle_0xD(Chip8& chip8, uint16_t opcode) {
+template <TraceLevel L>
+void OpcodeHandler<L>::op_DXYN(Chip8& chip8, const Instruction& inst) {
     /* DRW Vx, Vy, nibble */
-    uint8_t x = chip8.V[(opcode & 0x0F00) >> 8];
-    uint8_t y = chip8.V[(opcode & 0x00F0) >> 4];
-    uint8_t height = opcode & 0x000F;   
-    chip8.V[0x0F] = 0;
-        std::map<uint16_t, int> memoryDiff;
-        for (int row = 0; row < height; ++row) {
-            uint8_t spriteByte = chip8.memory[chip8.I + row];
-            for (int col = 0; col < 8; ++col) {
-                if ((spriteByte & (0x80 >> col)) != 0) {
-                    uint16_t gfxIndex = (x + col + ((y + row) * 64)) % 2048;
-                    if (chip8.gfx[gfxIndex] == 1) {
-                        chip8.V[0x0F] = 1; // Collision detected
-                    }
-                    chip8.gfx[gfxIndex] ^= 1;
-                    memoryDiff[gfxIndex] = chip8.gfx[gfxIndex];
-                }
-            }
-        }
-        if (!memoryDiff.empty()) {
-            EventLogger::pushLog(MemoryEvent(memoryDiff));
-        }
+    uint8_t x = chip8.V[inst.x];
+    uint8_t y = chip8.V[inst.y];
+    uint8_t height = inst.n;
+    uint8_t sprite[15];
+    bool collision = false;
+    for (int row = 0; row < height; ++row) {
+        sprite[row] = chip8.memory[(chip8.I + row) & 0x0FFF];
+        collision |= chip8.gfx.drawSpriteRow(x, y + row, sprite[row]);
+    }
+    chip8.V[0x0F] = collision ? 1 : 0;
+    if constexpr (L == TraceLevel::Full) chip8.eventLogger->log(DrawEvent(chip8.cycleCount, x, y, chip8.I, sprite, height, collision));
     chip8.drawFlag = true;
     chip8.pc += 2;
 }
 
 /**
- * @brief Handles 0xEXNN opcodes.
+ * @brief Handles 0xEX9E opcode.
  *
  * Implements:
  *   - 0xEX9E: SKP Vx - Skip next instruction if key with the value of Vx is pressed.
- *   - 0xEXA1: SKNP Vx - Skip next instruction if key with the value of Vx is not pressed.
  *
  * @param chip8 Reference to the Chip8 instance.
- * @param opcode The 16-bit opcode value.
+ * @param inst The decoded instruction.
  */
-void OpcodeHandler::handle_0xE(Chip8& chip8, uint16_t opcode) {
-    uint8_t x = (opcode & 0x0F00) >> 8;
-    switch (opcode & 0x00FF) {
-        case 0x009E: /* EX9E: SKP Vx */
-            if (chip8.key[chip8.V[x]] != 0) {
-                chip8.pc += 4;
-            } else {
-                chip8.pc += 2;
-            }
-            break;
-        case 0x00A1: /* EXA1: SKNP Vx */
-            if (chip8.key[chip8.V[x]] == 0) {
-                chip8.pc += 4;
-            } else {
-                chip8.pc += 2;
-            }
-            break;
-        default:
-            std::cerr << "Unknown opcode [0xE000]: " << std::hex << opcode << std::endl;
-            chip8.pc += 2;
-            break;
+template <TraceLevel L>
+void OpcodeHandler<L>::op_EX9E(Chip8& chip8, const Instruction& inst) {
+    if (chip8.key[chip8.V[inst.x] & 0x0F] != 0) {
+        chip8.pc += 4;
+    } else {
+        chip8.pc += 2;
     }
 }
 
-/** 
-* @brief Handles 0xFXNN opcodes.
-*
-* Implements:
-*   - 0xFX07: LD Vx, DT - Set Vx = delay timer value.
-*   - 0xFX0A: LD Vx, K - Wait for a key press, store the value of the key in Vx.
-*   - 0xFX15: LD DT, Vx - Set delay timer = Vx.
-*   - 0xFX18: LD ST, Vx - Set sound timer = Vx.
-*   - 0xFX1E: ADD I, Vx - Set I = I + Vx.
-*   - 0xFX29: LD F, Vx - Set I = location of sprite for digit Vx.
-*   - 0xFX33: LD B, Vx - Store BCD representation of Vx in memory locations I, I+1, and I+2.
-*   - 0xFX55: LD [I], Vx - Store registers V0 through Vx in memory starting at location I.
-*   - 0xFX65: LD Vx, [I] - Read registers V0 through Vx from memory starting at location I.
-*
-* @param chip8 Reference to the Chip8 instance.
-* @param opcode The 16-bit opcode value.
-*/
-void OpcodeHandler::handle_0xF(Chip8& chip8, uint16_t opcode) {
+/**
+ * @brief Handles 0xEXA1 opcode.
+ *
+ * Implements:
+ *   - 0xEXA1: SKNP Vx - Skip next instruction if key with the value of Vx is not pressed.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The decoded instruction.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_EXA1(Chip8& chip8, const Instruction& inst) {
+    if (chip8.key[chip8.V[inst.x] & 0x0F] == 0) {
+        chip8.pc += 4;
+    } else {
+        chip8.pc += 2;
+    }
+}
 
-    uint8_t x = (opcode & 0x0F00) >> 8;
+/**
+ * @brief Handles 0xFX07 opcode.
+ *
+ * Implements:
+ *   - 0xFX07: LD Vx, DT - Set Vx = delay timer value.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The decoded instruction.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_FX07(Chip8& chip8, const Instruction& inst) {
+    chip8.V[inst.x] = chip8.delay_timer;
+    if constexpr (L == TraceLevel::Full) chip8.eventLogger->log(RegisterEvent(chip8.cycleCount).set(inst.x, chip8.V[inst.x]));
+    chip8.pc += 2;
+}
 
-    switch(opcode & 0x00FF) {
-        case 0x0007: { /* FX07: LD Vx, DT */
-            chip8.V[x] = chip8.delay_timer;
-            EventLogger::pushLog(RegisterEvent(std::map<int, int>{{x, chip8.V[x]}}));
-            chip8.pc += 2;
-            break;
-        }
-        case 0x000A: { /* FX0A: LD Vx, K */
-            bool keyPressed = false;
-            for (int i = 0; i < 16; ++i) {
-                if (chip8.key[i] != 0) {
-                    chip8.V[x] = i;
-                    EventLogger::pushLog(RegisterEvent(std::map<int, int>{{x, chip8.V[x]}}));
-                    keyPressed = true;
-                    break;
-                }
-            }
-            if (!keyPressed) {
-                return; // Skip incrementing pc to wait for a key press
-            }
-            chip8.pc += 2;
-            break;
-        }
-        case 0x0015: { /* FX15: LD DT, Vx */
-            chip8.delay_timer = chip8.V[x];
-                EventLogger::pushLog(MemoryEvent(std::map<uint16_t, int>{{0xFFFF, chip8.delay_timer}})); // Use 0xFFFF for delay_timer
-            chip8.pc += 2;
-            break;
-        }
-        case 0x0018: { /* FX18: LD ST, Vx */
-            chip8.sound_timer = chip8.V[x];
-            EventLogger::pushLog(MemoryEvent(std::map<uint16_t, int>{{0xFFFE, chip8.sound_timer}})); // Use 0xFFFE for sound_timer
-            chip8.pc += 2;
-            break;
-        }
-        case 0x001E: { /* FX1E: ADD I, Vx */
-            chip8.I += chip8.V[x];
-            // Optionally log I changes as a RegisterEvent if desired
-            chip8.pc += 2;
-            break;
-        }
-        case 0x0029: { /* FX29: LD F, Vx */
-            chip8.I = chip8.V[x] * 5; // Each font character is 5 bytes
-            chip8.pc += 2;
-            break;
-        }
-        case 0x0033: { /* FX33: LD B, Vx */
-            uint8_t value = chip8.V[x];
-            chip8.memory[chip8.I]     = value / 100;
-            chip8.memory[chip8.I + 1] = (value / 10) % 10;
-            chip8.memory[chip8.I + 2] = value % 10;
-            EventLogger::pushLog(MemoryEvent({
-                {chip8.I, chip8.memory[chip8.I]},
-                {chip8.I + 1, chip8.memory[chip8.I + 1]},
-                {chip8.I + 2, chip8.memory[chip8.I + 2]}
-            }));
-            chip8.pc += 2;
-            break;
-        }
-        case 0x0055: { /* FX55: LD [I], Vx */
-            for (int i = 0; i <= x; ++i) {
-                chip8.memory[chip8.I + i] = chip8.V[i];
-            }
-            EventLogger::pushLog(MemoryEvent({
-                {chip8.I, chip8.memory[chip8.I]},
-                {chip8.I + 1, chip8.memory[chip8.I + 1]},
-                {chip8.I + 2, chip8.memory[chip8.I + 2]}
-            }));
-            chip8.pc += 2;
-            break;
-        }
-        case 0x0065: { /* FX65: LD Vx, [I] */
-            for (int i = 0; i <= x; ++i) {
-                chip8.V[i] = chip8.memory[chip8.I + i];
-            }
-            // Log all loaded registers
-            std::map<int, int> changes;
-            for (int i = 0; i <= x; ++i) {
-                changes[i] = chip8.V[i];
-            }
-            EventLogger::pushLog(RegisterEvent(changes));
+/**
+ * @brief Handles 0xFX0A opcode.
+ *
+ * Implements:
+ *   - 0xFX0A: LD Vx, K - Wait for a key press, store the value of the key in Vx.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The decoded instruction.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_FX0A(Chip8& chip8, const Instruction& inst) {
+    for (int i = 0; i < 16; ++i) {
+        if (chip8.key[i] != 0) {
+            chip8.V[inst.x] = i;
+            if constexpr (L == TraceLevel::Full) chip8.eventLogger->log(RegisterEvent(chip8.cycleCount).set(inst.x, chip8.V[inst.x]));
             chip8.pc += 2;
-            break;
+            return;
         }
-        default: {
-            std::cerr << "Unknown opcode [0xF000]: " << std::hex << opcode << std::endl;
-            chip8.pc += 2;
-            break;
+    }
+    // No key pressed: leave pc unchanged to wait for a key press
+    chip8.idleState = IdleState::WaitingForKey;
+}
+
+/**
+ * @brief Handles 0xFX15 opcode.
+ *
+ * Implements:
+ *   - 0xFX15: LD DT, Vx - Set delay timer = Vx.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The decoded instruction.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_FX15(Chip8& chip8, const Instruction& inst) {
+    chip8.delay_timer = chip8.V[inst.x];
+    if constexpr (L == TraceLevel::Full) chip8.eventLogger->log(TimerEvent(chip8.cycleCount, false, chip8.delay_timer));
+    chip8.pc += 2;
+}
+
+/**
+ * @brief Handles 0xFX18 opcode.
+ *
+ * Implements:
+ *   - 0xFX18: LD ST, Vx - Set sound timer = Vx.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The decoded instruction.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_FX18(Chip8& chip8, const Instruction& inst) {
+    chip8.sound_timer = chip8.V[inst.x];
+    if constexpr (L == TraceLevel::Full) chip8.eventLogger->log(TimerEvent(chip8.cycleCount, true, chip8.sound_timer));
+    chip8.pc += 2;
+}
+
+/**
+ * @brief Handles 0xFX1E opcode.
+ *
+ * Implements:
+ *   - 0xFX1E: ADD I, Vx - Set I = I + Vx.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The decoded instruction.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_FX1E(Chip8& chip8, const Instruction& inst) {
+    chip8.I += chip8.V[inst.x];
+    // Optionally log I changes as a RegisterEvent if desired
+    chip8.pc += 2;
+}
+
+/**
+ * @brief Handles 0xFX29 opcode.
+ *
+ * Implements:
+ *   - 0xFX29: LD F, Vx - Set I = location of sprite for digit Vx.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The decoded instruction.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_FX29(Chip8& chip8, const Instruction& inst) {
+    chip8.I = chip8.V[inst.x] * 5; // Each font character is 5 bytes
+    chip8.pc += 2;
+}
+
+/**
+ * @brief Handles 0xFX33 opcode.
+ *
+ * Implements:
+ *   - 0xFX33: LD B, Vx - Store BCD representation of Vx in memory locations I, I+1, and I+2.
+ *
+ * Invalidates any cached decodes of the written bytes.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The decoded instruction.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_FX33(Chip8& chip8, const Instruction& inst) {
+    uint8_t value = chip8.V[inst.x];
+    uint8_t digits[3] = {static_cast<uint8_t>(value / 100), static_cast<uint8_t>((value / 10) % 10),
+                         static_cast<uint8_t>(value % 10)};
+    chip8.memory.store(chip8.I, digits, 3);
+    chip8.invalidateCode(chip8.I, 3);
+    if constexpr (L == TraceLevel::Full) chip8.eventLogger->log(MemoryEvent(chip8.cycleCount, chip8.I, digits, 3));
+    chip8.pc += 2;
+}
+
+/**
+ * @brief Handles 0xFX55 opcode.
+ *
+ * Implements:
+ *   - 0xFX55: LD [I], Vx - Store registers V0 through Vx in memory starting at location I.
+ *
+ * Invalidates any cached decodes of the written bytes.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The decoded instruction.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_FX55(Chip8& chip8, const Instruction& inst) {
+    chip8.memory.store(chip8.I, chip8.V.data(), inst.x + 1);
+    chip8.invalidateCode(chip8.I, inst.x + 1);
+    if constexpr (L == TraceLevel::Full) chip8.eventLogger->log(MemoryEvent(chip8.cycleCount, chip8.I, chip8.V.data(), inst.x + 1));
+    chip8.pc += 2;
+}
+
+/**
+ * @brief Handles 0xFX65 opcode.
+ *
+ * Implements:
+ *   - 0xFX65: LD Vx, [I] - Read registers V0 through Vx from memory starting at location I.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The decoded instruction.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_FX65(Chip8& chip8, const Instruction& inst) {
+    for (int i = 0; i <= inst.x; ++i) {
+        chip8.V[i] = chip8.memory[chip8.I + i];
+    }
+    // Log all loaded registers
+    if constexpr (L == TraceLevel::Full) {
+        RegisterEvent changes(chip8.cycleCount);
+        for (int i = 0; i <= inst.x; ++i) {
+            changes.set(i, chip8.V[i]);
         }
+        chip8.eventLogger->log(changes);
     }
+    chip8.pc += 2;
 }
 
 /**
- * @brief Dispatches the given opcode to the appropriate handler based on its family.
+ * @brief Handles any opcode that decode() does not recognise.
+ *
+ * Reports the opcode and its family, then skips it.
  *
  * @param chip8 Reference to the Chip8 instance.
- * @param opcode The 16-bit opcode value.
+ * @param inst The decoded instruction.
  */
-void OpcodeHandler::dispatchOpcode(Chip8& chip8, uint16_t opcode) {
-    EventLogger::pushLog(OpcodeEvent(chip8.pc, opcode));
-    switch (opcode & 0xF000) {
-        case 0x0000: handle_0x0(chip8, opcode); break;
-        case 0x1000: handle_0x1(chip8, opcode); break;
-        case 0x2000: handle_0x2(chip8, opcode); break;
-        case 0x3000: handle_0x3(chip8, opcode); break;
-        case 0x4000: handle_0x4(chip8, opcode); break;
-        case 0x5000: handle_0x5(chip8, opcode); break;
-        case 0x6000: handle_0x6(chip8, opcode); break;
-        case 0x7000: handle_0x7(chip8, opcode); break;
-        case 0x8000: handle_0x8(chip8, opcode); break;
-        case 0x9000: handle_0x9(chip8, opcode); break;
-        case 0xA000: handle_0xA(chip8, opcode); break;
-        case 0xB000: handle_0xB(chip8, opcode); break;
-        case 0xC000: handle_0xC(chip8, opcode); break;
-        case 0xD000: handle_0xD(chip8, opcode); break;
-        case 0xE000: handle_0xE(chip8, opcode); break;
-        case 0xF000: handle_0xF(chip8, opcode); break;
-        default:
-            std::cerr << "Unknown opcode: " << std::hex << opcode << std::endl;
-            chip8.pc += 2;
-            break;
+template <TraceLevel L>
+void OpcodeHandler<L>::op_unknown(Chip8& chip8, const Instruction& inst) {
+    std::cerr << "Unknown opcode [0x" << std::hex << (inst.opcode & 0xF000) << "]: "
+              << inst.opcode << std::dec << std::endl;
+    chip8.pc += 2;
+}
+
+/**
+ * @brief Fused 0x6XNN; 0x7XNN superinstruction.
+ *
+ * Implements:
+ *   - LD Vx, NN followed by ADD Vy, NN.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The first instruction of the pair; the second is in the next block slot.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_6XNN_7XNN(Chip8& chip8, const Instruction& inst) {
+    op_6XNN(chip8, inst);
+    op_7XNN(chip8, (&inst)[1]);
+}
+
+/**
+ * @brief Fused 0xANNN; 0xDXYN superinstruction.
+ *
+ * Implements:
+ *   - LD I, addr followed by DRW Vx, Vy, nibble.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The first instruction of the pair; the second is in the next block slot.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_ANNN_DXYN(Chip8& chip8, const Instruction& inst) {
+    op_ANNN(chip8, inst);
+    op_DXYN(chip8, (&inst)[1]);
+}
+
+/**
+ * @brief Fused 0x3XNN; 0x1NNN superinstruction.
+ *
+ * Implements:
+ *   - SE Vx, NN followed by JP addr: if Vx == NN the jump is skipped,
+ *     otherwise control transfers to NNN.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param inst The first instruction of the pair; the second is in the next block slot.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::op_3XNN_1NNN(Chip8& chip8, const Instruction& inst) {
+    if (chip8.V[inst.x] == inst.nn) {
+        chip8.pc += 4;
+    } else {
+        detectIdleLoop(chip8, chip8.pc + 2, (&inst)[1].nnn);
+        chip8.pc = (&inst)[1].nnn;
     }
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Decodes and executes an opcode without going through a cache.
+ *
+ * @param chip8 Reference to the Chip8 instance.
+ * @param opcode The 16-bit opcode value.
+ */
+template <TraceLevel L>
+void OpcodeHandler<L>::dispatchOpcode(Chip8& chip8, uint16_t opcode) {
+    if constexpr (L != TraceLevel::None) chip8.eventLogger->log(OpcodeEvent(chip8.cycleCount, chip8.pc, opcode));
+    Instruction inst = decode(opcode);
+    inst.handler(chip8, inst);
+}
+
+// Every level is compiled here; Chip8 picks one at runtime (see Chip8::setTraceLevel()).
+template class OpcodeHandler<TraceLevel::None>;
+template class OpcodeHandler<TraceLevel::Opcodes>;
+template class OpcodeHandler<TraceLevel::Full>;
@@ -0,0 +1,174 @@
+#include "paged_memory.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Fixed-size block allocator for pages.
+ *
+ * Pages are carved out of slabs and recycled through a free list. Slabs are
+ * never returned, so a page freed on one thread can be reused on any other.
+ */
+class PagePool {
+public:
+    static constexpr size_t SLAB_PAGES = 64;
+
+    PagedMemory::Page* allocate() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (free_.empty()) {
+            slabs_.push_back(std::make_unique<PagedMemory::Page[]>(SLAB_PAGES));
+            for (size_t i = 0; i < SLAB_PAGES; ++i) {
+                free_.push_back(&slabs_.back()[i]);
+            }
+        }
+        PagedMemory::Page* page = free_.back();
+        free_.pop_back();
+        return page;
+    }
+
+    void free(PagedMemory::Page* page) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        free_.push_back(page);
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<PagedMemory::Page[]>> slabs_;
+    std::vector<PagedMemory::Page*> free_;
+};
+
+PagePool& pagePool() {
+    static PagePool pool;
+    return pool;
+}
+
+// The shared all-zero page. It is not reference counted: its count stays 0,
+// so no instance ever owns it and a store always copies it first.
+PagedMemory::Page zeroPage{};
+
+} // namespace
+
+/**
+ * @brief Creates an all-zero memory backed entirely by the zero page.
+ */
+PagedMemory::PagedMemory() : contentHash(0) {
+    for (Page*& page : pages) {
+        page = &zeroPage;
+    }
+}
+
+/**
+ * @brief Shares every page of other; nothing is copied until a store.
+ *
+ * @param other Memory to share.
+ */
+PagedMemory::PagedMemory(const PagedMemory& other) : contentHash(other.contentHash) {
+    for (size_t i = 0; i < PAGE_COUNT; ++i) {
+        pages[i] = other.pages[i];
+        retain(pages[i]);
+    }
+}
+
+/**
+ * @brief Drops the current pages and shares every page of other.
+ *
+ * @param other Memory to share.
+ * @return PagedMemory& This memory.
+ */
+PagedMemory& PagedMemory::operator=(const PagedMemory& other) {
+    for (size_t i = 0; i < PAGE_COUNT; ++i) {
+        retain(other.pages[i]);
+        release(pages[i]);
+        pages[i] = other.pages[i];
+    }
+    contentHash = other.contentHash;
+    return *this;
+}
+
+PagedMemory::~PagedMemory() {
+    for (Page* page : pages) {
+        release(page);
+    }
+}
+
+/**
+ * @brief Writes a byte range, wrapping at 4 KiB.
+ *
+ * @param address First address written.
+ * @param data Bytes to write.
+ * @param size Number of bytes.
+ */
+void PagedMemory::store(uint16_t address, const uint8_t* data, size_t size) {
+    while (size > 0) {
+        address &= SIZE - 1;
+        size_t offset = address % PAGE_SIZE;
+        size_t run = std::min(size, PAGE_SIZE - offset);
+        uint8_t* bytes = writablePage(address / PAGE_SIZE) + offset;
+        uint64_t hash = contentHash;   // Kept local: stores through bytes could alias it
+        for (size_t i = 0; i < run; ++i) {
+            uint16_t at = static_cast<uint16_t>(address + i);
+            hash ^= byteKey(at, bytes[i]) ^ byteKey(at, data[i]);
+        }
+        contentHash = hash;
+        std::memcpy(bytes, data, run);
+        address = static_cast<uint16_t>(address + run);
+        data += run;
+        size -= run;
+    }
+}
+
+/**
+ * @brief Copies the whole address space into a flat buffer.
+ *
+ * @param out Receives SIZE bytes.
+ */
+void PagedMemory::copyTo(uint8_t* out) const {
+    for (size_t i = 0; i < PAGE_COUNT; ++i) {
+        std::memcpy(out + i * PAGE_SIZE, pages[i]->bytes, PAGE_SIZE);
+    }
+}
+
+/**
+ * @brief Sets every byte to zero by sharing the zero page everywhere.
+ */
+void PagedMemory::clear() {
+    for (Page*& page : pages) {
+        release(page);
+        page = &zeroPage;
+    }
+    contentHash = 0;
+}
+
+/**
+ * @brief Replaces a shared page with a private copy.
+ *
+ * @param index Page to copy.
+ */
+void PagedMemory::detach(size_t index) {
+    Page* copy = pagePool().allocate();
+    std::memcpy(copy->bytes, pages[index]->bytes, PAGE_SIZE);
+    copy->refs.store(1, std::memory_order_relaxed);
+    release(pages[index]);
+    pages[index] = copy;
+}
+
+void PagedMemory::retain(Page* page) {
+    if (page != &zeroPage) {
+        page->refs.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+/**
+ * @brief Drops one reference, returning the page to the pool with the last one.
+ *
+ * @param page Page to release.
+ */
+void PagedMemory::release(Page* page) {
+    if (page != &zeroPage && page->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        pagePool().free(page);
+    }
+}
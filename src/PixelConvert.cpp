@@ -0,0 +1,128 @@
+#include "pixel_convert.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <immintrin.h>
+#define PIXEL_CONVERT_SSE2 1
+#if defined(__GNUC__) || defined(__clang__)
+#define PIXEL_CONVERT_AVX2 1
+#endif
+#endif
+
+// Pixels per packed row.
+const int ROW_PIXELS = 64;
+
+using ExpandRowFn = void (*)(uint64_t row, uint32_t* out, uint32_t onColor, uint32_t offColor);
+
+/**
+ * @brief Portable fallback: one select per pixel.
+ */
+[[maybe_unused]] static void expandRowScalar(uint64_t row, uint32_t* out, uint32_t onColor, uint32_t offColor) {
+    for (int x = 0; x < ROW_PIXELS; ++x) {
+        out[x] = ((row >> (ROW_PIXELS - 1 - x)) & 1) ? onColor : offColor;
+    }
+}
+
+#ifdef PIXEL_CONVERT_SSE2
+/**
+ * @brief SSE2 kernel: 4 pixels per compare.
+ *
+ * The 4 bits of a pixel group are broadcast to every lane, each lane keeps
+ * its own bit, and the compare turns it into an all-ones select mask.
+ */
+static void expandRowSse2(uint64_t row, uint32_t* out, uint32_t onColor, uint32_t offColor) {
+    const __m128i bits = _mm_set_epi32(1, 2, 4, 8);
+    const __m128i on = _mm_set1_epi32(static_cast<int>(onColor));
+    const __m128i off = _mm_set1_epi32(static_cast<int>(offColor));
+    for (int group = 0; group < ROW_PIXELS / 4; ++group) {
+        int nibble = static_cast<int>((row >> (ROW_PIXELS - 4 - group * 4)) & 0xF);
+        __m128i lit = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(nibble), bits), bits);
+        __m128i pixels = _mm_or_si128(_mm_and_si128(lit, on), _mm_andnot_si128(lit, off));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + group * 4), pixels);
+    }
+}
+#endif
+
+#ifdef PIXEL_CONVERT_AVX2
+/**
+ * @brief AVX2 kernel: 8 pixels (one sprite byte) per compare.
+ *
+ * Compiled for AVX2 regardless of the global target flags and only called
+ * after a runtime CPU check.
+ */
+__attribute__((target("avx2")))
+static void expandRowAvx2(uint64_t row, uint32_t* out, uint32_t onColor, uint32_t offColor) {
+    const __m256i bits = _mm256_set_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+    const __m256i on = _mm256_set1_epi32(static_cast<int>(onColor));
+    const __m256i off = _mm256_set1_epi32(static_cast<int>(offColor));
+    for (int group = 0; group < ROW_PIXELS / 8; ++group) {
+        int byte = static_cast<int>((row >> (ROW_PIXELS - 8 - group * 8)) & 0xFF);
+        __m256i lit = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(byte), bits), bits);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + group * 8), _mm256_blendv_epi8(off, on, lit));
+    }
+}
+#endif
+
+/**
+ * @brief Picks the widest kernel the CPU supports.
+ *
+ * @return ExpandRowFn The selected row kernel.
+ */
+static ExpandRowFn selectKernel() {
+#ifdef PIXEL_CONVERT_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        return expandRowAvx2;
+    }
+#endif
+#ifdef PIXEL_CONVERT_SSE2
+    return expandRowSse2;
+#else
+    return expandRowScalar;
+#endif
+}
+
+/**
+ * @brief Returns the row kernel, selecting it on first use.
+ */
+static ExpandRowFn rowKernel() {
+    static const ExpandRowFn kernel = selectKernel();
+    return kernel;
+}
+
+/**
+ * @brief Expands packed 1-bit display rows into 32-bit pixels.
+ *
+ * @param rows First packed row to convert.
+ * @param count Number of rows to convert.
+ * @param dst Destination of the first row.
+ * @param pitch Distance in bytes between destination rows.
+ * @param onColor Pixel value for lit pixels.
+ * @param offColor Pixel value for unlit pixels.
+ */
+void expandRows(const uint64_t* rows, size_t count, void* dst, size_t pitch,
+                uint32_t onColor, uint32_t offColor) {
+    ExpandRowFn expandRow = rowKernel();
+    uint8_t* line = static_cast<uint8_t*>(dst);
+    for (size_t i = 0; i < count; ++i) {
+        expandRow(rows[i], reinterpret_cast<uint32_t*>(line), onColor, offColor);
+        line += pitch;
+    }
+}
+
+/**
+ * @brief Name of the kernel expandRows() dispatches to.
+ *
+ * @return const char* "avx2", "sse2" or "scalar".
+ */
+const char* pixelConvertKernel() {
+#ifdef PIXEL_CONVERT_AVX2
+    if (rowKernel() == expandRowAvx2) {
+        return "avx2";
+    }
+#endif
+#ifdef PIXEL_CONVERT_SSE2
+    if (rowKernel() == expandRowSse2) {
+        return "sse2";
+    }
+#endif
+    return "scalar";
+}
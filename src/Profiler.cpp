@@ -0,0 +1,402 @@
+#include "profiler.h"
+#include "opcode.h"
+#include <algorithm>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+const char* const FAMILY_NAMES[Profiler::FAMILY_COUNT] = {
+    "00E0", "00EE", "1NNN", "2NNN", "3XNN", "4XNN", "5XY0", "6XNN", "7XNN",
+    "8XY0", "8XY1", "8XY2", "8XY3", "8XY4", "8XY5", "8XY6", "8XY7", "8XYE",
+    "9XY0", "ANNN", "BNNN", "CXNN", "DXYN", "EX9E", "EXA1",
+    "FX07", "FX0A", "FX15", "FX18", "FX1E", "FX29", "FX33", "FX55", "FX65",
+    "unknown"
+};
+
+const size_t FAMILY_UNKNOWN = Profiler::FAMILY_COUNT - 1;
+
+// Set by the SIGUSR1 handler, cleared by takeDumpRequest(). Lock-free, so
+// the handler may touch it.
+std::atomic<bool> dumpRequested{false};
+
+#ifdef SIGUSR1
+extern "C" void requestDump(int) {
+    dumpRequested.store(true, std::memory_order_relaxed);
+}
+#endif
+
+/**
+ * @brief Measures the cheapest back-to-back pair of clock reads.
+ */
+uint64_t measureClockOverhead() {
+    uint64_t best = UINT64_MAX;
+    for (int i = 0; i < 64; ++i) {
+        uint64_t start = Profiler::now();
+        best = std::min(best, Profiler::now() - start);
+    }
+    return best;
+}
+
+} // namespace
+
+/**
+ * @brief Creates an empty profiler; the wall clock starts with start().
+ *
+ * @param sampleInterval Instructions between timed samples; 0 is treated as 1.
+ */
+Profiler::Profiler(uint32_t sampleInterval)
+    : sampleInterval(std::max<uint32_t>(sampleInterval, 1)), untilSample(this->sampleInterval),
+      clockOverheadNs(measureClockOverhead()), instructions(0), familyCounts{}, familySamples{},
+      familySampleNs{}, pcCounts{}, pcOpcodes{}, current(0), overflowDepth(0), frames(0), renders(0),
+      renderNs(0), renderMaxNs(0), queueSamples(0), queueDepthSum(0), queueDepthMax(0), startNs(now()),
+      stopNs(0) {
+    nodes.push_back({0, 0, 0, 0});
+}
+
+/**
+ * @brief Maps an opcode to its family, following OpcodeHandler::decode().
+ *
+ * @param opcode The instruction.
+ * @return size_t Index into the family tables.
+ */
+size_t Profiler::familyOf(uint16_t opcode) {
+    uint8_t low = opcode & 0x00FF;
+    switch (opcode >> 12) {
+        case 0x0: return low == 0xE0 ? 0 : low == 0xEE ? 1 : FAMILY_UNKNOWN;
+        case 0x8: {
+            uint8_t n = opcode & 0x000F;
+            return n <= 7 ? 9 + n : n == 0xE ? 17 : FAMILY_UNKNOWN;
+        }
+        case 0x9: return 18;
+        case 0xA: return 19;
+        case 0xB: return 20;
+        case 0xC: return 21;
+        case 0xD: return 22;
+        case 0xE: return low == 0x9E ? 23 : low == 0xA1 ? 24 : FAMILY_UNKNOWN;
+        case 0xF:
+            switch (low) {
+                case 0x07: return 25;
+                case 0x0A: return 26;
+                case 0x15: return 27;
+                case 0x18: return 28;
+                case 0x1E: return 29;
+                case 0x29: return 30;
+                case 0x33: return 31;
+                case 0x55: return 32;
+                case 0x65: return 33;
+            }
+            return FAMILY_UNKNOWN;
+        default: return (opcode >> 12) + 1;   // 1NNN..7XNN
+    }
+}
+
+const char* Profiler::familyName(size_t family) {
+    return family < FAMILY_COUNT ? FAMILY_NAMES[family] : "invalid";
+}
+
+/**
+ * @brief Records the instructions a translated block retired.
+ *
+ * Slot i of a block holds the instruction at start + 2i, and fusing only
+ * replaces handlers, so every slot still carries its own opcode. Only the
+ * last instruction that ran can be a call or a return. A sampled block's
+ * time is split evenly over its instructions.
+ *
+ * @param start Address of the block's first instruction.
+ * @param code The block's threaded code.
+ * @param ran How many of its instructions ran.
+ * @param elapsedNs Time taken if the block was sampled, otherwise 0.
+ */
+void Profiler::recordBlock(uint16_t start, const Instruction* code, uint16_t ran, uint64_t elapsedNs) {
+    uint64_t share = 0;
+    if (elapsedNs > 0) {
+        share = (elapsedNs > clockOverheadNs ? elapsedNs - clockOverheadNs : 0) / ran;
+    }
+    for (uint16_t i = 0; i < ran; ++i) {
+        uint16_t address = (start + 2 * i) & (MEMORY_SIZE - 1);
+        size_t family = familyOf(code[i].opcode);
+        ++familyCounts[family];
+        ++pcCounts[address];
+        pcOpcodes[address] = code[i].opcode;
+        if (elapsedNs > 0) {
+            ++familySamples[family];
+            familySampleNs[family] += share;
+        }
+    }
+    nodes[current].self += ran;
+    instructions += ran;
+    followCall(familyOf(code[ran - 1].opcode), code[ran - 1].opcode);
+}
+
+/**
+ * @brief Charges a timed sample to one instruction, less the clock overhead.
+ *
+ * @param opcode The instruction.
+ * @param elapsedNs Time taken, including the clock reads.
+ */
+void Profiler::recordSample(uint16_t opcode, uint64_t elapsedNs) {
+    size_t family = familyOf(opcode);
+    ++familySamples[family];
+    familySampleNs[family] += elapsedNs > clockOverheadNs ? elapsedNs - clockOverheadNs : 0;
+}
+
+void Profiler::resetCallStack() {
+    current = 0;
+    overflowDepth = 0;
+}
+
+void Profiler::start() {
+    startNs = now();
+    stopNs = 0;
+}
+
+void Profiler::stop() {
+    stopNs = now();
+}
+
+/**
+ * @brief Adds the duration of one render.
+ *
+ * @param elapsedNs Render time.
+ */
+void Profiler::recordRender(uint64_t elapsedNs) {
+    renders.fetch_add(1, std::memory_order_relaxed);
+    renderNs.fetch_add(elapsedNs, std::memory_order_relaxed);
+    uint64_t max = renderMaxNs.load(std::memory_order_relaxed);
+    while (elapsedNs > max && !renderMaxNs.compare_exchange_weak(max, elapsedNs, std::memory_order_relaxed)) {
+    }
+}
+
+/**
+ * @brief Samples the EventLogger queue depth.
+ *
+ * @param depth Events currently queued.
+ */
+void Profiler::recordQueueDepth(size_t depth) {
+    ++queueSamples;
+    queueDepthSum += depth;
+    queueDepthMax = std::max(queueDepthMax, depth);
+}
+
+/**
+ * @brief Enters a subroutine: moves to the child node for its address.
+ *
+ * Past MAX_CALL_DEPTH, or once the tree is full, the call stays on the
+ * current node and only its matching return is tracked.
+ *
+ * @param address Subroutine entry point.
+ */
+void Profiler::enterCall(uint16_t address) {
+    if (overflowDepth == 0 && nodes[current].depth < MAX_CALL_DEPTH) {
+        uint32_t child = childOf(current, address);
+        if (child != NO_NODE) {
+            current = child;
+            return;
+        }
+    }
+    ++overflowDepth;
+}
+
+/**
+ * @brief Returns from a subroutine. A return with no call on the shadow
+ *        stack (e.g. after a state restore) stays at the root.
+ */
+void Profiler::leaveCall() {
+    if (overflowDepth > 0) {
+        --overflowDepth;
+    } else if (current != 0) {
+        current = nodes[current].parent;
+    }
+}
+
+/**
+ * @brief Finds or creates the call node for address under parent.
+ *
+ * @param parent Calling node.
+ * @param address Subroutine entry point.
+ * @return uint32_t The child node, or NO_NODE if it is new and the tree is full.
+ */
+uint32_t Profiler::childOf(uint32_t parent, uint16_t address) {
+    uint64_t key = static_cast<uint64_t>(parent) << 12 | address;
+    auto found = children.find(key);
+    if (found != children.end()) {
+        return found->second;
+    }
+    if (nodes.size() >= MAX_CALL_NODES) {
+        return NO_NODE;
+    }
+    uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back({address, parent, nodes[parent].depth + 1, 0});
+    children.emplace(key, index);
+    return index;
+}
+
+/**
+ * @brief Adds another profiler's counters and call tree to this one.
+ *
+ * Call paths are matched by their sequence of entry addresses. Since parents
+ * precede their children in other.nodes, one pass maps every node. Paths
+ * that no longer fit are charged to their deepest ancestor that does.
+ *
+ * @param other Profiler to add; not modified.
+ */
+void Profiler::merge(const Profiler& other) {
+    std::lock_guard<std::mutex> lock(mergeMutex);
+    instructions += other.instructions;
+    for (size_t f = 0; f < FAMILY_COUNT; ++f) {
+        familyCounts[f] += other.familyCounts[f];
+        familySamples[f] += other.familySamples[f];
+        familySampleNs[f] += other.familySampleNs[f];
+    }
+    for (size_t a = 0; a < MEMORY_SIZE; ++a) {
+        pcCounts[a] += other.pcCounts[a];
+        if (other.pcCounts[a] != 0) {
+            pcOpcodes[a] = other.pcOpcodes[a];
+        }
+    }
+
+    std::vector<uint32_t> mapped(other.nodes.size());
+    mapped[0] = 0;
+    nodes[0].self += other.nodes[0].self;
+    for (size_t i = 1; i < other.nodes.size(); ++i) {
+        const CallNode& node = other.nodes[i];
+        uint32_t child = childOf(mapped[node.parent], node.address);
+        mapped[i] = child != NO_NODE ? child : mapped[node.parent];
+        nodes[mapped[i]].self += node.self;
+    }
+
+    frames += other.frames;
+    renders.fetch_add(other.renders.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    renderNs.fetch_add(other.renderNs.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    uint64_t otherMax = other.renderMaxNs.load(std::memory_order_relaxed);
+    if (otherMax > renderMaxNs.load(std::memory_order_relaxed)) {
+        renderMaxNs.store(otherMax, std::memory_order_relaxed);
+    }
+    queueSamples += other.queueSamples;
+    queueDepthSum += other.queueDepthSum;
+    queueDepthMax = std::max(queueDepthMax, other.queueDepthMax);
+}
+
+double Profiler::elapsedSeconds() const {
+    uint64_t end = stopNs != 0 ? stopNs : now();
+    return (end - startNs) / 1e9;
+}
+
+/**
+ * @brief Writes the report to prefix.txt and the folded stacks to prefix.folded.
+ *
+ * @param prefix Path prefix of both files.
+ * @return true if both files were written.
+ */
+bool Profiler::dump(const std::string& prefix) const {
+    std::lock_guard<std::mutex> lock(mergeMutex);
+    std::ofstream report(prefix + ".txt");
+    std::ofstream folded(prefix + ".folded");
+    if (!report.is_open() || !folded.is_open()) {
+        std::cerr << "Failed to write profile: " << prefix << std::endl;
+        return false;
+    }
+    writeReport(report);
+    writeFolded(folded);
+    return report.good() && folded.good();
+}
+
+/**
+ * @brief Writes the summary, the per-family table and the hotspot histogram.
+ *
+ * Each section is a CSV table with a header row, separated by blank lines.
+ * Families are listed by count and addresses by count, most frequent first;
+ * never-executed families and addresses are left out.
+ *
+ * @param out Stream to write to.
+ */
+void Profiler::writeReport(std::ostream& out) const {
+    double seconds = elapsedSeconds();
+    uint64_t renderCount = renders.load(std::memory_order_relaxed);
+    out << std::fixed << std::setprecision(3)
+        << "metric,value\n"
+        << "instructions," << instructions << '\n'
+        << "wall_seconds," << seconds << '\n'
+        << "instructions_per_second," << (seconds > 0 ? instructions / seconds : 0.0) << '\n'
+        << "frames," << frames << '\n'
+        << "frames_per_second," << (seconds > 0 ? frames / seconds : 0.0) << '\n'
+        << "renders," << renderCount << '\n'
+        << "render_avg_ms," << (renderCount > 0 ? renderNs.load(std::memory_order_relaxed) / 1e6 / renderCount : 0.0) << '\n'
+        << "render_max_ms," << renderMaxNs.load(std::memory_order_relaxed) / 1e6 << '\n'
+        << "event_queue_depth_avg," << (queueSamples > 0 ? static_cast<double>(queueDepthSum) / queueSamples : 0.0) << '\n'
+        << "event_queue_depth_max," << queueDepthMax << '\n'
+        << "sample_interval," << sampleInterval << '\n'
+        << "clock_overhead_ns," << clockOverheadNs << '\n';
+
+    std::vector<size_t> families;
+    for (size_t f = 0; f < FAMILY_COUNT; ++f) {
+        if (familyCounts[f] != 0) {
+            families.push_back(f);
+        }
+    }
+    std::stable_sort(families.begin(), families.end(),
+                     [&](size_t a, size_t b) { return familyCounts[a] > familyCounts[b]; });
+    out << "\nfamily,count,percent,samples,avg_ns\n";
+    for (size_t f : families) {
+        out << FAMILY_NAMES[f] << ',' << familyCounts[f] << ','
+            << (instructions > 0 ? 100.0 * familyCounts[f] / instructions : 0.0) << ','
+            << familySamples[f] << ','
+            << (familySamples[f] > 0 ? static_cast<double>(familySampleNs[f]) / familySamples[f] : 0.0) << '\n';
+    }
+
+    std::vector<uint16_t> addresses;
+    for (uint16_t a = 0; a < MEMORY_SIZE; ++a) {
+        if (pcCounts[a] != 0) {
+            addresses.push_back(a);
+        }
+    }
+    std::stable_sort(addresses.begin(), addresses.end(),
+                     [&](uint16_t a, uint16_t b) { return pcCounts[a] > pcCounts[b]; });
+    out << "\naddress,count,percent,opcode\n";
+    for (uint16_t a : addresses) {
+        out << "0x" << std::hex << std::uppercase << std::setw(3) << std::setfill('0') << a << ','
+            << std::dec << pcCounts[a] << ',' << (instructions > 0 ? 100.0 * pcCounts[a] / instructions : 0.0)
+            << ",0x" << std::hex << std::setw(4) << pcOpcodes[a] << std::dec << std::nouppercase
+            << std::setfill(' ') << '\n';
+    }
+}
+
+/**
+ * @brief Writes the call tree in the folded-stack format.
+ *
+ * @param out Stream to write to.
+ */
+void Profiler::writeFolded(std::ostream& out) const {
+    std::vector<std::string> paths(nodes.size());
+    paths[0] = "main";
+    for (size_t i = 1; i < nodes.size(); ++i) {
+        char frame[16];
+        std::snprintf(frame, sizeof(frame), ";sub_0x%03X", nodes[i].address);
+        paths[i] = paths[nodes[i].parent] + frame;
+    }
+    for (size_t i = 0; i < nodes.size(); ++i) {
+        if (nodes[i].self != 0) {
+            out << paths[i] << ' ' << nodes[i].self << '\n';
+        }
+    }
+}
+
+/**
+ * @brief Makes SIGUSR1 request a dump; a no-op where SIGUSR1 does not exist.
+ *
+ * The handler only sets a flag: the program polls takeDumpRequest() from
+ * the thread that owns the profiler and dumps from there.
+ */
+void Profiler::installSignalHandler() {
+#ifdef SIGUSR1
+    std::signal(SIGUSR1, requestDump);
+#endif
+}
+
+bool Profiler::takeDumpRequest() {
+    return dumpRequested.exchange(false, std::memory_order_relaxed);
+}
@@ -0,0 +1,302 @@
+#include "rewind_buffer.h"
+#include "trace_format.h"
+#include <algorithm>
+#include <cstring>
+
+// Shortest run of equal bytes worth ending a literal for; shorter gaps cost
+// more in varint headers than copying them as zero XOR bytes.
+const size_t MIN_SKIP = 4;
+
+/**
+ * @brief Creates an empty buffer.
+ *
+ * @param memoryBudget Upper bound on allocated bytes.
+ * @param keyframeInterval Frames per keyframe group.
+ */
+RewindBuffer::RewindBuffer(size_t memoryBudget, uint32_t keyframeInterval)
+    : memoryBudget(memoryBudget), keyframeInterval(keyframeInterval > 0 ? keyframeInterval : 1),
+      memoryUsed(0), nextFrame(0), evictedFrames(0), cursorFrame(0), cursorValid(false) {}
+
+/**
+ * @brief Changes the memory budget, evicting old groups if it shrank.
+ *
+ * @param bytes New budget in bytes.
+ */
+void RewindBuffer::setMemoryBudget(size_t bytes) {
+    memoryBudget = bytes;
+    evict();
+}
+
+/**
+ * @brief Appends the XOR of current and previous as run-length encoded pairs.
+ *
+ * Each pair is a varint count of equal bytes to skip, a varint count of
+ * differing bytes, and those bytes XORed. Trailing equal bytes are implied.
+ *
+ * @param current Snapshot being stored.
+ * @param previous Snapshot it is relative to, or nullptr for a keyframe.
+ * @param out Receives the encoding.
+ */
+void RewindBuffer::encode(const uint8_t* current, const uint8_t* previous, std::vector<uint8_t>& out) {
+    static const uint8_t zeros[sizeof(Chip8State)] = {};
+    if (!previous) {
+        previous = zeros;
+    }
+    const size_t size = sizeof(Chip8State);
+    size_t pos = 0;
+    while (pos < size) {
+        size_t skipStart = pos;
+        while (pos + 8 <= size && std::memcmp(current + pos, previous + pos, 8) == 0) {
+            pos += 8;
+        }
+        while (pos < size && current[pos] == previous[pos]) {
+            ++pos;
+        }
+        if (pos == size) {
+            break;
+        }
+
+        size_t literalStart = pos;
+        size_t equalRun = 0;
+        while (pos < size && equalRun < MIN_SKIP) {
+            equalRun = current[pos] == previous[pos] ? equalRun + 1 : 0;
+            ++pos;
+        }
+        size_t literalEnd = pos - equalRun;
+
+        trace::putVarint(out, literalStart - skipStart);
+        trace::putVarint(out, literalEnd - literalStart);
+        for (size_t i = literalStart; i < literalEnd; ++i) {
+            out.push_back(current[i] ^ previous[i]);
+        }
+        pos = literalEnd;
+    }
+}
+
+/**
+ * @brief XORs one encoded frame into a snapshot.
+ *
+ * Applying a delta to either of the two frames it relates yields the other;
+ * applying a keyframe to a zeroed snapshot yields the keyframe.
+ *
+ * @param in Start of the encoding.
+ * @param end End of the encoding.
+ * @param state Snapshot bytes to update in place.
+ */
+void RewindBuffer::apply(const uint8_t* in, const uint8_t* end, uint8_t* state) {
+    size_t pos = 0;
+    uint64_t skip, length;
+    while (in < end && trace::getVarint(in, end, skip) && trace::getVarint(in, end, length)) {
+        pos += skip;
+        length = std::min<uint64_t>({length, static_cast<uint64_t>(end - in), sizeof(Chip8State) - pos});
+        for (uint64_t i = 0; i < length; ++i) {
+            state[pos++] ^= *in++;
+        }
+    }
+}
+
+/**
+ * @brief XORs frame index of a group into a snapshot.
+ */
+void RewindBuffer::applyFrame(const Group& group, size_t index, uint8_t* state) const {
+    const uint8_t* base = group.data.data();
+    size_t end = index + 1 < group.offsets.size() ? group.offsets[index + 1] : group.data.size();
+    apply(base + group.offsets[index], base + end, state);
+}
+
+/**
+ * @brief Bytes a group holds allocated.
+ */
+size_t RewindBuffer::allocatedBytes(const Group& group) {
+    return group.data.capacity() + group.offsets.capacity() * sizeof(uint32_t);
+}
+
+/**
+ * @brief Appends the snapshot of a new frame.
+ *
+ * Starts a new group with a keyframe every keyframeInterval frames, trimming
+ * the finished group to its exact size, then evicts the oldest groups while
+ * over budget.
+ *
+ * @param state The machine state at the end of the frame.
+ */
+void RewindBuffer::push(const Chip8State& state) {
+    bool keyframe = groups.empty() || groups.back().offsets.size() >= keyframeInterval;
+    if (keyframe) {
+        if (!groups.empty()) {
+            // The previous group is complete; give back its growth slack
+            Group& previous = groups.back();
+            memoryUsed -= allocatedBytes(previous);
+            previous.data.shrink_to_fit();
+            previous.offsets.shrink_to_fit();
+            memoryUsed += allocatedBytes(previous);
+        }
+        groups.emplace_back();
+        groups.back().firstFrame = nextFrame;
+    }
+    Group& group = groups.back();
+    size_t before = allocatedBytes(group);
+    group.offsets.push_back(static_cast<uint32_t>(group.data.size()));
+    encode(reinterpret_cast<const uint8_t*>(&state),
+           keyframe ? nullptr : reinterpret_cast<const uint8_t*>(&newest), group.data);
+    memoryUsed += allocatedBytes(group) - before;
+
+    newest = state;
+    cursor = state;
+    cursorFrame = nextFrame;
+    cursorValid = true;
+    ++nextFrame;
+    evict();
+}
+
+/**
+ * @brief Drops the oldest groups while over budget, always keeping the newest.
+ */
+void RewindBuffer::evict() {
+    while (memoryUsed > memoryBudget && groups.size() > 1) {
+        const Group& oldest = groups.front();
+        memoryUsed -= allocatedBytes(oldest);
+        evictedFrames += oldest.offsets.size();
+        if (cursorValid && cursorFrame < oldest.firstFrame + oldest.offsets.size()) {
+            cursorValid = false;
+        }
+        groups.pop_front();
+    }
+}
+
+/**
+ * @brief Finds the group holding a frame.
+ *
+ * @param frame Frame number.
+ * @return Group* The group, or nullptr if the frame is not held.
+ */
+RewindBuffer::Group* RewindBuffer::findGroup(uint64_t frame) {
+    if (groups.empty() || frame < groups.front().firstFrame || frame >= nextFrame) {
+        return nullptr;
+    }
+    auto it = std::upper_bound(groups.begin(), groups.end(), frame,
+                               [](uint64_t f, const Group& g) { return f < g.firstFrame; });
+    return &*(it - 1);
+}
+
+/**
+ * @brief Reconstructs a held frame without changing the history.
+ *
+ * Starts from the last reconstructed frame when it is in the same group and
+ * closer than the keyframe, otherwise from the keyframe, and applies one
+ * delta per frame in between.
+ *
+ * @param frame Frame number.
+ * @param out Receives the snapshot.
+ * @return bool False if the frame is not held.
+ */
+bool RewindBuffer::seek(uint64_t frame, Chip8State& out) {
+    Group* group = findGroup(frame);
+    if (!group) {
+        return false;
+    }
+    size_t target = static_cast<size_t>(frame - group->firstFrame);
+    uint8_t* state = reinterpret_cast<uint8_t*>(&cursor);
+
+    size_t index;
+    bool sameGroup = cursorValid && cursorFrame >= group->firstFrame &&
+                     cursorFrame < group->firstFrame + group->offsets.size();
+    size_t cursorIndex = sameGroup ? static_cast<size_t>(cursorFrame - group->firstFrame) : 0;
+    size_t cursorDistance = cursorIndex > target ? cursorIndex - target : target - cursorIndex;
+    if (sameGroup && cursorDistance <= target) {
+        index = cursorIndex;
+    } else {
+        std::memset(state, 0, sizeof(Chip8State));
+        applyFrame(*group, 0, state);
+        index = 0;
+    }
+    while (index < target) {
+        applyFrame(*group, ++index, state);
+    }
+    while (index > target) {
+        applyFrame(*group, index--, state);
+    }
+
+    cursorFrame = frame;
+    cursorValid = true;
+    out = cursor;
+    return true;
+}
+
+/**
+ * @brief Reconstructs a held frame and discards every frame after it.
+ *
+ * The next push() continues from this frame, so resuming after a rewind
+ * overwrites the abandoned future.
+ *
+ * @param frame Frame number.
+ * @param out Receives the snapshot.
+ * @return bool False if the frame is not held.
+ */
+bool RewindBuffer::rewindTo(uint64_t frame, Chip8State& out) {
+    if (!seek(frame, out)) {
+        return false;
+    }
+    while (groups.back().firstFrame > frame) {
+        memoryUsed -= allocatedBytes(groups.back());
+        groups.pop_back();
+    }
+    Group& group = groups.back();
+    size_t keep = static_cast<size_t>(frame - group.firstFrame) + 1;
+    if (keep < group.offsets.size()) {
+        group.data.resize(group.offsets[keep]);
+        group.offsets.resize(keep);
+    }
+    nextFrame = frame + 1;
+    newest = out;
+    return true;
+}
+
+/**
+ * @brief Discards the newest frame and returns the one before it.
+ *
+ * @param out Receives the snapshot of the new newest frame.
+ * @return bool False if fewer than two frames are held.
+ */
+bool RewindBuffer::stepBack(Chip8State& out) {
+    if (groups.empty() || newestFrame() <= oldestFrame()) {
+        return false;
+    }
+    return rewindTo(newestFrame() - 1, out);
+}
+
+/**
+ * @brief Discards every frame. Frame numbering continues where it was.
+ */
+void RewindBuffer::clear() {
+    groups.clear();
+    memoryUsed = 0;
+    cursorValid = false;
+}
+
+/**
+ * @brief Reports how much history is held and how well it compresses.
+ *
+ * @return RewindStats Current counters.
+ */
+RewindStats RewindBuffer::getStats() const {
+    RewindStats stats;
+    size_t deltaBytes = 0;
+    for (const Group& group : groups) {
+        stats.frames += group.offsets.size();
+        stats.keyframes += 1;
+        stats.storedBytes += group.data.size();
+        size_t keyframeEnd = group.offsets.size() > 1 ? group.offsets[1] : group.data.size();
+        deltaBytes += group.data.size() - keyframeEnd;
+    }
+    stats.evictedFrames = evictedFrames;
+    stats.memoryUsed = memoryUsed;
+    stats.memoryBudget = memoryBudget;
+    if (stats.storedBytes > 0) {
+        stats.compressionRatio = static_cast<double>(stats.frames * sizeof(Chip8State)) / stats.storedBytes;
+    }
+    if (stats.frames > stats.keyframes) {
+        stats.avgDeltaBytes = static_cast<double>(deltaBytes) / (stats.frames - stats.keyframes);
+    }
+    return stats;
+}
@@ -0,0 +1,445 @@
+#include "rom_analysis.h"
+#include <algorithm>
+#include <cstdio>
+#include <iostream>
+#include <map>
+#include <utility>
+
+namespace {
+
+// entryI values besides a known 12-bit address
+const int32_t UNVISITED = -2;
+const int32_t UNKNOWN_I = -1;
+
+/**
+ * @brief Formats an address or byte as upper-case hex with a 0x prefix.
+ */
+std::string hex(unsigned value, int digits) {
+    char text[8];
+    std::snprintf(text, sizeof(text), "0x%0*X", digits, value);
+    return text;
+}
+
+// Like OpcodeHandler::decode(), 5XYN and 9XYN ignore their low nibble
+bool isSkip(uint16_t opcode) {
+    switch (opcode & 0xF000) {
+        case 0x3000:
+        case 0x4000:
+        case 0x5000:
+        case 0x9000: return true;
+        case 0xE000: return (opcode & 0x00FF) == 0x9E || (opcode & 0x00FF) == 0xA1;
+    }
+    return false;
+}
+
+bool isReturn(uint16_t opcode) {
+    return (opcode & 0xF0FF) == 0x00EE;
+}
+
+// Opcodes the core runs as op_unknown
+bool isUnknown(uint16_t opcode) {
+    return RomAnalysis::disassemble(opcode).compare(0, 3, "db ") == 0;
+}
+
+} // namespace
+
+/**
+ * @brief Analyzes a ROM image; replaces any previous result.
+ *
+ * @param rom Program bytes.
+ * @param size Number of bytes.
+ * @return true if the image fits in memory and was analyzed.
+ */
+bool RomAnalysis::analyze(const uint8_t* rom, size_t size) {
+    if (size > MEMORY_SIZE - LOAD_ADDRESS) {
+        std::cerr << "ROM too large to analyze (" << size << " bytes)" << std::endl;
+        return false;
+    }
+    image.assign(rom, rom + size);
+    byteFlags.fill(0);
+    entryI.fill(UNVISITED);
+    blocks.clear();
+    subroutines.clear();
+    indirectJumps.clear();
+    stores.clear();
+
+    traceCode();
+
+    // Data references, using the I values the trace settled on
+    std::map<uint16_t, std::vector<uint16_t>> callers;
+    for (uint16_t address = LOAD_ADDRESS; address < MEMORY_SIZE; ++address) {
+        if (!isCode(address)) {
+            continue;
+        }
+        uint16_t opcode = word(address);
+        uint8_t x = (opcode >> 8) & 0x0F;
+        int32_t i = entryI[address];
+        if ((opcode & 0xF000) == 0x2000) {
+            callers[opcode & 0x0FFF].push_back(address);
+        } else if ((opcode & 0xF000) == 0xB000) {
+            indirectJumps.push_back(address);
+        } else if ((opcode & 0xF000) == 0xD000 && i >= 0) {
+            markData(static_cast<uint16_t>(i), opcode & 0x000F, Sprite);
+        } else if ((opcode & 0xF0FF) == 0xF065 && i >= 0) {
+            markData(static_cast<uint16_t>(i), x + 1u, Data);
+        } else if ((opcode & 0xF0FF) == 0xF033 || (opcode & 0xF0FF) == 0xF055) {
+            StoreSite store;
+            store.address = address;
+            store.opcode = opcode;
+            store.targetKnown = i >= 0;
+            store.target = store.targetKnown ? static_cast<uint16_t>(i) : 0;
+            store.length = (opcode & 0x00FF) == 0x33 ? 3 : x + 1;
+            store.overlapsCode = false;
+            stores.push_back(store);
+        }
+    }
+    for (StoreSite& store : stores) {
+        if (!store.targetKnown) {
+            store.overlapsCode = true;
+            continue;
+        }
+        for (uint16_t k = 0; k < store.length; ++k) {
+            store.overlapsCode |= (flags(store.target + k) & (Code | Operand)) != 0;
+        }
+        markData(store.target, store.length, Data);
+    }
+    for (auto& entry : callers) {
+        subroutines.push_back({entry.first, std::move(entry.second)});
+    }
+
+    buildBlocks();
+    return true;
+}
+
+/**
+ * @brief Marks reachable instructions and settles the value of I on entry to each.
+ *
+ * A worklist of (address, I) pairs is followed instruction by instruction.
+ * Reaching an instruction again with a different I lowers its entry value
+ * to unknown and continues from there, so each address is revisited at
+ * most twice and the walk terminates.
+ */
+void RomAnalysis::traceCode() {
+    std::vector<std::pair<uint16_t, int32_t>> pending;
+    auto branch = [&](uint16_t target, int32_t i) {
+        target &= MEMORY_SIZE - 1;
+        byteFlags[target] |= Leader;
+        pending.emplace_back(target, i);
+    };
+    branch(LOAD_ADDRESS, UNKNOWN_I);
+
+    while (!pending.empty()) {
+        uint16_t address = pending.back().first;
+        int32_t i = pending.back().second;
+        pending.pop_back();
+
+        while (inImage(address)) {
+            int32_t previous = entryI[address];
+            int32_t merged = previous == UNVISITED || previous == i ? i : UNKNOWN_I;
+            if (previous != UNVISITED && merged == previous) {
+                break;
+            }
+            entryI[address] = merged;
+            i = merged;
+            byteFlags[address] |= Code;
+            byteFlags[address + 1] |= Operand;
+
+            uint16_t opcode = word(address);
+            uint16_t nnn = opcode & 0x0FFF;
+            switch (opcode & 0xF000) {
+                case 0xA000: i = nnn; break;
+                case 0xF000:
+                    if ((opcode & 0x00FF) == 0x1E || (opcode & 0x00FF) == 0x29) {
+                        i = UNKNOWN_I;
+                    }
+                    break;
+            }
+
+            if ((opcode & 0xF000) == 0x1000) {
+                branch(nnn, i);
+                break;
+            }
+            if ((opcode & 0xF000) == 0x2000) {
+                branch(nnn, i);
+                // The subroutine may change I before it returns
+                branch(address + 2, UNKNOWN_I);
+                break;
+            }
+            if (isSkip(opcode)) {
+                branch(address + 2, i);
+                branch(address + 4, i);
+                break;
+            }
+            if (isReturn(opcode) || (opcode & 0xF000) == 0xB000 || isUnknown(opcode)) {
+                break;
+            }
+            address += 2;
+        }
+    }
+}
+
+/**
+ * @brief Splits the reachable code into basic blocks at every leader and
+ *        after every control-flow instruction.
+ */
+void RomAnalysis::buildBlocks() {
+    for (uint16_t start = LOAD_ADDRESS; start < MEMORY_SIZE; ++start) {
+        if ((flags(start) & (Leader | Code)) != (Leader | Code)) {
+            continue;
+        }
+        BasicBlock block;
+        block.start = start;
+        uint16_t address = start;
+        while (true) {
+            uint16_t opcode = word(address);
+            uint16_t next = address + 2;
+            block.end = next;
+            if ((opcode & 0xF000) == 0x1000) {
+                block.exit = Exit::Jump;
+                block.successors = {static_cast<uint16_t>(opcode & 0x0FFF)};
+            } else if ((opcode & 0xF000) == 0x2000) {
+                block.exit = Exit::Call;
+                block.successors = {static_cast<uint16_t>(opcode & 0x0FFF), next};
+            } else if (isReturn(opcode)) {
+                block.exit = Exit::Return;
+            } else if (isSkip(opcode)) {
+                block.exit = Exit::Skip;
+                block.successors = {next, static_cast<uint16_t>(next + 2)};
+            } else if ((opcode & 0xF000) == 0xB000) {
+                block.exit = Exit::Indirect;
+            } else if (isUnknown(opcode) || !inImage(next)) {
+                block.exit = Exit::Invalid;
+            } else if (flags(next) & Leader) {
+                block.exit = Exit::FallThrough;
+                block.successors = {next};
+            } else {
+                address = next;
+                continue;
+            }
+            break;
+        }
+        blocks.push_back(std::move(block));
+    }
+}
+
+/**
+ * @brief Flags a byte range as data, wrapping at 4 KiB.
+ */
+void RomAnalysis::markData(uint16_t address, size_t length, ByteFlag flag) {
+    for (size_t k = 0; k < length; ++k) {
+        byteFlags[(address + k) & (MEMORY_SIZE - 1)] |= flag;
+    }
+}
+
+size_t RomAnalysis::countBytes(ByteFlag flag) const {
+    size_t count = 0;
+    for (size_t k = 0; k < image.size(); ++k) {
+        count += (byteFlags[LOAD_ADDRESS + k] & flag) != 0;
+    }
+    return count;
+}
+
+bool RomAnalysis::selfModifying() const {
+    return std::any_of(stores.begin(), stores.end(), [](const StoreSite& store) { return store.overlapsCode; });
+}
+
+/**
+ * @brief Returns the mnemonic of an opcode, following the handler comments
+ *        in OpcodeHandler.cpp; opcodes the core does not know become "db".
+ *
+ * @param opcode The instruction.
+ * @return std::string The mnemonic and operands.
+ */
+std::string RomAnalysis::disassemble(uint16_t opcode) {
+    std::string x = "V" + std::string(1, "0123456789ABCDEF"[(opcode >> 8) & 0x0F]);
+    std::string y = "V" + std::string(1, "0123456789ABCDEF"[(opcode >> 4) & 0x0F]);
+    std::string nn = hex(opcode & 0x00FF, 2);
+    std::string nnn = hex(opcode & 0x0FFF, 3);
+    switch (opcode & 0xF000) {
+        case 0x0000:
+            if ((opcode & 0x00FF) == 0xE0) return "CLS";
+            if ((opcode & 0x00FF) == 0xEE) return "RET";
+            break;
+        case 0x1000: return "JP " + nnn;
+        case 0x2000: return "CALL " + nnn;
+        case 0x3000: return "SE " + x + ", " + nn;
+        case 0x4000: return "SNE " + x + ", " + nn;
+        case 0x5000: return "SE " + x + ", " + y;
+        case 0x6000: return "LD " + x + ", " + nn;
+        case 0x7000: return "ADD " + x + ", " + nn;
+        case 0x8000:
+            switch (opcode & 0x000F) {
+                case 0x0: return "LD " + x + ", " + y;
+                case 0x1: return "OR " + x + ", " + y;
+                case 0x2: return "AND " + x + ", " + y;
+                case 0x3: return "XOR " + x + ", " + y;
+                case 0x4: return "ADD " + x + ", " + y;
+                case 0x5: return "SUB " + x + ", " + y;
+                case 0x6: return "SHR " + x;
+                case 0x7: return "SUBN " + x + ", " + y;
+                case 0xE: return "SHL " + x;
+            }
+            break;
+        case 0x9000: return "SNE " + x + ", " + y;
+        case 0xA000: return "LD I, " + nnn;
+        case 0xB000: return "JP V0, " + nnn;
+        case 0xC000: return "RND " + x + ", " + nn;
+        case 0xD000: return "DRW " + x + ", " + y + ", " + std::to_string(opcode & 0x000F);
+        case 0xE000:
+            if ((opcode & 0x00FF) == 0x9E) return "SKP " + x;
+            if ((opcode & 0x00FF) == 0xA1) return "SKNP " + x;
+            break;
+        case 0xF000:
+            switch (opcode & 0x00FF) {
+                case 0x07: return "LD " + x + ", DT";
+                case 0x0A: return "LD " + x + ", K";
+                case 0x15: return "LD DT, " + x;
+                case 0x18: return "LD ST, " + x;
+                case 0x1E: return "ADD I, " + x;
+                case 0x29: return "LD F, " + x;
+                case 0x33: return "LD B, " + x;
+                case 0x55: return "LD [I], " + x;
+                case 0x65: return "LD " + x + ", [I]";
+            }
+            break;
+    }
+    return "db " + hex(opcode, 4);
+}
+
+/**
+ * @brief Writes the image as an annotated listing.
+ *
+ * Block leaders get a label ("sub_0xNNN" for subroutines, "L_0xNNN"
+ * otherwise). Sprite bytes are drawn as eight pixels; other bytes outside
+ * code are db lines, marked "; data" when the program reads or writes them.
+ *
+ * @param out Stream to write to.
+ */
+void RomAnalysis::writeListing(std::ostream& out) const {
+    out << "; " << image.size() << " bytes at 0x200: " << countBytes(Code) + countBytes(Operand) << " code, "
+        << countBytes(Sprite) << " sprite, " << countBytes(Data) << " data\n"
+        << "; " << blocks.size() << " blocks, " << subroutines.size() << " subroutines, "
+        << indirectJumps.size() << " indirect jumps, " << stores.size() << " store sites"
+        << (selfModifying() ? " (self-modifying)" : "") << '\n';
+
+    std::vector<bool> entries(MEMORY_SIZE);
+    for (const Subroutine& sub : subroutines) {
+        entries[sub.entry] = true;
+    }
+    std::map<uint16_t, const StoreSite*> storeAt;
+    for (const StoreSite& store : stores) {
+        storeAt[store.address] = &store;
+    }
+
+    uint16_t end = static_cast<uint16_t>(LOAD_ADDRESS + image.size());
+    for (uint16_t address = LOAD_ADDRESS; address < end; ) {
+        uint8_t byte = image[address - LOAD_ADDRESS];
+        if (isCode(address)) {
+            if (entries[address]) {
+                out << "\nsub_" << hex(address, 3) << ":\n";
+            } else if (flags(address) & Leader) {
+                out << (address == LOAD_ADDRESS ? "\nstart:\n" : "\nL_" + hex(address, 3) + ":\n");
+            }
+            uint16_t opcode = word(address);
+            char text[16];
+            std::snprintf(text, sizeof(text), "  0x%03X  %04X  ", address, opcode);
+            out << text << disassemble(opcode);
+            auto store = storeAt.find(address);
+            if (store != storeAt.end() && store->second->overlapsCode) {
+                out << (store->second->targetKnown ? "    ; writes code" : "    ; may write code");
+            } else if ((opcode & 0xF000) == 0xB000) {
+                out << "    ; indirect";
+            }
+            out << '\n';
+            address += 2;
+            continue;
+        }
+        char text[16];
+        std::snprintf(text, sizeof(text), "  0x%03X  %02X    ", address, byte);
+        out << text;
+        if (flags(address) & Sprite) {
+            for (int bit = 7; bit >= 0; --bit) {
+                out << ((byte >> bit) & 1 ? '#' : '.');
+            }
+        } else {
+            out << "db " << hex(byte, 2) << ((flags(address) & Data) ? "    ; data" : "");
+        }
+        out << '\n';
+        ++address;
+    }
+}
+
+/**
+ * @brief Writes the CFG as a Graphviz digraph.
+ *
+ * Nodes list their instructions; call edges are dashed and lead to the
+ * subroutine, with a dotted edge to the return site.
+ *
+ * @param out Stream to write to.
+ */
+void RomAnalysis::writeDot(std::ostream& out) const {
+    out << "digraph rom {\n  node [shape=box, fontname=\"monospace\"];\n";
+    for (const BasicBlock& block : blocks) {
+        out << "  \"" << hex(block.start, 3) << "\" [label=\"";
+        for (uint16_t address = block.start; address < block.end; address += 2) {
+            out << hex(address, 3) << "  " << disassemble(word(address)) << "\\l";
+        }
+        out << "\"];\n";
+        for (size_t s = 0; s < block.successors.size(); ++s) {
+            out << "  \"" << hex(block.start, 3) << "\" -> \"" << hex(block.successors[s], 3) << '"';
+            if (block.exit == Exit::Call) {
+                out << (s == 0 ? " [style=dashed]" : " [style=dotted]");
+            }
+            out << ";\n";
+        }
+    }
+    out << "}\n";
+}
+
+/**
+ * @brief Writes the analysis as one JSON object. Addresses are hex strings.
+ *
+ * @param out Stream to write to.
+ */
+void RomAnalysis::writeJson(std::ostream& out) const {
+    static const char* const EXIT_NAMES[] = {"fallthrough", "jump", "call", "return", "skip", "indirect", "invalid"};
+    auto list = [&](const std::vector<uint16_t>& addresses) {
+        out << '[';
+        for (size_t k = 0; k < addresses.size(); ++k) {
+            out << (k ? "," : "") << '"' << hex(addresses[k], 3) << '"';
+        }
+        out << ']';
+    };
+
+    out << "{\"rom_size\":" << image.size() << ",\"code_bytes\":" << countBytes(Code) + countBytes(Operand)
+        << ",\"sprite_bytes\":" << countBytes(Sprite) << ",\"data_bytes\":" << countBytes(Data)
+        << ",\"self_modifying\":" << (selfModifying() ? "true" : "false") << ",\n\"blocks\":[";
+    for (size_t b = 0; b < blocks.size(); ++b) {
+        const BasicBlock& block = blocks[b];
+        out << (b ? ",\n" : "\n") << "{\"start\":\"" << hex(block.start, 3) << "\",\"end\":\"" << hex(block.end, 3)
+            << "\",\"exit\":\"" << EXIT_NAMES[static_cast<int>(block.exit)] << "\",\"successors\":";
+        list(block.successors);
+        out << '}';
+    }
+    out << "],\n\"subroutines\":[";
+    for (size_t s = 0; s < subroutines.size(); ++s) {
+        out << (s ? "," : "") << "{\"entry\":\"" << hex(subroutines[s].entry, 3) << "\",\"callers\":";
+        list(subroutines[s].callers);
+        out << '}';
+    }
+    out << "],\n\"indirect_jumps\":";
+    list(indirectJumps);
+    out << ",\n\"stores\":[";
+    for (size_t s = 0; s < stores.size(); ++s) {
+        const StoreSite& store = stores[s];
+        out << (s ? "," : "") << "{\"address\":\"" << hex(store.address, 3) << "\",\"opcode\":\"" << hex(store.opcode, 4)
+            << "\",\"target\":";
+        if (store.targetKnown) {
+            out << '"' << hex(store.target, 3) << '"';
+        } else {
+            out << "null";
+        }
+        out << ",\"length\":" << store.length << ",\"overlaps_code\":" << (store.overlapsCode ? "true" : "false") << '}';
+    }
+    out << "]}\n";
+}
@@ -0,0 +1,350 @@
+#include "rom_library.h"
+#include "hash.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// Stands in for the mapping of an empty file, which mmap cannot create
+const uint8_t EMPTY_IMAGE[1] = {0};
+
+void putLe(std::vector<uint8_t>& out, uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+}
+
+uint64_t getLe(const uint8_t* in, int bytes) {
+    uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    return value;
+}
+
+} // namespace
+
+/**
+ * @brief Returns the analysis of the image, running it once on first use.
+ *
+ * @return const RomAnalysis& The shared, read-only analysis.
+ */
+const RomAnalysis& RomLibrary::Rom::analysis() const {
+    std::call_once(analyzed_, [this] { analysis_.analyze(data_, size_); });
+    return analysis_;
+}
+
+/**
+ * @brief Constructs an empty library.
+ */
+RomLibrary::RomLibrary() = default;
+
+/**
+ * @brief Unmaps every file; no Rom of the library may be used afterwards.
+ */
+RomLibrary::~RomLibrary() {
+    for (const Mapping& mapping : mappings_) {
+        munmap(mapping.address, mapping.length);
+    }
+}
+
+/**
+ * @brief Turns a path into the form names are indexed under, so "roms/./PONG"
+ *        and "roms/PONG" find the same image.
+ */
+std::string RomLibrary::normalize(const std::string& name) {
+    return std::filesystem::path(name).lexically_normal().generic_string();
+}
+
+/**
+ * @brief Maps a whole file read-only.
+ *
+ * @param path The file.
+ * @param size Receives its size.
+ * @return const uint8_t* The mapping, or nullptr if the file cannot be mapped.
+ */
+const uint8_t* RomLibrary::map(const std::string& path, size_t& size) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        close(fd);
+        return nullptr;
+    }
+    size = static_cast<size_t>(info.st_size);
+    if (size == 0) {
+        close(fd);
+        return EMPTY_IMAGE;
+    }
+    void* address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+        return nullptr;
+    }
+    mappings_.push_back({address, size});
+    return static_cast<const uint8_t*>(address);
+}
+
+/**
+ * @brief Indexes an image under a name, sharing an existing Rom with the same contents.
+ *
+ * @param name Normalized name, or empty to index the image by hash only.
+ * @return const Rom* The Rom now holding the image.
+ */
+const RomLibrary::Rom* RomLibrary::insert(const std::string& name, const uint8_t* data, size_t size, uint64_t hash) {
+    auto existing = byHash_.find(hash);
+    if (existing != byHash_.end() && existing->second->size_ == size &&
+        std::memcmp(existing->second->data_, data, size) == 0) {
+        if (!name.empty()) {
+            names_[name] = existing->second;
+        }
+        return existing->second;
+    }
+    auto rom = std::make_unique<Rom>();
+    rom->data_ = data;
+    rom->size_ = size;
+    rom->hash_ = hash;
+    const Rom* added = rom.get();
+    roms_.push_back(std::move(rom));
+    byHash_.emplace(hash, added);   // Keeps the first of two colliding images; names still find both
+    if (!name.empty()) {
+        names_[name] = added;
+    }
+    return added;
+}
+
+/**
+ * @brief Maps one ROM file, validates its size and indexes it.
+ *
+ * A file already added under the same name is not mapped again.
+ *
+ * @param path Path to the ROM.
+ * @return const Rom* The image, or nullptr if it cannot be used.
+ */
+const RomLibrary::Rom* RomLibrary::addFile(const std::string& path) {
+    std::string name = normalize(path);
+    if (const Rom* known = find(name)) {
+        return known;
+    }
+    size_t size = 0;
+    size_t mapped = mappings_.size();
+    const uint8_t* data = map(path, size);
+    if (!data) {
+        std::cerr << "Failed to open ROM: " << path << std::endl;
+        return nullptr;
+    }
+    if (size > MAX_ROM_SIZE) {
+        std::cerr << "ROM too large: " << path << " (" << size << " bytes)" << std::endl;
+        if (mappings_.size() > mapped) {
+            munmap(mappings_.back().address, mappings_.back().length);
+            mappings_.pop_back();
+        }
+        return nullptr;
+    }
+    const Rom* rom = insert(name, data, size, fnv1a64(data, size));
+    if (rom->data_ != data && mappings_.size() > mapped) {
+        // A copy of an image already mapped: keep only the first mapping
+        munmap(mappings_.back().address, mappings_.back().length);
+        mappings_.pop_back();
+    }
+    return rom;
+}
+
+/**
+ * @brief Adds every regular file below a directory.
+ *
+ * @param path The directory.
+ * @return size_t Files added.
+ */
+size_t RomLibrary::addDirectory(const std::string& path) {
+    std::vector<std::string> files;
+    std::error_code error;
+    for (std::filesystem::recursive_directory_iterator it(path, error), end; !error && it != end; it.increment(error)) {
+        if (it->is_regular_file(error)) {
+            files.push_back(it->path().string());
+        }
+    }
+    if (error) {
+        std::cerr << "Failed to read ROM directory: " << path << " (" << error.message() << ")" << std::endl;
+    }
+    // Directory order is unspecified; sorting keeps the first of duplicate images stable
+    std::sort(files.begin(), files.end());
+    size_t added = 0;
+    for (const std::string& file : files) {
+        added += addFile(file) != nullptr;
+    }
+    return added;
+}
+
+/**
+ * @brief Maps a pack file, validates every table entry and image, and indexes the names.
+ *
+ * Nothing is added unless the whole pack is valid.
+ *
+ * @param path The pack file.
+ * @return true if the pack was added.
+ */
+bool RomLibrary::addPack(const std::string& path) {
+    size_t size = 0;
+    size_t mapped = mappings_.size();
+    const uint8_t* data = map(path, size);
+    if (!data) {
+        std::cerr << "Failed to open ROM pack: " << path << std::endl;
+        return false;
+    }
+    auto invalid = [&](const char* reason) {
+        std::cerr << "Invalid ROM pack " << path << ": " << reason << std::endl;
+        if (mappings_.size() > mapped) {
+            munmap(mappings_.back().address, mappings_.back().length);
+            mappings_.pop_back();
+        }
+        return false;
+    };
+    if (size < pack::HEADER_SIZE || std::memcmp(data, pack::MAGIC, sizeof(pack::MAGIC)) != 0) {
+        return invalid("bad magic");
+    }
+    if (getLe(data + 4, 2) != pack::VERSION) {
+        return invalid("unsupported version");
+    }
+    size_t headerSize = getLe(data + 6, 2);
+    uint64_t romCount = getLe(data + 8, 4);
+    uint64_t nameCount = getLe(data + 12, 4);
+    if (headerSize < pack::HEADER_SIZE || headerSize + romCount * pack::ROM_ENTRY_SIZE > size) {
+        return invalid("truncated ROM table");
+    }
+
+    const uint8_t* table = data + headerSize;
+    for (uint64_t r = 0; r < romCount; ++r) {
+        const uint8_t* entry = table + r * pack::ROM_ENTRY_SIZE;
+        uint64_t offset = getLe(entry + 8, 4);
+        uint64_t length = getLe(entry + 12, 4);
+        if (length > MAX_ROM_SIZE || offset + length > size) {
+            return invalid("image out of bounds or too large");
+        }
+        if (fnv1a64(data + offset, length) != getLe(entry, 8)) {
+            return invalid("image does not match its hash");
+        }
+    }
+    std::vector<std::pair<std::string, uint64_t>> names;
+    const uint8_t* entry = table + romCount * pack::ROM_ENTRY_SIZE;
+    const uint8_t* end = data + size;
+    for (uint64_t n = 0; n < nameCount; ++n) {
+        if (end - entry < 6) {
+            return invalid("truncated name table");
+        }
+        uint64_t rom = getLe(entry, 4);
+        size_t length = getLe(entry + 4, 2);
+        entry += 6;
+        if (rom >= romCount || static_cast<size_t>(end - entry) < length) {
+            return invalid("bad name entry");
+        }
+        names.emplace_back(normalize(std::string(reinterpret_cast<const char*>(entry), length)), rom);
+        entry += length;
+    }
+
+    std::vector<const Rom*> roms;
+    for (uint64_t r = 0; r < romCount; ++r) {
+        const uint8_t* rom = table + r * pack::ROM_ENTRY_SIZE;
+        roms.push_back(insert("", data + getLe(rom + 8, 4), getLe(rom + 12, 4), getLe(rom, 8)));
+    }
+    for (const auto& name : names) {
+        names_[name.first] = roms[name.second];
+    }
+    return true;
+}
+
+/**
+ * @brief Adds a directory or a pack file, whichever path is.
+ *
+ * @param path The directory or pack.
+ * @return true if it was added.
+ */
+bool RomLibrary::add(const std::string& path) {
+    std::error_code error;
+    if (std::filesystem::is_directory(path, error)) {
+        addDirectory(path);
+        return true;
+    }
+    return addPack(path);
+}
+
+/**
+ * @brief Writes the library as a pack file, names sorted, each image once.
+ *
+ * @param path Output file.
+ * @return true if the file was written.
+ */
+bool RomLibrary::writePack(const std::string& path) const {
+    std::vector<std::pair<std::string, const Rom*>> names(names_.begin(), names_.end());
+    std::sort(names.begin(), names.end());
+    std::unordered_map<const Rom*, uint32_t> index;
+    for (size_t r = 0; r < roms_.size(); ++r) {
+        index[roms_[r].get()] = static_cast<uint32_t>(r);
+    }
+
+    std::vector<uint8_t> tables;
+    uint64_t offset = pack::HEADER_SIZE + roms_.size() * pack::ROM_ENTRY_SIZE;
+    for (const auto& name : names) {
+        offset += 6 + name.first.size();
+    }
+    for (const auto& rom : roms_) {
+        putLe(tables, rom->hash_, 8);
+        putLe(tables, offset, 4);
+        putLe(tables, rom->size_, 4);
+        offset += rom->size_;
+    }
+    for (const auto& name : names) {
+        putLe(tables, index[name.second], 4);
+        putLe(tables, name.first.size(), 2);
+        tables.insert(tables.end(), name.first.begin(), name.first.end());
+    }
+
+    std::vector<uint8_t> header(pack::MAGIC, pack::MAGIC + sizeof(pack::MAGIC));
+    putLe(header, pack::VERSION, 2);
+    putLe(header, pack::HEADER_SIZE, 2);
+    putLe(header, roms_.size(), 4);
+    putLe(header, names.size(), 4);
+
+    std::ofstream file(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open ROM pack for writing: " << path << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(header.data()), header.size());
+    file.write(reinterpret_cast<const char*>(tables.data()), tables.size());
+    for (const auto& rom : roms_) {
+        file.write(reinterpret_cast<const char*>(rom->data_), rom->size_);
+    }
+    return file.good();
+}
+
+/**
+ * @brief Finds an image by name.
+ *
+ * @param name The name, normalized like the names it was added under.
+ * @return const Rom* The image, or nullptr if there is none.
+ */
+const RomLibrary::Rom* RomLibrary::find(const std::string& name) const {
+    auto it = names_.find(normalize(name));
+    return it != names_.end() ? it->second : nullptr;
+}
+
+/**
+ * @brief Finds an image by content hash.
+ *
+ * @param hash FNV-1a hash of the image.
+ * @return const Rom* The image, or nullptr if there is none.
+ */
+const RomLibrary::Rom* RomLibrary::findHash(uint64_t hash) const {
+    auto it = byHash_.find(hash);
+    return it != byHash_.end() ? it->second : nullptr;
+}
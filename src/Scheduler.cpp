@@ -0,0 +1,137 @@
+#include "scheduler.h"
+#include <thread>
+
+// Number of instructions executed between clock checks in UNLIMITED mode.
+const int UNLIMITED_BATCH = 1024;
+
+// How far behind (in frames) we may fall before the frame clock is resynchronised.
+const int MAX_FRAME_LAG = 5;
+
+/**
+ * @brief Constructs a Scheduler running at the given instruction rate.
+ *
+ * @param cyclesPerSecond Instructions per second, or UNLIMITED.
+ */
+Scheduler::Scheduler(int cyclesPerSecond)
+    : cyclesPerSecond(cyclesPerSecond), cycleRemainder(0), frameCount(0), missedDeadlines(0),
+      epoch(Clock::now()) {}
+
+/**
+ * @brief Sets the instruction rate. Negative values are treated as UNLIMITED.
+ *
+ * @param cyclesPerSecond Instructions per second, or UNLIMITED.
+ */
+void Scheduler::setCyclesPerSecond(int cyclesPerSecond) {
+    this->cyclesPerSecond = cyclesPerSecond > 0 ? cyclesPerSecond : UNLIMITED;
+    cycleRemainder = 0;
+}
+
+/**
+ * @brief Resets the frame clock so that frame 0 starts now.
+ */
+void Scheduler::start() {
+    frameCount = 0;
+    missedDeadlines = 0;
+    cycleRemainder = 0;
+    epoch = Clock::now();
+}
+
+/**
+ * @brief Restarts the frame clock from now without resetting the counters.
+ *
+ * Used after the caller has blocked (e.g. waiting for input) so the time
+ * spent blocked is neither counted as missed deadlines nor caught up.
+ */
+void Scheduler::resync() {
+    epoch = Clock::now() - std::chrono::nanoseconds(frameCount * 1000000000ULL / TIMER_HZ);
+}
+
+/**
+ * @brief Aligns the fractional cycle carry with a frame index.
+ *
+ * With a fixed rate, the carry after n frames is (n * cyclesPerSecond) mod
+ * TIMER_HZ regardless of where the frames ended early, so restoring it makes
+ * frame budgets a function of the frame index alone.
+ *
+ * @param frame Index of the next frame to run.
+ */
+void Scheduler::setCyclePhase(uint64_t frame) {
+    if (cyclesPerSecond != UNLIMITED) {
+        cycleRemainder = static_cast<int>(frame * cyclesPerSecond % TIMER_HZ);
+    }
+}
+
+/**
+ * @brief Computes the absolute deadline of the given frame.
+ *
+ * Deadlines are derived from the epoch rather than accumulated, so the
+ * non-integral 1/60s frame period never drifts.
+ *
+ * @param frame Frame index.
+ * @return Clock::time_point Time at which the frame should end.
+ */
+Scheduler::Clock::time_point Scheduler::frameDeadline(uint64_t frame) const {
+    return epoch + std::chrono::nanoseconds(frame * 1000000000ULL / TIMER_HZ);
+}
+
+/**
+ * @brief Executes one frame worth of instructions and ticks the timers.
+ *
+ * With a fixed rate, the frame budget is cyclesPerSecond / 60 with the
+ * remainder carried over, so e.g. 500Hz alternates 8 and 9 instructions.
+ * In UNLIMITED mode, instructions run in batches until the frame deadline.
+ * Either way the frame ends early once the core reports it is idle: the
+ * skipped cycles would only spin in a wait loop until the next timer tick
+ * or key press.
+ *
+ * @param chip8 The CHIP-8 instance to drive.
+ * @return uint64_t Number of instructions executed.
+ */
+uint64_t Scheduler::runFrame(Chip8& chip8) {
+    uint64_t executed = 0;
+
+    if (cyclesPerSecond == UNLIMITED) {
+        Clock::time_point deadline = frameDeadline(frameCount + 1);
+        do {
+            executed += chip8.execute(UNLIMITED_BATCH);
+        } while (chip8.getIdleState() == IdleState::Running && Clock::now() < deadline);
+    } else {
+        int budget = cyclesPerSecond + cycleRemainder;
+        cycleRemainder = budget % TIMER_HZ;
+        while (executed < static_cast<uint64_t>(budget / TIMER_HZ)) {
+            executed += chip8.execute(budget / TIMER_HZ - executed);
+            if (chip8.getIdleState() != IdleState::Running) {
+                break;
+            }
+        }
+    }
+
+    chip8.tickTimers();
+    ++frameCount;
+    return executed;
+}
+
+/**
+ * @brief Sleeps until the deadline of the next frame.
+ *
+ * Late frames are counted as missed deadlines. When the lag exceeds
+ * MAX_FRAME_LAG frames, the epoch is moved forward so the emulator resumes
+ * at normal speed instead of fast-forwarding to catch up.
+ */
+void Scheduler::waitForNextFrame() {
+    Clock::time_point deadline = frameDeadline(frameCount);
+    Clock::time_point now = Clock::now();
+
+    if (now < deadline) {
+        std::this_thread::sleep_until(deadline);
+        return;
+    }
+
+    // UNLIMITED frames always end at (or just past) their deadline by design.
+    if (cyclesPerSecond != UNLIMITED) {
+        ++missedDeadlines;
+    }
+    if (now - deadline > std::chrono::nanoseconds(MAX_FRAME_LAG * 1000000000ULL / TIMER_HZ)) {
+        epoch += now - deadline;
+    }
+}
@@ -0,0 +1,129 @@
+#include "thread_pool.h"
+#include <algorithm>
+
+/**
+ * @brief Constructs the pool and starts its worker threads.
+ *
+ * @param threadCount Number of workers; 0 uses the hardware concurrency.
+ */
+ThreadPool::ThreadPool(size_t threadCount)
+    : queued_(0), pending_(0), nextWorker_(0), stopping_(false)
+{
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < threadCount; ++i) {
+        threads_.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+/**
+ * @brief Finishes all queued tasks and joins the worker threads.
+ */
+ThreadPool::~ThreadPool() {
+    wait();
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        stopping_ = true;
+    }
+    workAvailable_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+/**
+ * @brief Queues a task on the next worker deque in round-robin order.
+ *
+ * @param task The task to run.
+ */
+void ThreadPool::submit(Task task) {
+    size_t index;
+    {
+        // Count the task before it becomes visible so queued_ never underflows;
+        // a worker woken early simply retries until the push below lands.
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        index = nextWorker_++ % workers_.size();
+        ++pending_;
+        queued_.fetch_add(1);
+    }
+    {
+        std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+        workers_[index]->tasks.push_back(std::move(task));
+    }
+    workAvailable_.notify_one();
+}
+
+/**
+ * @brief Blocks until every submitted task has finished.
+ */
+void ThreadPool::wait() {
+    std::unique_lock<std::mutex> lock(stateMutex_);
+    allDone_.wait(lock, [this]{ return pending_ == 0; });
+}
+
+/**
+ * @brief Pops the most recently queued task from a worker's own deque.
+ *
+ * @param index Worker index.
+ * @param task Receives the task on success.
+ * @return true if a task was taken.
+ */
+bool ThreadPool::popLocal(size_t index, Task& task) {
+    Worker& worker = *workers_[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (worker.tasks.empty()) return false;
+    task = std::move(worker.tasks.back());
+    worker.tasks.pop_back();
+    return true;
+}
+
+/**
+ * @brief Steals the oldest task from another worker's deque.
+ *
+ * @param thief Index of the stealing worker; its own deque is skipped.
+ * @param task Receives the task on success.
+ * @return true if a task was taken.
+ */
+bool ThreadPool::steal(size_t thief, Task& task) {
+    for (size_t offset = 1; offset < workers_.size(); ++offset) {
+        Worker& victim = *workers_[(thief + offset) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Worker main loop: run local tasks, steal when idle, sleep when
+ * there is nothing left anywhere.
+ *
+ * @param index Worker index.
+ */
+void ThreadPool::workerLoop(size_t index) {
+    while (true) {
+        Task task;
+        if (popLocal(index, task) || steal(index, task)) {
+            queued_.fetch_sub(1);
+            task();
+            std::lock_guard<std::mutex> lock(stateMutex_);
+            if (--pending_ == 0) {
+                allDone_.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(stateMutex_);
+        workAvailable_.wait(lock, [this]{ return stopping_ || queued_.load() > 0; });
+        if (stopping_ && queued_.load() == 0) {
+            return;
+        }
+    }
+}
@@ -0,0 +1,207 @@
+#include "trace_reader.h"
+#include "lz_codec.h"
+#include "trace_format.h"
+#include <algorithm>
+#include <iostream>
+
+/**
+ * @brief Opens a trace and validates its header.
+ *
+ * @param path Trace file.
+ * @return bool False if the file is missing or not a supported trace.
+ */
+bool TraceReader::open(const std::string& path) {
+    file_.open(path, std::ios::binary);
+    if (!file_) {
+        std::cerr << "Failed to open trace: " << path << std::endl;
+        return false;
+    }
+
+    uint8_t header[trace::FILE_HEADER_SIZE];
+    if (!file_.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+        !std::equal(std::begin(trace::MAGIC), std::end(trace::MAGIC), header)) {
+        std::cerr << "Not a CHIP-8 trace: " << path << std::endl;
+        return false;
+    }
+    uint16_t version = trace::getLe16(header + 4);
+    uint16_t headerSize = trace::getLe16(header + 6);
+    if (version != trace::VERSION || headerSize < trace::FILE_HEADER_SIZE) {
+        std::cerr << "Unsupported trace version " << version << ": " << path << std::endl;
+        return false;
+    }
+    file_.seekg(headerSize, std::ios::beg);
+    return true;
+}
+
+/**
+ * @brief Records a decoding error and ends the trace.
+ *
+ * @param reason Description printed to stderr.
+ * @return std::optional<EventVariant> Always empty.
+ */
+std::optional<EventVariant> TraceReader::fail(const char* reason) {
+    std::cerr << "Corrupt trace: " << reason << " (block " << blocksRead_ << ")" << std::endl;
+    failed_ = true;
+    eventsLeft_ = 0;
+    return std::nullopt;
+}
+
+/**
+ * @brief Reads and decompresses the next block.
+ *
+ * @return bool False at the end of the file or on error.
+ */
+bool TraceReader::loadBlock() {
+    uint8_t header[trace::BLOCK_HEADER_SIZE];
+    if (!file_.read(reinterpret_cast<char*>(header), sizeof(header))) {
+        if (file_.gcount() != 0) {
+            fail("truncated block header");
+        }
+        return false;
+    }
+    uint32_t rawSize = trace::getLe32(header);
+    uint32_t storedSize = trace::getLe32(header + 4);
+    uint32_t events = trace::getLe32(header + 8);
+    uint8_t codec = header[12];
+    if (rawSize > trace::MAX_BLOCK_SIZE || storedSize > trace::MAX_BLOCK_SIZE) {
+        fail("oversized block");
+        return false;
+    }
+
+    stored_.resize(storedSize);
+    if (!file_.read(reinterpret_cast<char*>(stored_.data()), storedSize)) {
+        fail("truncated block");
+        return false;
+    }
+
+    if (codec == trace::CODEC_RAW && storedSize == rawSize) {
+        block_.swap(stored_);
+    } else if (codec == trace::CODEC_LZ) {
+        block_.resize(rawSize);
+        if (!lzDecompress(stored_.data(), storedSize, block_.data(), rawSize)) {
+            fail("bad compressed data");
+            return false;
+        }
+    } else {
+        fail("unknown codec");
+        return false;
+    }
+
+    cursor_ = block_.data();
+    end_ = block_.data() + block_.size();
+    eventsLeft_ = events;
+    lastCycle_ = 0;
+    lastPc_ = 0;
+    ++blocksRead_;
+    rawBytes_ += rawSize;
+    storedBytes_ += storedSize + sizeof(header);
+    return true;
+}
+
+/**
+ * @brief Returns the next event, or nothing at the end of the trace.
+ *
+ * @return std::optional<EventVariant> The decoded event.
+ */
+std::optional<EventVariant> TraceReader::next() {
+    while (eventsLeft_ == 0) {
+        if (failed_ || !loadBlock()) {
+            return std::nullopt;
+        }
+    }
+    --eventsLeft_;
+
+    const uint8_t*& in = cursor_;
+    auto byte = [&](uint8_t& value) {
+        if (in == end_) return false;
+        value = *in++;
+        return true;
+    };
+    auto varint = [&](uint64_t& value) { return trace::getVarint(in, end_, value); };
+    auto pc = [&](uint16_t& value) {
+        uint64_t delta;
+        if (!varint(delta)) return false;
+        lastPc_ = static_cast<uint16_t>(lastPc_ + trace::unzigzag(delta));
+        value = lastPc_;
+        return true;
+    };
+
+    uint8_t type;
+    uint64_t cycleDelta;
+    if (!byte(type) || !varint(cycleDelta)) {
+        return fail("truncated event");
+    }
+    uint64_t cycle = lastCycle_ + trace::unzigzag(cycleDelta);
+    lastCycle_ = cycle;
+
+    switch (static_cast<EventType>(type)) {
+        case EventType::Opcode: {
+            uint16_t address;
+            uint8_t hi, lo;
+            if (!pc(address) || !byte(hi) || !byte(lo)) break;
+            return OpcodeEvent(cycle, address, static_cast<uint16_t>(hi << 8 | lo));
+        }
+        case EventType::Stack: {
+            uint16_t address;
+            uint64_t target;
+            uint8_t depth;
+            std::array<uint16_t, 16> stack{};
+            if (!pc(address) || !varint(target) || !byte(depth)) break;
+            bool ok = true;
+            for (auto& entry : stack) {
+                uint64_t value = 0;
+                ok = ok && varint(value);
+                entry = static_cast<uint16_t>(value);
+            }
+            if (!ok) break;
+            return StackEvent(cycle, address, static_cast<uint16_t>(target), depth, stack);
+        }
+        case EventType::Register: {
+            uint64_t mask;
+            if (!varint(mask)) break;
+            RegisterEvent ev(cycle);
+            bool ok = true;
+            for (int reg = 0; reg < 16 && ok; ++reg) {
+                uint8_t value;
+                if ((mask & (1u << reg)) && (ok = byte(value))) {
+                    ev.set(reg, value);
+                }
+            }
+            if (!ok) break;
+            return ev;
+        }
+        case EventType::Memory: {
+            uint64_t address;
+            uint8_t length;
+            if (!varint(address) || !byte(length) || length > MemoryEvent::MAX_LENGTH || end_ - in < length) break;
+            MemoryEvent ev(cycle, static_cast<uint16_t>(address), in, length);
+            in += length;
+            return ev;
+        }
+        case EventType::Input: {
+            uint8_t packed;
+            if (!byte(packed)) break;
+            return InputEvent(cycle, packed & 0x0F, (packed & 0x80) != 0);
+        }
+        case EventType::Timer: {
+            uint8_t sound, value;
+            if (!byte(sound) || !byte(value)) break;
+            return TimerEvent(cycle, sound != 0, value);
+        }
+        case EventType::Draw: {
+            uint8_t x, y, packed;
+            uint64_t address;
+            if (!byte(x) || !byte(y) || !byte(packed) || !varint(address)) break;
+            uint8_t height = packed & 0x7F;
+            if (height > 15 || end_ - in < height) break;
+            DrawEvent ev(cycle, x, y, static_cast<uint16_t>(address), in, height, (packed & 0x80) != 0);
+            in += height;
+            return ev;
+        }
+        case EventType::FramebufferCleared:
+            return FramebufferClearedEvent(cycle);
+        default:
+            return fail("unknown event type");
+    }
+    return fail("truncated event");
+}
@@ -0,0 +1,178 @@
+#include "trace_writer.h"
+#include "lz_codec.h"
+#include "trace_format.h"
+#include <algorithm>
+#include <iostream>
+#include <iterator>
+
+// stdio buffer size; blocks reach the OS in chunks of at least this size.
+const size_t FILE_BUFFER_SIZE = 1 << 20;
+
+/**
+ * @brief Flushes and closes the file if still open.
+ */
+TraceWriter::~TraceWriter() {
+    close();
+}
+
+/**
+ * @brief Creates the file and writes the file header.
+ *
+ * @param path Output file.
+ * @param compress Try LZ compression for each block.
+ * @param blockSize Uncompressed bytes per block.
+ * @return bool False if the file could not be created.
+ */
+bool TraceWriter::open(const std::string& path, bool compress, size_t blockSize) {
+    close();
+    file_ = std::fopen(path.c_str(), "wb");
+    if (!file_) {
+        std::cerr << "Failed to create trace: " << path << std::endl;
+        return false;
+    }
+    fileBuffer_.resize(FILE_BUFFER_SIZE);
+    std::setvbuf(file_, fileBuffer_.data(), _IOFBF, fileBuffer_.size());
+
+    compress_ = compress;
+    blockSize_ = blockSize < trace::MAX_BLOCK_SIZE ? blockSize : trace::MAX_BLOCK_SIZE;
+    block_.clear();
+    block_.reserve(blockSize_ + 64);
+    blockEvents_ = 0;
+    lastCycle_ = 0;
+    lastPc_ = 0;
+
+    uint8_t header[trace::FILE_HEADER_SIZE] = {};
+    std::copy(std::begin(trace::MAGIC), std::end(trace::MAGIC), header);
+    trace::putLe16(header + 4, trace::VERSION);
+    trace::putLe16(header + 6, trace::FILE_HEADER_SIZE);
+    std::fwrite(header, 1, sizeof(header), file_);
+    return true;
+}
+
+/**
+ * @brief Encodes one event into the current block.
+ *
+ * Starts a new block once the current one reaches the block size.
+ *
+ * @param event The event to write.
+ */
+void TraceWriter::write(const EventVariant& event) {
+    if (!file_) {
+        return;
+    }
+
+    std::visit([this](auto&& ev) {
+        using T = std::decay_t<decltype(ev)>;
+        std::vector<uint8_t>& out = block_;
+
+        out.push_back(static_cast<uint8_t>(ev.type));
+        trace::putVarint(out, trace::zigzag(static_cast<int64_t>(ev.cycle - lastCycle_)));
+        lastCycle_ = ev.cycle;
+
+        auto putPc = [&](uint16_t pc) {
+            trace::putVarint(out, trace::zigzag(static_cast<int64_t>(pc) - lastPc_));
+            lastPc_ = pc;
+        };
+
+        if constexpr (std::is_same_v<T, OpcodeEvent>) {
+            putPc(ev.pc);
+            out.push_back(static_cast<uint8_t>(ev.opcode >> 8));
+            out.push_back(static_cast<uint8_t>(ev.opcode));
+        } else if constexpr (std::is_same_v<T, StackEvent>) {
+            putPc(ev.pc);
+            trace::putVarint(out, ev.target);
+            out.push_back(ev.depth);
+            for (uint16_t entry : ev.stack) {
+                trace::putVarint(out, entry);
+            }
+        } else if constexpr (std::is_same_v<T, RegisterEvent>) {
+            trace::putVarint(out, ev.mask);
+            for (int reg = 0; reg < 16; ++reg) {
+                if (ev.mask & (1u << reg)) {
+                    out.push_back(ev.values[reg]);
+                }
+            }
+        } else if constexpr (std::is_same_v<T, MemoryEvent>) {
+            trace::putVarint(out, ev.address);
+            out.push_back(ev.length);
+            out.insert(out.end(), ev.values.begin(), ev.values.begin() + ev.length);
+        } else if constexpr (std::is_same_v<T, InputEvent>) {
+            out.push_back(static_cast<uint8_t>((ev.key & 0x0F) | (ev.pressed ? 0x80 : 0)));
+        } else if constexpr (std::is_same_v<T, TimerEvent>) {
+            out.push_back(ev.sound ? 1 : 0);
+            out.push_back(ev.value);
+        } else if constexpr (std::is_same_v<T, DrawEvent>) {
+            out.push_back(ev.x);
+            out.push_back(ev.y);
+            out.push_back(static_cast<uint8_t>(ev.height | (ev.collision ? 0x80 : 0)));
+            trace::putVarint(out, ev.address);
+            out.insert(out.end(), ev.sprite.begin(), ev.sprite.begin() + ev.height);
+        }
+    }, event);
+
+    ++blockEvents_;
+    ++eventsWritten_;
+    if (block_.size() >= blockSize_) {
+        finishBlock();
+    }
+}
+
+/**
+ * @brief Writes the current block, compressed if that makes it smaller.
+ */
+void TraceWriter::finishBlock() {
+    if (blockEvents_ == 0) {
+        return;
+    }
+
+    const uint8_t* body = block_.data();
+    size_t bodySize = block_.size();
+    uint8_t codec = trace::CODEC_RAW;
+    if (compress_) {
+        compressed_.clear();
+        lzCompress(block_.data(), block_.size(), compressed_);
+        if (compressed_.size() < block_.size()) {
+            body = compressed_.data();
+            bodySize = compressed_.size();
+            codec = trace::CODEC_LZ;
+        }
+    }
+
+    uint8_t header[trace::BLOCK_HEADER_SIZE] = {};
+    trace::putLe32(header, static_cast<uint32_t>(block_.size()));
+    trace::putLe32(header + 4, static_cast<uint32_t>(bodySize));
+    trace::putLe32(header + 8, blockEvents_);
+    header[12] = codec;
+    std::fwrite(header, 1, sizeof(header), file_);
+    std::fwrite(body, 1, bodySize, file_);
+
+    rawBytes_ += block_.size();
+    storedBytes_ += bodySize + sizeof(header);
+    block_.clear();
+    blockEvents_ = 0;
+    lastCycle_ = 0;
+    lastPc_ = 0;
+}
+
+/**
+ * @brief Ends the current block and flushes the file buffer.
+ */
+void TraceWriter::flush() {
+    if (!file_) {
+        return;
+    }
+    finishBlock();
+    std::fflush(file_);
+}
+
+/**
+ * @brief Flushes and closes the file.
+ */
+void TraceWriter::close() {
+    if (!file_) {
+        return;
+    }
+    finishBlock();
+    std::fclose(file_);
+    file_ = nullptr;
+}
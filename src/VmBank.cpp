@@ -0,0 +1,564 @@
+#include "vm_bank.h"
+#include "chip8_state.h"
+#include <algorithm>
+#include <iostream>
+
+// Modulus and multiplier of the minstd generator behind CXNN, as in Chip8.
+const uint32_t BANK_MINSTD_MODULUS = 2147483647u;
+const uint32_t BANK_MINSTD_MULTIPLIER = 48271u;
+
+using Decoder = OpcodeHandler<TraceLevel::None>;
+
+/**
+ * @brief Constructs a bank of N lanes with no program loaded.
+ */
+template <size_t N>
+VmBank<N>::VmBank() : memory(N), gfx(N), steps(0), instructions(0), vectorLanes(0) {
+    loadProgram(nullptr, 0);
+}
+
+/**
+ * @brief Resets every lane and loads the same program into each.
+ *
+ * The initial state is taken from a freshly constructed Chip8, so the lanes
+ * start exactly where a scalar core would, fontset included.
+ *
+ * @param data Program bytes.
+ * @param size Number of bytes.
+ * @return bool False if the program does not fit in memory.
+ */
+template <size_t N>
+bool VmBank<N>::loadProgram(const uint8_t* data, size_t size) {
+    Chip8 reference;
+    if (size > 0 && !reference.loadProgram(data, size)) {
+        return false;
+    }
+    Chip8State initial;
+    reference.saveState(initial);
+
+    for (size_t lane = 0; lane < N; ++lane) {
+        memory[lane].bytes = initial.memory;
+        gfx[lane].setRows(initial.display.data());
+        key[lane] = initial.key;
+        for (int r = 0; r < 16; ++r) {
+            V[r][lane] = initial.V[r];
+            stack[r][lane] = initial.stack[r];
+        }
+        pc[lane] = initial.pc;
+        I[lane] = initial.I;
+        sp[lane] = initial.sp;
+        delayTimer[lane] = initial.delayTimer;
+        soundTimer[lane] = initial.soundTimer;
+        rngState[lane] = initial.rngState;
+        cycleCount[lane] = initial.cycleCount;
+        idleState[lane] = IdleState::Running;
+    }
+    writtenLow = 0x1000;
+    writtenHigh = 0;
+    steps = 0;
+    instructions = 0;
+    vectorLanes = 0;
+    return true;
+}
+
+/**
+ * @brief Seeds one lane's CXNN generator.
+ *
+ * @param lane Lane index.
+ * @param seed The seed value; 0 is replaced by 1, as in Chip8::seedRandom().
+ */
+template <size_t N>
+void VmBank<N>::seedRandom(size_t lane, uint32_t seed) {
+    rngState[lane] = seed % BANK_MINSTD_MODULUS;
+    if (rngState[lane] == 0) {
+        rngState[lane] = 1;
+    }
+}
+
+/**
+ * @brief Sets one lane's keypad.
+ *
+ * @param lane Lane index.
+ * @param keys Bit i set while key i is held.
+ */
+template <size_t N>
+void VmBank<N>::setKeys(size_t lane, uint16_t keys) {
+    for (int i = 0; i < 16; ++i) {
+        key[lane][i] = (keys >> i) & 1;
+    }
+}
+
+/**
+ * @brief Advances a minstd state: state * 48271 mod (2^31 - 1).
+ *
+ * Reduces with a shift and an add instead of a 64-bit division, using
+ * 2^31 = 1 (mod 2^31 - 1), so the lane loop in executeVector() vectorises.
+ * The sequence is identical to Chip8::nextRandom().
+ *
+ * @param state Current state, in [1, 2^31 - 2].
+ * @return uint32_t The next state.
+ */
+static inline uint32_t minstdNext(uint32_t state) {
+    uint64_t product = static_cast<uint64_t>(state) * BANK_MINSTD_MULTIPLIER;
+    uint32_t reduced = static_cast<uint32_t>((product & BANK_MINSTD_MODULUS) + (product >> 31));
+    return reduced >= BANK_MINSTD_MODULUS ? reduced - BANK_MINSTD_MODULUS : reduced;
+}
+
+/**
+ * @brief Widens the range of memory that lanes may hold differently.
+ *
+ * @param address First written address.
+ * @param length Number of bytes written.
+ */
+template <size_t N>
+void VmBank<N>::markWritten(uint16_t address, uint16_t length) {
+    uint16_t start = address & 0x0FFF;
+    if (start + length > 0x1000) {
+        writtenLow = 0;
+        writtenHigh = 0x1000;
+        return;
+    }
+    writtenLow = std::min<uint16_t>(writtenLow, start);
+    writtenHigh = std::max<uint16_t>(writtenHigh, start + length);
+}
+
+/**
+ * @brief Advances one lane's delay and sound timers by one 60Hz tick.
+ *
+ * @param lane Lane index.
+ */
+template <size_t N>
+void VmBank<N>::tickTimers(size_t lane) {
+    if (delayTimer[lane] > 0) {
+        --delayTimer[lane];
+    }
+    if (soundTimer[lane] > 0) {
+        --soundTimer[lane];
+    }
+}
+
+/**
+ * @brief Flags idle loops ending in a jump, as OpcodeHandler::detectIdleLoop().
+ *
+ * @param lane Lane index.
+ * @param jumpAddress Address of the jump instruction.
+ * @param target Jump destination.
+ */
+template <size_t N>
+void VmBank<N>::detectIdleLoop(size_t lane, uint16_t jumpAddress, uint16_t target) {
+    if (target == jumpAddress) {
+        idleState[lane] = IdleState::Halted;
+    } else if (target + 4 == jumpAddress && delayTimer[lane] > 0) {
+        // pc is not masked, so read the loop wrapped like the scalar core's memory
+        const auto& mem = memory[lane].bytes;
+        uint8_t first = mem[target & 0x0FFF];
+        uint8_t x = first & 0x0F;
+        if ((first & 0xF0) == 0xF0 && mem[(target + 1) & 0x0FFF] == 0x07 &&
+            mem[(target + 2) & 0x0FFF] == (0x30 | x) && mem[(target + 3) & 0x0FFF] == 0x00) {
+            idleState[lane] = IdleState::WaitingForTimer;
+        }
+    }
+}
+
+/**
+ * @brief Returns whether executeVector() handles an instruction.
+ *
+ * These are the instructions that touch only registers and timers: they
+ * never jump, never go idle and never write memory or the display.
+ *
+ * @param inst The decoded instruction.
+ * @return bool True for 3XNN-9XY0, ANNN, CXNN and the FX register and timer moves.
+ */
+template <size_t N>
+bool VmBank<N>::isVector(const Instruction& inst) {
+    switch (inst.opcode & 0xF000) {
+        case 0x3000: case 0x4000: case 0x5000: case 0x6000: case 0x7000:
+        case 0x9000: case 0xA000: case 0xC000:
+            return true;
+        case 0x8000:
+            return inst.handler != Decoder::op_unknown;
+        case 0xF000:
+            return inst.nn == 0x07 || inst.nn == 0x15 || inst.nn == 0x18 || inst.nn == 0x1E || inst.nn == 0x29;
+    }
+    return false;
+}
+
+/**
+ * @brief Runs a register-only instruction on every lane in mask at once.
+ *
+ * Each statement of the scalar handler becomes one blended loop over the
+ * lanes, in the handler's order, so VF results are identical when x or y is
+ * F. The loops touch contiguous registers and have no branches, so they
+ * compile to vector compares, adds and blends. Skips become a per-lane pc
+ * increment of 2 or 4.
+ *
+ * @param inst The decoded instruction; isVector(inst) must hold.
+ * @param mask 0xFF for the lanes executing it.
+ */
+template <size_t N>
+void VmBank<N>::executeVector(const Instruction& inst, const LaneMask& mask) {
+    uint8_t* vx = V[inst.x];
+    const uint8_t* vy = V[inst.y];
+    uint8_t* vf = V[0xF];
+    const uint8_t* m = mask.data();
+    uint8_t advance[N];   // pc increment per lane
+    std::fill(advance, advance + N, 2);
+    auto blend = [](uint8_t old, uint8_t value, uint8_t keep) {
+        return static_cast<uint8_t>((old & ~keep) | (value & keep));
+    };
+    auto wide = [](uint8_t keep) {
+        return static_cast<uint16_t>(static_cast<int16_t>(static_cast<int8_t>(keep)));
+    };
+
+    switch (inst.opcode & 0xF000) {
+        case 0x3000:
+            for (size_t l = 0; l < N; ++l) advance[l] = vx[l] == inst.nn ? 4 : 2;
+            break;
+        case 0x4000:
+            for (size_t l = 0; l < N; ++l) advance[l] = vx[l] != inst.nn ? 4 : 2;
+            break;
+        case 0x5000:
+            for (size_t l = 0; l < N; ++l) advance[l] = vx[l] == vy[l] ? 4 : 2;
+            break;
+        case 0x9000:
+            for (size_t l = 0; l < N; ++l) advance[l] = vx[l] != vy[l] ? 4 : 2;
+            break;
+        case 0x6000:
+            for (size_t l = 0; l < N; ++l) vx[l] = blend(vx[l], inst.nn, m[l]);
+            break;
+        case 0x7000:
+            for (size_t l = 0; l < N; ++l) vx[l] = blend(vx[l], vx[l] + inst.nn, m[l]);
+            break;
+        case 0xA000:
+            for (size_t l = 0; l < N; ++l) I[l] = (I[l] & ~wide(m[l])) | (inst.nnn & wide(m[l]));
+            break;
+        case 0xC000:
+            // Every lane advances its own generator
+            for (size_t l = 0; l < N; ++l) {
+                uint32_t next = minstdNext(rngState[l]);
+                uint32_t keep = static_cast<uint32_t>(static_cast<int32_t>(static_cast<int8_t>(m[l])));
+                rngState[l] = (rngState[l] & ~keep) | (next & keep);
+                vx[l] = blend(vx[l], static_cast<uint8_t>(next % 256) & inst.nn, m[l]);
+            }
+            break;
+        case 0xF000:
+            switch (inst.nn) {
+                case 0x07:
+                    for (size_t l = 0; l < N; ++l) vx[l] = blend(vx[l], delayTimer[l], m[l]);
+                    break;
+                case 0x15:
+                    for (size_t l = 0; l < N; ++l) delayTimer[l] = blend(delayTimer[l], vx[l], m[l]);
+                    break;
+                case 0x18:
+                    for (size_t l = 0; l < N; ++l) soundTimer[l] = blend(soundTimer[l], vx[l], m[l]);
+                    break;
+                case 0x1E:
+                    for (size_t l = 0; l < N; ++l) I[l] += vx[l] & wide(m[l]);
+                    break;
+                case 0x29:
+                    for (size_t l = 0; l < N; ++l) I[l] = (I[l] & ~wide(m[l])) | ((vx[l] * 5) & wide(m[l]));
+                    break;
+            }
+            break;
+        case 0x8000:
+            switch (inst.n) {
+                case 0x0:
+                    for (size_t l = 0; l < N; ++l) vx[l] = blend(vx[l], vy[l], m[l]);
+                    break;
+                case 0x1:
+                    for (size_t l = 0; l < N; ++l) vx[l] = blend(vx[l], vx[l] | vy[l], m[l]);
+                    break;
+                case 0x2:
+                    for (size_t l = 0; l < N; ++l) vx[l] = blend(vx[l], vx[l] & vy[l], m[l]);
+                    break;
+                case 0x3:
+                    for (size_t l = 0; l < N; ++l) vx[l] = blend(vx[l], vx[l] ^ vy[l], m[l]);
+                    break;
+                case 0x4: {
+                    // The sum is taken before VF is written, as in op_8XY4
+                    uint8_t sum[N];
+                    uint8_t carry[N];
+                    for (size_t l = 0; l < N; ++l) {
+                        sum[l] = static_cast<uint8_t>(vx[l] + vy[l]);
+                        carry[l] = sum[l] < vx[l] ? 1 : 0;
+                    }
+                    for (size_t l = 0; l < N; ++l) vf[l] = blend(vf[l], carry[l], m[l]);
+                    for (size_t l = 0; l < N; ++l) vx[l] = blend(vx[l], sum[l], m[l]);
+                    break;
+                }
+                case 0x5:
+                    for (size_t l = 0; l < N; ++l) vf[l] = blend(vf[l], vx[l] > vy[l] ? 1 : 0, m[l]);
+                    for (size_t l = 0; l < N; ++l) vx[l] = blend(vx[l], vx[l] - vy[l], m[l]);
+                    break;
+                case 0x6:
+                    for (size_t l = 0; l < N; ++l) vf[l] = blend(vf[l], vx[l] & 0x1, m[l]);
+                    for (size_t l = 0; l < N; ++l) vx[l] = blend(vx[l], vx[l] >> 1, m[l]);
+                    break;
+                case 0x7:
+                    for (size_t l = 0; l < N; ++l) vf[l] = blend(vf[l], vy[l] > vx[l] ? 1 : 0, m[l]);
+                    for (size_t l = 0; l < N; ++l) vx[l] = blend(vx[l], vy[l] - vx[l], m[l]);
+                    break;
+                case 0xE:
+                    for (size_t l = 0; l < N; ++l) vf[l] = blend(vf[l], (vx[l] & 0x80) >> 7, m[l]);
+                    for (size_t l = 0; l < N; ++l) vx[l] = blend(vx[l], vx[l] << 1, m[l]);
+                    break;
+            }
+            break;
+    }
+    for (size_t l = 0; l < N; ++l) {
+        pc[l] += advance[l] & m[l];
+    }
+}
+
+/**
+ * @brief Runs one instruction on a single lane, with OpcodeHandler semantics.
+ *
+ * Addresses are wrapped to 4 KiB where the scalar core would index past
+ * the end of memory.
+ *
+ * @param lane Lane index.
+ * @param inst The decoded instruction.
+ */
+template <size_t N>
+void VmBank<N>::executeLane(size_t lane, const Instruction& inst) {
+    uint8_t& vx = V[inst.x][lane];
+    uint8_t& vy = V[inst.y][lane];
+    uint8_t& vf = V[0xF][lane];
+    uint16_t& p = pc[lane];
+    auto& mem = memory[lane].bytes;
+
+    if (isVector(inst)) {
+        LaneMask mask = {};
+        mask[lane] = 0xFF;
+        executeVector(inst, mask);
+        return;
+    }
+    switch (inst.opcode & 0xF000) {
+        case 0x0000:
+            if (inst.opcode == 0x00E0) {
+                gfx[lane].clear();
+                p += 2;
+            } else if (inst.opcode == 0x00EE) {
+                sp[lane] = (sp[lane] - 1) & 0x0F;
+                p = stack[sp[lane]][lane] + 2;
+            } else {
+                break;
+            }
+            return;
+        case 0x1000:
+            detectIdleLoop(lane, p, inst.nnn);
+            p = inst.nnn;
+            return;
+        case 0x2000:
+            stack[sp[lane]][lane] = p;
+            sp[lane] = (sp[lane] + 1) & 0x0F;
+            p = inst.nnn;
+            return;
+        case 0xB000: p = inst.nnn + V[0][lane]; return;
+        case 0xD000: {
+            uint8_t x = vx;
+            uint8_t y = vy;
+            bool collision = false;
+            for (int row = 0; row < inst.n; ++row) {
+                collision |= gfx[lane].drawSpriteRow(x, y + row, mem[(I[lane] + row) & 0x0FFF]);
+            }
+            vf = collision ? 1 : 0;
+            p += 2;
+            return;
+        }
+        case 0xE000:
+            if (inst.nn == 0x9E) {
+                p += key[lane][vx & 0x0F] != 0 ? 4 : 2;
+            } else if (inst.nn == 0xA1) {
+                p += key[lane][vx & 0x0F] == 0 ? 4 : 2;
+            } else {
+                break;
+            }
+            return;
+        case 0xF000:
+            switch (inst.nn) {
+                case 0x0A:
+                    for (int i = 0; i < 16; ++i) {
+                        if (key[lane][i] != 0) {
+                            vx = i;
+                            p += 2;
+                            return;
+                        }
+                    }
+                    idleState[lane] = IdleState::WaitingForKey;
+                    return;
+                case 0x33: {
+                    uint8_t value = vx;
+                    mem[I[lane] & 0x0FFF] = value / 100;
+                    mem[(I[lane] + 1) & 0x0FFF] = (value / 10) % 10;
+                    mem[(I[lane] + 2) & 0x0FFF] = value % 10;
+                    markWritten(I[lane], 3);
+                    p += 2;
+                    return;
+                }
+                case 0x55:
+                    for (int i = 0; i <= inst.x; ++i) {
+                        mem[(I[lane] + i) & 0x0FFF] = V[i][lane];
+                    }
+                    markWritten(I[lane], inst.x + 1);
+                    p += 2;
+                    return;
+                case 0x65:
+                    for (int i = 0; i <= inst.x; ++i) {
+                        V[i][lane] = mem[(I[lane] + i) & 0x0FFF];
+                    }
+                    p += 2;
+                    return;
+            }
+            break;
+    }
+
+    std::cerr << "Unknown opcode [0x" << std::hex << (inst.opcode & 0xF000) << "]: "
+              << inst.opcode << std::dec << std::endl;
+    p += 2;
+}
+
+/**
+ * @brief Runs each lane for up to budgets[lane] instructions.
+ *
+ * Every step takes the lowest pc among the running lanes, decodes the
+ * instruction there once, and runs it on every running lane at that pc with
+ * the same opcode: as SIMD lanes for the register-only instructions (see
+ * isVector()), lane by lane
+ * otherwise. Lanes at that pc whose memory holds a different opcode
+ * (self-modifying code) run their own instruction in the same step; the
+ * per-lane opcode check is skipped for addresses no lane has stored to.
+ *
+ * A lane stops when its budget is used up or when it goes idle, with the
+ * same rules as Chip8::execute(): an instruction that leaves pc unchanged
+ * halts the lane.
+ *
+ * @param budgets Instruction budget per lane.
+ * @param executed Receives the number of instructions each lane ran.
+ */
+template <size_t N>
+void VmBank<N>::execute(const uint64_t* budgets, uint64_t* executed) {
+    const uint32_t STOPPED = 0x10000;   // Above every pc
+    uint64_t remaining[N];
+    uint32_t order[N];                  // pc of each running lane, STOPPED otherwise
+    for (size_t l = 0; l < N; ++l) {
+        executed[l] = 0;
+        remaining[l] = budgets[l];
+        if (budgets[l] > 0) {
+            idleState[l] = IdleState::Running;
+        }
+        order[l] = budgets[l] > 0 ? pc[l] : STOPPED;
+    }
+
+    auto fetch = [this](size_t lane, uint16_t address) {
+        return static_cast<uint16_t>(memory[lane].bytes[address & 0x0FFF] << 8 | memory[lane].bytes[(address + 1) & 0x0FFF]);
+    };
+    auto retire = [&](size_t lane, uint16_t pcBefore) {
+        ++cycleCount[lane];
+        ++executed[lane];
+        --remaining[lane];
+        if (idleState[lane] != IdleState::Running || pc[lane] == pcBefore) {
+            if (idleState[lane] == IdleState::Running) {
+                idleState[lane] = IdleState::Halted;
+            }
+            order[lane] = STOPPED;
+        } else {
+            order[lane] = remaining[lane] > 0 ? pc[lane] : STOPPED;
+        }
+    };
+
+    for (;;) {
+        uint32_t lowest = STOPPED;
+        for (size_t l = 0; l < N; ++l) {
+            lowest = std::min(lowest, order[l]);
+        }
+        if (lowest == STOPPED) {
+            break;
+        }
+        uint16_t address = static_cast<uint16_t>(lowest);
+        size_t leader = 0;
+        while (order[leader] != lowest) {
+            ++leader;
+        }
+        uint16_t opcode = fetch(leader, address);
+        // Lanes can only hold different code where some lane has stored
+        bool mayDiffer = (address & 0x0FFF) + 2 > writtenLow && (address & 0x0FFF) < writtenHigh;
+        mayDiffer |= (address & 0x0FFF) == 0x0FFF;
+
+        LaneMask mask;
+        for (size_t l = 0; l < N; ++l) {
+            mask[l] = order[l] == lowest ? 0xFF : 0;
+        }
+        size_t groupSize = 0;
+        for (size_t l = leader; l < N; ++l) {
+            if (!mask[l]) {
+                continue;
+            }
+            uint16_t own = mayDiffer ? fetch(l, address) : opcode;
+            if (own == opcode) {
+                ++groupSize;
+            } else {
+                mask[l] = 0;
+                executeLane(l, Decoder::decode(own));
+                retire(l, address);
+                ++steps;
+                ++instructions;
+            }
+        }
+
+        Instruction inst = Decoder::decode(opcode);
+        // A jump that cannot be an idle loop moves every lane the same way
+        bool plainJump = (opcode & 0xF000) == 0x1000 && inst.nnn != address && inst.nnn + 4 != address;
+        if (groupSize > 1 && (plainJump || isVector(inst))) {
+            // These instructions never idle, so every lane just moves on
+            if (plainJump) {
+                for (size_t l = 0; l < N; ++l) {
+                    pc[l] = mask[l] ? inst.nnn : pc[l];
+                }
+            } else {
+                executeVector(inst, mask);
+            }
+            for (size_t l = 0; l < N; ++l) {
+                uint64_t ran = mask[l] & 1;
+                cycleCount[l] += ran;
+                executed[l] += ran;
+                remaining[l] -= ran;
+                if (ran) {
+                    order[l] = remaining[l] > 0 ? pc[l] : STOPPED;
+                }
+            }
+            vectorLanes += groupSize;
+        } else {
+            for (size_t l = leader; l < N; ++l) {
+                if (mask[l]) {
+                    executeLane(l, inst);
+                    retire(l, address);
+                }
+            }
+        }
+        ++steps;
+        instructions += groupSize;
+    }
+}
+
+/**
+ * @brief Reports how well the lanes stayed in lockstep.
+ *
+ * @return VmBankStats Counters since the program was loaded.
+ */
+template <size_t N>
+VmBankStats VmBank<N>::getStats() const {
+    VmBankStats stats;
+    stats.steps = steps;
+    stats.instructions = instructions;
+    stats.vectorLanes = vectorLanes;
+    if (steps > 0) {
+        stats.avgGroupSize = static_cast<double>(instructions) / steps;
+    }
+    return stats;
+}
+
+// The widths selectable from BatchConfig::bankWidth.
+template class VmBank<8>;
+template class VmBank<16>;
+template class VmBank<32>;
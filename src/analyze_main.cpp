@@ -0,0 +1,89 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+#include "rom_analysis.h"
+
+/**
+ * @brief Prints command line usage for the ROM analyzer.
+ *
+ * @param program Name of the executable.
+ */
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options] <ROM file>\n"
+              << "  --format F      listing, dot (Graphviz CFG) or json (default listing)\n"
+              << "  --output FILE   Write to FILE instead of stdout\n";
+}
+
+/**
+ * @brief Entry point for the ROM analyzer.
+ *
+ * Analyzes one ROM image as loaded at 0x200 (see RomAnalysis) and writes
+ * the result in the selected format, followed by a one-line summary on
+ * stderr.
+ */
+int main(int argc, char* argv[]) {
+    std::string format = "listing";
+    const char* outputPath = nullptr;
+    const char* romPath = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--format") == 0 && hasValue) {
+            format = argv[++i];
+            if (format != "listing" && format != "dot" && format != "json") {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--output") == 0 && hasValue) {
+            outputPath = argv[++i];
+        } else if (argv[i][0] == '-' || romPath) {
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            romPath = argv[i];
+        }
+    }
+    if (!romPath) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::ifstream file(romPath, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open ROM: " << romPath << std::endl;
+        return 1;
+    }
+    std::vector<uint8_t> rom((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    RomAnalysis analysis;
+    if (!analysis.analyze(rom.data(), rom.size())) {
+        return 1;
+    }
+
+    std::ofstream outputFile;
+    if (outputPath) {
+        outputFile.open(outputPath);
+        if (!outputFile.is_open()) {
+            std::cerr << "Failed to open output: " << outputPath << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = outputPath ? outputFile : std::cout;
+    if (format == "dot") {
+        analysis.writeDot(out);
+    } else if (format == "json") {
+        analysis.writeJson(out);
+    } else {
+        analysis.writeListing(out);
+    }
+
+    std::cerr << romPath << ": " << analysis.getBlocks().size() << " blocks, "
+              << analysis.getSubroutines().size() << " subroutines, "
+              << analysis.getIndirectJumps().size() << " indirect jumps, "
+              << analysis.countBytes(RomAnalysis::Code) + analysis.countBytes(RomAnalysis::Operand)
+              << " code bytes of " << analysis.getRomSize()
+              << (analysis.selfModifying() ? ", self-modifying" : "") << std::endl;
+    return out.good() ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <vector>
+#include "aot_compiler.h"
+
+/**
+ * @brief Prints command line usage for the AOT compiler.
+ *
+ * @param program Name of the executable.
+ */
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options] <ROM file>\n"
+              << "  --output FILE   Write the C++ source to FILE instead of stdout\n";
+}
+
+/**
+ * @brief Entry point for the AOT compiler.
+ *
+ * Compiles one ROM image into a C++ translation unit (see AotCompiler) to
+ * be built into a shared object and run with chip8-headless --aot, followed
+ * by a one-line summary on stderr.
+ */
+int main(int argc, char* argv[]) {
+    const char* outputPath = nullptr;
+    const char* romPath = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--output") == 0 && hasValue) {
+            outputPath = argv[++i];
+        } else if (argv[i][0] == '-' || romPath) {
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            romPath = argv[i];
+        }
+    }
+    if (!romPath) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::ifstream file(romPath, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open ROM: " << romPath << std::endl;
+        return 1;
+    }
+    std::vector<uint8_t> rom((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    AotCompiler compiler;
+    if (!compiler.compile(rom.data(), rom.size())) {
+        return 1;
+    }
+
+    std::ofstream outputFile;
+    if (outputPath) {
+        outputFile.open(outputPath);
+        if (!outputFile.is_open()) {
+            std::cerr << "Failed to open output: " << outputPath << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = outputPath ? outputFile : std::cout;
+    compiler.writeSource(out, romPath);
+
+    std::cerr << romPath << ": " << compiler.getBlockCount() << " blocks, "
+              << compiler.getInstructionCount() << " instructions, "
+              << compiler.getDispatchCount() << " through handlers"
+              << (compiler.getAnalysis().selfModifying() ? ", self-modifying (falls back to the interpreter)" : "")
+              << std::endl;
+    return out.good() ? 0 : 1;
+}
@@ -1,8 +1,17 @@
 #include "emulator.h"
 #include <iostream>
-#include <chrono>
-#include <thread>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 #include <SDL3/SDL.h>
+#include <thread>
+
+// How long the main thread waits for events while a present is being deferred.
+const int PENDING_PRESENT_POLL_MS = 2;
+
+// Held to run the emulation backwards one frame per frame.
+const SDL_Scancode REWIND_KEY = SDL_SCANCODE_BACKSPACE;
 
 const SDL_Scancode keymap[16] = {
     SDL_SCANCODE_X,    // 0
@@ -23,12 +32,37 @@ const SDL_Scancode keymap[16] = {
     SDL_SCANCODE_V     // F
 };
 
-const int FRAME_DELAY_US = 16667; // Approx 60Hz
+/**
+ * @brief Prints command line usage and exits.
+ *
+ * @param program Name of the executable.
+ */
+static void usage(const char* program) {
+    std::cerr << "Usage: " << program << " [options] <ROM file> [cycles per second | unlimited]\n"
+              << "  --vsync           Wait for the display refresh when presenting\n"
+              << "  --fps-cap N       Present at most N frames per second (default 60, 0 = no cap)\n"
+              << "  --frame-skip N    Drop up to N frames in a row while emulation is behind (default 0)\n"
+              << "  --trace LEVEL     Event log detail: none, opcodes or full (default full)\n"
+              << "  --rewind-mb N     Memory for rewind history in MiB (default 16, 0 = no rewind)\n"
+              << "  --keyframe-interval N  Frames between full rewind snapshots (default 60)\n"
+              << "  --seed N          Seed for the CXNN random number generator (default 0)\n"
+              << "  --record FILE     Record key input to FILE for chip8-headless --replay\n"
+              << "  --profile PATH    Write an execution profile to PATH.txt and PATH.folded on exit and on SIGUSR1"
+              << std::endl;
+    exit(1);
+}
 
 /**
  * @brief Sets up the CHIP-8 emulator environment.
  *
  * Initializes the emulator, loads the ROM, and sets up the renderer.
+ * An optional second argument sets the CPU speed in instructions per second,
+ * or "unlimited" to run as fast as possible. Options before the ROM select
+ * the presentation policy (see FramePacer), the event trace level, the
+ * rewind history (see RewindBuffer), input recording (see InputMovie) and
+ * profiling (see Profiler).
+ * Recording needs a fixed CPU speed, since replays derive every frame's
+ * instruction budget from it.
  * Exits the program if initialization fails or arguments are invalid.
  *
  * @param argc Argument count from main.
@@ -38,50 +72,326 @@ void Emulator::setup(int argc, char* argv[]) {
 
     std::cout << "Chip-8 Emulator setup" << std::endl;
 
-    if(argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <ROM file>" << std::endl;
-        exit(1);
+    bool vsync = false;
+    uint32_t seed = 0;
+    TraceLevel traceLevel = TraceLevel::Full;
+    int arg = 1;
+    for (; arg < argc && std::strncmp(argv[arg], "--", 2) == 0; ++arg) {
+        bool hasValue = arg + 1 < argc;
+        if (std::strcmp(argv[arg], "--vsync") == 0) {
+            vsync = true;
+        } else if (std::strcmp(argv[arg], "--fps-cap") == 0 && hasValue) {
+            pacer.setMaxPresentHz(std::atof(argv[++arg]));
+        } else if (std::strcmp(argv[arg], "--frame-skip") == 0 && hasValue) {
+            pacer.setMaxFrameSkip(std::atoi(argv[++arg]));
+        } else if (std::strcmp(argv[arg], "--trace") == 0 && hasValue) {
+            const char* level = argv[++arg];
+            if (std::strcmp(level, "none") == 0) {
+                traceLevel = TraceLevel::None;
+            } else if (std::strcmp(level, "opcodes") == 0) {
+                traceLevel = TraceLevel::Opcodes;
+            } else if (std::strcmp(level, "full") == 0) {
+                traceLevel = TraceLevel::Full;
+            } else {
+                usage(argv[0]);
+            }
+        } else if (std::strcmp(argv[arg], "--rewind-mb") == 0 && hasValue) {
+            double megabytes = std::atof(argv[++arg]);
+            rewindEnabled = megabytes > 0;
+            rewind.setMemoryBudget(static_cast<size_t>(megabytes * (1 << 20)));
+        } else if (std::strcmp(argv[arg], "--keyframe-interval") == 0 && hasValue) {
+            rewind.setKeyframeInterval(static_cast<uint32_t>(std::atoi(argv[++arg])));
+        } else if (std::strcmp(argv[arg], "--seed") == 0 && hasValue) {
+            seed = static_cast<uint32_t>(std::strtoul(argv[++arg], nullptr, 0));
+        } else if (std::strcmp(argv[arg], "--record") == 0 && hasValue) {
+            moviePath = argv[++arg];
+        } else if (std::strcmp(argv[arg], "--profile") == 0 && hasValue) {
+            profilePath = argv[++arg];
+        } else {
+            usage(argv[0]);
+        }
     }
 
-    chip8.loadRom(argv[1]);
+    if(argc - arg < 1 || argc - arg > 2) {
+        usage(argv[0]);
+    }
+    const char* romPath = argv[arg];
+
+    if (argc - arg == 2) {
+        const char* speed = argv[arg + 1];
+        if (std::strcmp(speed, "unlimited") == 0) {
+            scheduler.setCyclesPerSecond(Scheduler::UNLIMITED);
+            chip8.setExecutionMode(ExecutionMode::Translated);
+        } else {
+            int cyclesPerSecond = std::atoi(speed);
+            if (cyclesPerSecond <= 0) {
+                std::cerr << "Invalid cycles per second: " << speed << std::endl;
+                exit(1);
+            }
+            scheduler.setCyclesPerSecond(cyclesPerSecond);
+        }
+    }
+
+    if (traceLevel != TraceLevel::None) {
+        chip8.setEventLogger(&EventLogger::createInstance(), traceLevel);
+    }
+    if (!profilePath.empty()) {
+        profiler = std::make_unique<Profiler>();
+        chip8.setProfiler(profiler.get());
+        Profiler::installSignalHandler();
+    }
+    chip8.seedRandom(seed);
+    chip8.loadRom(romPath);
+
+    if (!moviePath.empty()) {
+        if (scheduler.getCyclesPerSecond() == Scheduler::UNLIMITED) {
+            std::cerr << "--record needs a fixed CPU speed" << std::endl;
+            exit(1);
+        }
+        std::ifstream file(romPath, std::ios::binary);
+        std::vector<uint8_t> rom((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        movie.begin(rom.data(), rom.size(), seed, scheduler.getCyclesPerSecond());
+    }
 
     if (renderer.initialize() != 0) {
         std::cerr << "Setup failed with error code: 1" << std::endl;
         exit(1);
     }
+    renderer.setVSync(vsync);
+    frameReadyEvent = SDL_RegisterEvents(1);
 }
 
 /**
- * @brief Runs the main emulation loop.
+ * @brief Applies a single SDL event on the main thread.
  *
- * Handles SDL events, processes key input, executes CHIP-8 cycles,
- * and triggers rendering when needed. Runs at approximately 60Hz.
+ * Key changes only update the shared key bitmask (or the rewind flag); the
+ * emulation thread applies them at the start of its next frame.
+ *
+ * @param event The event to handle.
  */
-void Emulator::run() {
-    while(running){
-        while (SDL_PollEvent(&event)) {
-            if (event.type == SDL_EVENT_QUIT) {
-                running = false;
+void Emulator::handleEvent(const SDL_Event& event) {
+    if (event.type == SDL_EVENT_QUIT) {
+        stop();
+    }
+    if(event.type == SDL_EVENT_KEY_DOWN || event.type == SDL_EVENT_KEY_UP) {
+        bool pressed = (event.type == SDL_EVENT_KEY_DOWN);
+        SDL_Scancode scancode = event.key.scancode;
+        if (scancode == REWIND_KEY) {
+            std::lock_guard<std::mutex> lock(inputMutex);
+            rewindHeld.store(pressed, std::memory_order_release);
+            inputChanged.notify_one();
+        }
+        for (int i = 0; i < 16; ++i) {
+            if (scancode == keymap[i]) {
+                uint16_t bit = static_cast<uint16_t>(1u << i);
+                std::lock_guard<std::mutex> lock(inputMutex);
+                if (pressed) {
+                    keyState.fetch_or(bit, std::memory_order_release);
+                } else {
+                    keyState.fetch_and(static_cast<uint16_t>(~bit), std::memory_order_release);
+                }
+                inputChanged.notify_one();
             }
-            if(event.type == SDL_EVENT_KEY_DOWN || event.type == SDL_EVENT_KEY_UP) {
-                bool pressed = (event.type == SDL_EVENT_KEY_DOWN);
-                SDL_Scancode scancode = event.key.scancode;
-                for (int i = 0; i < 16; ++i) {
-                    if (scancode == keymap[i]) {
-                        chip8.key[i] = pressed ? 1 : 0;
-                        EventLogger::pushLog(InputEvent(i, pressed));
-                    }
+        }
+    }
+}
+
+/**
+ * @brief Asks both threads to finish and wakes the emulation thread.
+ */
+void Emulator::stop() {
+    std::lock_guard<std::mutex> lock(inputMutex);
+    running = false;
+    inputChanged.notify_one();
+}
+
+/**
+ * @brief Copies the key bitmask into the core, logging each change while tracing
+ *        and recording it while recording a movie.
+ *
+ * Runs on the emulation thread, which keeps it the only producer of events.
+ *
+ * @param keys Current key bitmask.
+ */
+void Emulator::applyInput(uint16_t keys) {
+    bool changed = false;
+    for (int i = 0; i < 16; ++i) {
+        uint8_t pressed = (keys >> i) & 1;
+        if (chip8.key[i] != pressed) {
+            chip8.key[i] = pressed;
+            changed = true;
+            if (chip8.getTraceLevel() != TraceLevel::None) {
+                EventLogger::createInstance().log(InputEvent(chip8.getCycleCount(), static_cast<uint8_t>(i), pressed != 0));
+            }
+        }
+    }
+    if (changed && !moviePath.empty()) {
+        movie.recordInput(timelineFrame, chip8.getCycleCount(), keys);
+    }
+}
+
+/**
+ * @brief Emulation thread body.
+ *
+ * Executes one scheduler frame of CHIP-8 cycles per 60Hz period and
+ * publishes the framebuffer whenever it changed. While the program waits on
+ * FX0A with both timers stopped, nothing can change until input arrives, so
+ * the thread sleeps on the input condition instead of spinning through
+ * empty frames. Each frame's state goes into the rewind history; while the
+ * rewind key is held, frames are popped from it instead of emulated. A
+ * recording follows the rewound timeline: stepping back drops the recorded
+ * future and realigns the scheduler so later frames keep their budgets.
+ * While profiling, each frame is counted and a dump requested by SIGUSR1 is
+ * written here, on the thread that owns the core.
+ */
+void Emulator::emulationLoop() {
+    scheduler.start();
+    while (running) {
+        uint16_t keys = keyState.load(std::memory_order_acquire);
+        if (rewindEnabled && rewindHeld.load(std::memory_order_acquire)) {
+            // Step back one frame; the oldest frame is held until the key is released
+            if (rewind.stepBack(snapshot)) {
+                chip8.loadState(snapshot);
+                timelineFrame = rewind.newestFrame() + 1;
+                scheduler.setCyclePhase(timelineFrame);
+                if (!moviePath.empty()) {
+                    movie.truncate(timelineFrame);
                 }
             }
+        } else {
+            applyInput(keys);
+            scheduler.runFrame(chip8);
+            if (!moviePath.empty()) {
+                movie.recordFrameEnd(timelineFrame, chip8.getCycleCount(), chip8.gfx.hash());
+            }
+            ++timelineFrame;
+            if (rewindEnabled) {
+                chip8.saveState(snapshot);
+                rewind.push(snapshot);
+            }
         }
 
-        chip8.emulateCycle();
+        if (profiler) {
+            profiler->recordFrame();
+            if (chip8.getTraceLevel() != TraceLevel::None) {
+                profiler->recordQueueDepth(EventLogger::createInstance().queueDepth());
+            }
+            if (Profiler::takeDumpRequest()) {
+                profiler->dump(profilePath);
+            }
+        }
+
+        if (chip8.getSoundTimer() == 1) {
+            std::cout << "BEEP!" << std::endl; // Placeholder for sound
+        }
+
+        chip8.drawFlag = false;
+        if (chip8.gfx.takeDirtyRows() != 0) {
+            FrameSnapshot& frame = frames.writeBuffer();
+            frame.framebuffer = chip8.gfx;
+            frame.behind = scheduler.isBehind();
+            frames.publish();
+
+            if (frameReadyEvent != 0) {
+                SDL_Event wake;
+                SDL_zero(wake);
+                wake.type = frameReadyEvent;
+                SDL_PushEvent(&wake);
+            }
+        }
+
+        if (chip8.getIdleState() == IdleState::WaitingForKey && !chip8.timersActive()) {
+            std::unique_lock<std::mutex> lock(inputMutex);
+            inputChanged.wait(lock, [&] { return !running || keyState.load() != keys || rewindHeld.load(); });
+            scheduler.resync();
+            continue;
+        }
+
+        scheduler.waitForNextFrame();
+    }
+}
+
+/**
+ * @brief Runs the emulator until the window is closed.
+ *
+ * Starts the emulation thread, then handles SDL events and rendering on
+ * the calling thread. Only the newest published frame is rendered, and
+ * only the rows that differ from the last uploaded frame are converted.
+ * Presents go through the FramePacer, so a slow present delays the next
+ * present but never the emulation.
+ */
+void Emulator::run() {
+    Framebuffer uploaded;
+    renderer.render(uploaded, 0xFFFFFFFFu);
 
-        if (chip8.drawFlag) {
-            renderer.render(chip8.gfx.data());
-            chip8.drawFlag = false;
+    if (profiler) {
+        profiler->start();
+    }
+    std::thread emulation(&Emulator::emulationLoop, this);
+    while(running){
+        // Without a wake-up event (or with a deferred present) poll for new frames instead
+        bool poll = pacer.hasPending() || frameReadyEvent == 0;
+        bool gotEvent = poll ? SDL_WaitEventTimeout(&event, PENDING_PRESENT_POLL_MS)
+                                           : SDL_WaitEvent(&event);
+        if (gotEvent) {
+            do {
+                handleEvent(event);
+            } while (SDL_PollEvent(&event));
         }
 
-        std::this_thread::sleep_for(std::chrono::microseconds(FRAME_DELAY_US)); // Approx 60Hz
+        frames.update();
+        const FrameSnapshot& frame = frames.readBuffer();
+        uint32_t dirtyRows = frame.framebuffer.diffRows(uploaded);
+        if (pacer.shouldPresent(dirtyRows != 0, frame.behind)) {
+            uint64_t renderStart = profiler ? Profiler::now() : 0;
+            renderer.render(frame.framebuffer, dirtyRows);
+            if (profiler) {
+                profiler->recordRender(Profiler::now() - renderStart);
+            }
+            uploaded = frame.framebuffer;
+            pacer.presented();
+        }
     }
-}
\ No newline at end of file
+    emulation.join();
+    if (!moviePath.empty() && timelineFrame > 0) {
+        movie.finish(timelineFrame - 1, chip8.getCycleCount(), chip8.gfx.hash());
+        if (movie.save(moviePath)) {
+            std::cout << "Recorded " << timelineFrame << " frames to " << moviePath << std::endl;
+        }
+    }
+    if (profiler) {
+        profiler->stop();
+        if (profiler->dump(profilePath)) {
+            std::cout << "Profile written to " << profilePath << ".txt and " << profilePath << ".folded" << std::endl;
+        }
+    }
+    printStats();
+}
+
+/**
+ * @brief Prints frame scheduling, presentation, rewind and event log statistics.
+ */
+void Emulator::printStats() const {
+    const PresentStats& stats = pacer.getStats();
+    std::cout << "Frames: " << scheduler.getFrameCount() << " emulated, "
+              << scheduler.getMissedDeadlines() << " late\n"
+              << "Presents: " << stats.presented << " presented, " << stats.deferred << " deferred, "
+              << stats.skipped << " skipped, " << stats.missedDeadlines << " late\n"
+              << "Present interval: avg " << stats.avgIntervalMs << " ms, min " << stats.minIntervalMs
+              << " ms, max " << stats.maxIntervalMs << " ms; present cost avg " << stats.avgPresentMs << " ms"
+              << std::endl;
+    if (rewindEnabled) {
+        RewindStats history = rewind.getStats();
+        std::cout << "Rewind: " << history.frames << " frames (" << history.keyframes << " keyframes, "
+                  << history.evictedFrames << " evicted) in " << history.memoryUsed / 1024 << " KiB of "
+                  << history.memoryBudget / 1024 << " KiB; compression " << history.compressionRatio
+                  << "x, avg delta " << history.avgDeltaBytes << " bytes" << std::endl;
+    }
+    if (chip8.getTraceLevel() == TraceLevel::None) {
+        return;
+    }
+    LoggerStats log = EventLogger::createInstance().getStats();
+    std::cout << "Event log: " << log.written << " written, " << log.dropped << " dropped, "
+              << log.producerStalls << " stalls; queue depth " << log.depth << ", high-water "
+              << log.highWaterMark << "/" << log.capacity << std::endl;
+}
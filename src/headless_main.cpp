@@ -0,0 +1,340 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "batch_runner.h"
+#include "input_movie.h"
+#include <iterator>
+#include <memory>
+
+/**
+ * @brief Prints command line usage for the headless runner.
+ *
+ * @param program Name of the executable.
+ */
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options] <ROM file>...\n"
+              << "  --cycles N      Maximum virtual cycles per instance (default 1000000)\n"
+              << "  --cps N         Virtual CPU speed used to tick the 60Hz timers (default 700)\n"
+              << "  --seeds A,B,... Run every ROM once per seed (default 0)\n"
+              << "  --instances N   Run every ROM with seeds 0..N-1\n"
+              << "  --threads N     Worker threads (default: all cores)\n"
+              << "  --mode M        interpret, predecoded or translated (default translated)\n"
+              << "  --bank N        Run same-ROM instances in lockstep banks of 8, 16 or 32 lanes\n"
+              << "  --bank-check    Rerun every banked instance on the interpreter and compare the results\n"
+              << "  --jobs FILE     Read additional \"<ROM file> <seed>\" lines from FILE\n"
+              << "  --trace N       Write an event trace of the Nth instance (0-based, in output order)\n"
+              << "  --trace-level L opcodes or full (default full)\n"
+              << "  --replay FILE   Replay a movie recorded with chip8 --record against one ROM\n"
+              << "  --precompile    Analyze each ROM once and fill every instance's caches before it starts\n"
+              << "  --profile PATH  Write an execution profile to PATH.txt and PATH.folded (also on SIGUSR1)\n"
+              << "  --aot LIB       Run the ROM LIB was compiled from (see chip8-aot) natively; repeatable\n"
+              << "  --aot-check     Rerun every native instance on the interpreter and compare the results\n"
+              << "  --library PATH  Look ROMs up in a directory or .c8rp pack, mapped once; repeatable\n"
+              << "  --write-pack F  Write the library and every ROM given to pack file F, then exit\n";
+}
+
+/**
+ * @brief Parses a comma-separated list of seeds.
+ *
+ * @param list The list text.
+ * @return std::vector<uint32_t> The parsed seeds.
+ */
+static std::vector<uint32_t> parseSeeds(const char* list) {
+    std::vector<uint32_t> seeds;
+    std::stringstream stream(list);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        seeds.push_back(static_cast<uint32_t>(std::strtoul(item.c_str(), nullptr, 0)));
+    }
+    return seeds;
+}
+
+/**
+ * @brief Replays an input movie and reports whether it reproduced the recording.
+ *
+ * @param moviePath Movie file.
+ * @param romPath ROM the movie was recorded with.
+ * @param mode Execution mode to replay in.
+ * @return int Exit status: 0 if every checkpoint matched, 1 on load errors, 3 on divergence.
+ */
+static int replay(const char* moviePath, const std::string& romPath, ExecutionMode mode) {
+    InputMovie movie;
+    if (!movie.load(moviePath)) {
+        return 1;
+    }
+    std::ifstream file(romPath, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Failed to open ROM: " << romPath << std::endl;
+        return 1;
+    }
+    std::vector<uint8_t> rom((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+    ReplayResult result = replayMovie(movie, rom, mode);
+    std::cout << "frames,instructions,checkpoints,status,framebuffer_hash,wall_ms\n"
+              << result.frames << ',' << result.instructions << ',' << result.checkpoints << ','
+              << (result.matched ? "match" : "mismatch") << ",0x" << std::hex << std::setw(16)
+              << std::setfill('0') << result.framebufferHash << std::dec << std::setfill(' ') << ','
+              << std::fixed << std::setprecision(3) << result.wallMs << '\n';
+    if (!result.matched) {
+        std::cerr << "Replay diverged at frame " << result.mismatchFrame << ": " << result.mismatch << std::endl;
+        return 3;
+    }
+    std::cerr << result.frames << " frames, " << result.instructions << " instructions in "
+              << std::fixed << std::setprecision(1) << result.wallMs << " ms ("
+              << (result.wallMs > 0 ? result.instructions / result.wallMs / 1000.0 : 0.0) << " MIPS)" << std::endl;
+    return 0;
+}
+
+/**
+ * @brief Reruns the selected instances of a batch on the interpreter and compares the outcomes.
+ *
+ * Banked lanes have no state hash, so they are compared by framebuffer hash;
+ * native instances by the hash of the whole machine.
+ *
+ * @param jobs The batch.
+ * @param results Its results, in job order.
+ * @param config Its configuration.
+ * @param selected The BatchResult flag that marks the instances to check.
+ * @param name How the report names the checked instances, e.g. "native".
+ * @return int Number of instances whose status, counters or final state differ.
+ */
+static int checkAgainstInterpreter(const std::vector<BatchJob>& jobs, const std::vector<BatchResult>& results,
+                                   const BatchConfig& config, bool BatchResult::*selected, const char* name) {
+    std::vector<BatchJob> checkedJobs;
+    std::vector<const BatchResult*> checkedResults;
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        if (results[i].*selected) {
+            checkedJobs.push_back(jobs[i]);
+            checkedJobs.back().trace = TraceLevel::None;
+            checkedResults.push_back(&results[i]);
+        }
+    }
+    BatchConfig reference = config;
+    reference.mode = ExecutionMode::Interpret;
+    reference.bankWidth = 0;
+    reference.profiler = nullptr;
+    reference.precompile = false;
+    reference.aotModules.clear();
+    std::vector<BatchResult> expected = BatchRunner(reference).run(checkedJobs);
+
+    int mismatches = 0;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        const BatchResult& checked = *checkedResults[i];
+        const BatchResult& interpreted = expected[i];
+        uint64_t checkedHash = checked.banked ? checked.framebufferHash : checked.stateHash;
+        uint64_t interpretedHash = checked.banked ? interpreted.framebufferHash : interpreted.stateHash;
+        if (checked.halted != interpreted.halted || checked.cycles != interpreted.cycles ||
+            checked.instructions != interpreted.instructions || checkedHash != interpretedHash) {
+            std::cerr << "Mismatch: " << checked.romPath << " seed " << checked.seed << ": " << name << ' '
+                      << checked.cycles << " cycles, " << checked.instructions << " instructions, hash 0x"
+                      << std::hex << checkedHash << std::dec << "; interpreter " << interpreted.cycles
+                      << " cycles, " << interpreted.instructions << " instructions, hash 0x" << std::hex
+                      << interpretedHash << std::dec << std::endl;
+            ++mismatches;
+        }
+    }
+    std::cerr << expected.size() - mismatches << " of " << expected.size() << ' ' << name
+              << " instances match the interpreter" << std::endl;
+    return mismatches;
+}
+
+/**
+ * @brief Entry point for the headless batch runner.
+ *
+ * Runs every (ROM, seed) pair without SDL and prints one CSV line per
+ * instance to stdout, followed by a throughput summary on stderr. With
+ * --replay, replays a recorded movie against a single ROM instead.
+ */
+int main(int argc, char* argv[]) {
+    BatchConfig config;
+    std::vector<uint32_t> seeds;
+    std::vector<std::string> roms;
+    std::vector<BatchJob> jobs;
+    long traceJob = -1;
+    TraceLevel traceLevel = TraceLevel::Full;
+    const char* moviePath = nullptr;
+    const char* profilePath = nullptr;
+    std::vector<std::unique_ptr<AotModule>> aotModules;
+    bool aotCheck = false;
+    bool bankCheck = false;
+    RomLibrary library;
+    const char* packPath = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--cycles") == 0 && hasValue) {
+            config.maxCycles = std::strtoull(argv[++i], nullptr, 0);
+        } else if (std::strcmp(argv[i], "--cps") == 0 && hasValue) {
+            config.cyclesPerSecond = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--seeds") == 0 && hasValue) {
+            seeds = parseSeeds(argv[++i]);
+        } else if (std::strcmp(argv[i], "--instances") == 0 && hasValue) {
+            seeds.clear();
+            for (uint32_t seed = 0, count = std::strtoul(argv[++i], nullptr, 0); seed < count; ++seed) {
+                seeds.push_back(seed);
+            }
+        } else if (std::strcmp(argv[i], "--threads") == 0 && hasValue) {
+            config.threads = std::strtoul(argv[++i], nullptr, 0);
+        } else if (std::strcmp(argv[i], "--mode") == 0 && hasValue) {
+            const char* mode = argv[++i];
+            if (std::strcmp(mode, "interpret") == 0) {
+                config.mode = ExecutionMode::Interpret;
+            } else if (std::strcmp(mode, "predecoded") == 0) {
+                config.mode = ExecutionMode::Predecoded;
+            } else if (std::strcmp(mode, "translated") == 0) {
+                config.mode = ExecutionMode::Translated;
+            } else {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--bank") == 0 && hasValue) {
+            config.bankWidth = std::strtoul(argv[++i], nullptr, 0);
+            if (config.bankWidth != 8 && config.bankWidth != 16 && config.bankWidth != 32) {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--jobs") == 0 && hasValue) {
+            std::ifstream file(argv[++i]);
+            if (!file.is_open()) {
+                std::cerr << "Failed to open job list: " << argv[i] << std::endl;
+                return 1;
+            }
+            BatchJob job;
+            while (file >> job.romPath >> job.seed) {
+                jobs.push_back(job);
+            }
+        } else if (std::strcmp(argv[i], "--trace") == 0 && hasValue) {
+            traceJob = std::strtol(argv[++i], nullptr, 0);
+        } else if (std::strcmp(argv[i], "--trace-level") == 0 && hasValue) {
+            const char* level = argv[++i];
+            if (std::strcmp(level, "opcodes") == 0) {
+                traceLevel = TraceLevel::Opcodes;
+            } else if (std::strcmp(level, "full") == 0) {
+                traceLevel = TraceLevel::Full;
+            } else {
+                printUsage(argv[0]);
+                return 1;
+            }
+        } else if (std::strcmp(argv[i], "--replay") == 0 && hasValue) {
+            moviePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--precompile") == 0) {
+            config.precompile = true;
+        } else if (std::strcmp(argv[i], "--profile") == 0 && hasValue) {
+            profilePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--aot") == 0 && hasValue) {
+            aotModules.push_back(std::make_unique<AotModule>());
+            if (!aotModules.back()->load(argv[++i])) {
+                return 1;
+            }
+            config.aotModules.push_back(aotModules.back().get());
+        } else if (std::strcmp(argv[i], "--aot-check") == 0) {
+            aotCheck = true;
+        } else if (std::strcmp(argv[i], "--bank-check") == 0) {
+            bankCheck = true;
+        } else if (std::strcmp(argv[i], "--library") == 0 && hasValue) {
+            if (!library.add(argv[++i])) {
+                return 1;
+            }
+            config.library = &library;
+        } else if (std::strcmp(argv[i], "--write-pack") == 0 && hasValue) {
+            packPath = argv[++i];
+        } else if (argv[i][0] == '-') {
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            roms.push_back(argv[i]);
+        }
+    }
+
+    if (moviePath) {
+        if (roms.size() != 1) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        return replay(moviePath, roms[0], config.mode);
+    }
+
+    if (packPath) {
+        for (const auto& rom : roms) {
+            library.addFile(rom);
+        }
+        for (const auto& job : jobs) {
+            library.addFile(job.romPath);
+        }
+        if (!library.writePack(packPath)) {
+            return 1;
+        }
+        std::cerr << library.getRomCount() << " images under " << library.getNameCount() << " names written to "
+                  << packPath << std::endl;
+        return 0;
+    }
+
+    if (seeds.empty()) {
+        seeds.push_back(0);
+    }
+    for (const auto& rom : roms) {
+        for (uint32_t seed : seeds) {
+            jobs.push_back({rom, seed});
+        }
+    }
+    if (jobs.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (traceJob >= 0) {
+        if (static_cast<size_t>(traceJob) >= jobs.size()) {
+            std::cerr << "No instance " << traceJob << " to trace; the batch has " << jobs.size() << std::endl;
+            return 1;
+        }
+        jobs[traceJob].trace = traceLevel;
+    }
+
+    Profiler profiler;
+    if (profilePath) {
+        config.profiler = &profiler;
+        config.profilePath = profilePath;
+        Profiler::installSignalHandler();
+        profiler.start();
+    }
+
+    BatchRunner runner(config);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<BatchResult> results = runner.run(jobs);
+    double elapsedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (profilePath) {
+        profiler.stop();
+        profiler.dump(profilePath);
+    }
+
+    uint64_t totalInstructions = 0;
+    int failures = 0;
+    std::cout << "rom,seed,status,cycles,instructions,framebuffer_hash,wall_ms\n";
+    for (const auto& result : results) {
+        const char* status = !result.loaded ? "load_error" : (result.halted ? "halted" : "max_cycles");
+        std::cout << result.romPath << ',' << result.seed << ',' << status << ','
+                  << result.cycles << ',' << result.instructions << ",0x" << std::hex << std::setw(16) << std::setfill('0')
+                  << result.framebufferHash << std::dec << std::setfill(' ') << ','
+                  << std::fixed << std::setprecision(3) << result.wallMs << '\n';
+        totalInstructions += result.instructions;
+        failures += result.loaded ? 0 : 1;
+    }
+
+    std::cerr << results.size() << " instances, " << totalInstructions << " instructions in "
+              << std::fixed << std::setprecision(1) << elapsedMs << " ms ("
+              << (elapsedMs > 0 ? totalInstructions / elapsedMs / 1000.0 : 0.0) << " MIPS)" << std::endl;
+    int mismatches = 0;
+    if (aotCheck) {
+        mismatches += checkAgainstInterpreter(jobs, results, config, &BatchResult::native, "native");
+    }
+    if (bankCheck) {
+        mismatches += checkAgainstInterpreter(jobs, results, config, &BatchResult::banked, "banked");
+    }
+    if (mismatches > 0) {
+        return 3;
+    }
+    return failures == 0 ? 0 : 2;
+}
@@ -0,0 +1,128 @@
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include "trace_reader.h"
+
+/**
+ * @brief Prints command line usage for the trace converter.
+ *
+ * @param program Name of the executable.
+ */
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options] <trace file>\n"
+              << "  --type T,...    Only print these event types (e.g. OpcodeEvent,DrawEvent or opcode,draw)\n"
+              << "  --pc A:B        Only print events of instructions at addresses A..B inclusive\n"
+              << "  --stats         Print block, size and per-type counts to stderr instead of events\n";
+}
+
+/**
+ * @brief Parses an event type given by full ("DrawEvent") or short ("draw") name.
+ *
+ * @param name The type name, case-sensitive for full names.
+ * @param type Receives the parsed type.
+ * @return bool False if the name is unknown.
+ */
+static bool parseType(const std::string& name, EventType& type) {
+    for (int i = 0; i <= static_cast<int>(EventType::FramebufferCleared); ++i) {
+        std::string full = eventTypeName(static_cast<EventType>(i));
+        std::string brief = full.substr(0, full.size() - 5);  // Drop "Event"
+        for (char& c : brief) {
+            c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        }
+        if (name == full || name == brief) {
+            type = static_cast<EventType>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Entry point for the trace converter.
+ *
+ * Decodes a binary trace written by EventLogger and prints the selected
+ * events as JSON lines in the format of serializeEvent(). Events other than
+ * OpcodeEvent and StackEvent belong to the instruction whose OpcodeEvent
+ * precedes them, so the PC filter applies to every event type.
+ */
+int main(int argc, char* argv[]) {
+    std::set<EventType> types;
+    uint32_t pcMin = 0;
+    uint32_t pcMax = 0xFFFF;
+    bool stats = false;
+    const char* path = nullptr;
+
+    for (int i = 1; i < argc; ++i) {
+        bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--type") == 0 && hasValue) {
+            std::stringstream list(argv[++i]);
+            std::string item;
+            while (std::getline(list, item, ',')) {
+                EventType type;
+                if (!parseType(item, type)) {
+                    std::cerr << "Unknown event type: " << item << std::endl;
+                    return 1;
+                }
+                types.insert(type);
+            }
+        } else if (std::strcmp(argv[i], "--pc") == 0 && hasValue) {
+            char* rest = nullptr;
+            pcMin = std::strtoul(argv[++i], &rest, 0);
+            pcMax = (rest && *rest == ':') ? std::strtoul(rest + 1, nullptr, 0) : pcMin;
+        } else if (std::strcmp(argv[i], "--stats") == 0) {
+            stats = true;
+        } else if (argv[i][0] == '-' || path) {
+            printUsage(argv[0]);
+            return 1;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (!path) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    TraceReader reader;
+    if (!reader.open(path)) {
+        return 1;
+    }
+
+    std::map<EventType, uint64_t> counts;
+    uint16_t currentPc = 0;
+    while (std::optional<EventVariant> event = reader.next()) {
+        EventType type = std::visit([](auto&& ev) { return ev.type; }, *event);
+        if (const OpcodeEvent* op = std::get_if<OpcodeEvent>(&*event)) {
+            currentPc = op->pc;
+        }
+        uint16_t pc = currentPc;
+        if (const StackEvent* stack = std::get_if<StackEvent>(&*event)) {
+            pc = stack->pc;
+        }
+
+        if (!types.empty() && types.count(type) == 0) continue;
+        if (pc < pcMin || pc > pcMax) continue;
+
+        if (stats) {
+            ++counts[type];
+        } else {
+            std::cout << serializeEvent(*event) << '\n';
+        }
+    }
+
+    if (stats) {
+        uint64_t total = 0;
+        for (const auto& [type, count] : counts) {
+            std::cerr << eventTypeName(type) << ": " << count << "\n";
+            total += count;
+        }
+        std::cerr << total << " events in " << reader.blocksRead() << " blocks, " << reader.rawBytes()
+                  << " bytes encoded, " << reader.storedBytes() << " bytes stored" << std::endl;
+    }
+    return reader.failed() ? 2 : 0;
+}